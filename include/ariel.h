@@ -4,6 +4,7 @@
 #include <gtk/gtk.h>
 #include <lilv/lilv.h>
 #include <jack/jack.h>
+#include <jack/ringbuffer.h>
 
 // LV2 Feature headers
 #include <lv2/core/lv2.h>
@@ -19,6 +20,9 @@
 // Ariel logging system
 #include "ariel_log.h"
 
+// Host-side buffer kernels
+#include "ariel_dsp.h"
+
 #define ARIEL_APP_ID "com.github.djshaji.ariel"
 #define APP "Ariel"
 
@@ -30,6 +34,18 @@ typedef struct _ArielPluginManager ArielPluginManager;
 typedef struct _ArielPluginInfo ArielPluginInfo;
 typedef struct _ArielConfig ArielConfig;
 typedef struct _ArielActivePlugin ArielActivePlugin;
+typedef struct _ArielPluginPool ArielPluginPool;
+typedef struct _ArielPluginUsage ArielPluginUsage;
+typedef struct _ArielPresetIndex ArielPresetIndex;
+typedef struct _ArielSceneBank ArielSceneBank;
+typedef struct _ArielMidiMapper ArielMidiMapper;
+typedef struct _ArielMidiMap ArielMidiMap;
+typedef struct _ArielRecorder ArielRecorder;
+typedef struct _ArielCapture ArielCapture;
+typedef struct _ArielFilePlayer ArielFilePlayer;
+typedef struct _ArielSlotStage ArielSlotStage;
+
+typedef void (*ArielPluginLoadedFunc)(ArielActivePlugin *plugin, gpointer user_data);
 
 #define ARIEL_TYPE_APP (ariel_app_get_type())
 G_DECLARE_FINAL_TYPE(ArielApp, ariel_app, ARIEL, APP, GtkApplication)
@@ -58,15 +74,234 @@ struct _ArielWindow {
     ArielApp *app;
 };
 
+// Immutable snapshot of the active plugin chain, as run by the audio thread
+typedef struct {
+    guint n_plugins;
+    ArielActivePlugin **plugins;         // Each holds a reference
+} ArielProcessChain;
+
+// Scene compiled against the running chain: flat control values per plugin
+typedef struct {
+    guint n_plugins;
+    ArielActivePlugin **plugins;         // Each holds a reference
+    guint *offsets;                      // Start of each plugin's run in values
+    guint *counts;
+    gboolean *bypass;
+    float *values;
+} ArielSceneRecall;
+
+// How a control input moves when morphing between scenes
+typedef enum {
+    ARIEL_CONTROL_LINEAR,
+    ARIEL_CONTROL_LOGARITHMIC,           // Interpolated on a log scale
+    ARIEL_CONTROL_STEPPED                // Toggled, integer or enumeration: switches at the midpoint
+} ArielControlKind;
+
+// Two scenes compiled against the running chain for morphing. Values are
+// grouped by kind: n_linear linear ones, then n_log logarithmic ones (held
+// as natural logs), then the stepped ones.
+typedef struct {
+    guint n_plugins;
+    ArielActivePlugin **plugins;         // Each holds a reference
+    gboolean *bypass_from;
+    gboolean *bypass_to;
+    guint n_values;
+    guint n_linear;
+    guint n_log;
+    float *from;
+    float *to;
+    float *scratch;
+    float **targets;                     // Control input each value lands in
+    float position;                      // Last position applied, audio thread only
+} ArielSceneMorph;
+
+#define ARIEL_MORPH_RESOLUTION 65536     // Steps of engine->morph_position
+
+// Host-side mix settings of one chain slot (see slot_mix.c)
+typedef struct {
+    float input_gain;                    // Linear, before the plugin
+    float output_gain;                   // Linear, after the blend
+    float mix;                           // 0 dry .. 1 wet
+    float pan;                           // -1 left .. 1 right; balance, unity at the centre
+    gboolean mute;
+} ArielSlotMix;
+
+// Peak and RMS at one point of the signal. The audio thread keeps the
+// largest peak until the UI takes it, and the RMS of the last block.
+typedef struct {
+    gint peak[2];                        // Float bits, atomic
+    gint rms[2];                         // Float bits, atomic
+    
+    // Levels last taken, for every view of this meter in that frame (UI thread only)
+    gint64 taken_at;
+    float taken_peak[2];
+    float taken_rms[2];
+} ArielMeter;
+
+// Floats shared between threads, stored as their bits in a gint
+static inline void
+ariel_atomic_float_set(gint *atomic, float value)
+{
+    union { float f; gint i; } bits = { .f = value };
+    g_atomic_int_set(atomic, bits.i);
+}
+
+static inline float
+ariel_atomic_float_get(gint *atomic)
+{
+    union { float f; gint i; } bits = { .i = g_atomic_int_get(atomic) };
+    return bits.f;
+}
+
+#define ARIEL_SLOT_MIX_UNITY   { 1.0f, 1.0f, 1.0f, 0.0f, FALSE }
+#define ARIEL_SLOT_GAIN_MIN_DB (-60.0)   // Gain controls go to silence at their bottom
+#define ARIEL_SLOT_GAIN_MAX_DB 24.0
+
+// Commands passed from the main thread to the audio thread
+typedef enum {
+    ARIEL_ENGINE_COMMAND_SET_CHAIN,
+    ARIEL_ENGINE_COMMAND_RECALL_SCENE,
+    ARIEL_ENGINE_COMMAND_SET_MORPH,
+    ARIEL_ENGINE_COMMAND_SET_MIDI_MAP,
+    ARIEL_ENGINE_COMMAND_SET_RECORDER,
+    ARIEL_ENGINE_COMMAND_SET_PLAYER
+} ArielEngineCommandType;
+
+typedef struct {
+    ArielEngineCommandType type;
+    ArielProcessChain *chain;
+    guint fade_frames;                   // SET_CHAIN: crossfade length, 0 to cut over
+    ArielSceneRecall *scene;             // RECALL_SCENE: applied in one cycle, then reclaimed
+    ArielSceneMorph *morph;              // SET_MORPH: replaces the running morph, NULL to stop
+    ArielMidiMap *midi_map;              // SET_MIDI_MAP: replaces the running table
+    ArielRecorder *recorder;             // SET_RECORDER: replaces the running recorder, NULL to stop
+    ArielFilePlayer *player;             // SET_PLAYER: replaces the running file player, NULL to stop
+} ArielEngineCommand;
+
+// One incoming MIDI event; data points into the backend's buffer and is
+// only valid during the cycle it arrived in
+typedef struct {
+    uint32_t time;                       // Frame offset into the cycle
+    uint32_t size;
+    const uint8_t *data;
+} ArielMidiEvent;
+
+// Transport position, as plugins see it in time:Position objects
+typedef struct {
+    gboolean rolling;
+    gboolean has_bbt;                    // Bar, beat and tempo are valid
+    int64_t frame;
+    int64_t bar;                         // 0-based
+    float bar_beat;                      // Beats since the start of the bar
+    float beats_per_bar;
+    int32_t beat_unit;
+    float beats_per_minute;
+} ArielTimePosition;
+
+#define ARIEL_MIDI_MAX_EVENTS 512        // Per cycle; the rest are dropped
+#define ARIEL_MIDI_OMNI       0xFF       // Mapping listens on every channel
+
+// A MIDI controller mapped to a control input (main thread)
+typedef struct {
+    guint8 channel;                      // 0-15, or ARIEL_MIDI_OMNI
+    guint8 cc;
+    ArielActivePlugin *plugin;           // Holds a reference
+    guint port;                          // Control input index
+    float min;
+    float max;
+    ArielControlKind curve;
+} ArielMidiMapping;
+
+// Mappings compiled for the audio thread, sorted by CC
+typedef struct {
+    guint8 channel;
+    ArielControlKind curve;
+    float min;
+    float max;
+    float *target;                       // Control input the value lands in
+} ArielMidiMapEntry;
+
+struct _ArielMidiMap {
+    guint n_entries;
+    ArielMidiMapEntry *entries;
+    guint16 first[129];                  // Entries for CC c are [first[c], first[c + 1])
+    guint n_plugins;
+    ArielActivePlugin **plugins;         // Each holds a reference
+};
+
+#define ARIEL_DEFAULT_CROSSFADE_MS 30
+#define ARIEL_MAX_CROSSFADE_MS     500
+#define ARIEL_DEFAULT_CAPTURE_MINUTES 2
+#define ARIEL_MAX_CAPTURE_MINUTES     30
+
+// A file a plugin reported loading for one of its parameters
+typedef void (*ArielPatchSetFunc)(ArielActivePlugin *plugin, const char *property_uri, const char *path, gpointer user_data);
+
 // Audio engine structure
 struct _ArielAudioEngine {
     jack_client_t *client;
     jack_port_t *input_ports[2];
     jack_port_t *output_ports[2];
+    jack_port_t *midi_input_port;        // NULL if it could not be registered
     gboolean active;
     gfloat sample_rate;
     gint buffer_size;
     ArielPluginManager *plugin_manager;  // Reference to plugin manager for processing
+    
+    // Real-time chain, swapped only at cycle boundaries
+    ArielProcessChain *chain;            // Owned by the audio thread while active
+    jack_ringbuffer_t *command_ring;     // Main thread -> audio thread
+    jack_ringbuffer_t *reclaim_ring;     // Audio thread -> main thread (retired objects)
+    guint reclaim_source;
+    guint sync_retry_source;
+    gulong chain_changed_id;
+    
+    // Chain crossfade; the fade_* fields belong to the audio thread
+    guint crossfade_ms;
+    gboolean crossfade_next;
+    ArielProcessChain *fade_chain;       // Outgoing chain while fading
+    gboolean fade_slots;                 // Only the slots whose plugin changed fade
+    guint fade_position;
+    guint fade_length;
+    
+    // Scene morph, run by the audio thread once per cycle
+    ArielSceneMorph *morph;              // Owned by the audio thread while active
+    gint morph_position;                 // 0..ARIEL_MORPH_RESOLUTION, atomic, any thread
+    GPtrArray *morph_plugins;            // Plugins the armed morph drives, main thread
+    
+    // MIDI input, gathered by the audio thread at the start of each cycle
+    ArielMidiEvent midi_events[ARIEL_MIDI_MAX_EVENTS];
+    guint n_midi_events;
+    gint midi_program;                   // Last Program Change not yet handled, or -1; atomic
+    ArielMidiMap *midi_map;              // Owned by the audio thread while active
+    gint midi_learn;                     // 1 while waiting for a controller; atomic
+    gint midi_learned;                   // (channel << 8 | cc) + 1 once learned, else 0; atomic
+    gint midi_values_changed;            // Set when a mapping moved a control; atomic
+    
+    // Transport, queried by the audio thread at the start of each cycle
+    ArielTimePosition position;
+    guint position_serial;               // Bumped when the position jumps, starts or stops
+    int64_t position_next_frame;         // Where a rolling transport lands next cycle
+    
+    // Recording of input and output, fed by the audio thread
+    ArielRecorder *recorder;             // Owned by the audio thread while active
+    gboolean recording;                  // Main thread's view
+    
+    // Retrospective capture of the last capture_minutes, always running
+    ArielCapture *capture;               // Replaced only while the audio thread is stopped
+    guint capture_minutes;               // 0 turns it off; applies at the next start
+    gboolean capture_lock_memory;
+    
+    // File played into the chain input
+    ArielFilePlayer *player;             // Owned by the audio thread while active
+    ArielFilePlayer *file_player;        // Main thread's view of player, NULL once stopped
+    
+    // Level of the final output
+    ArielMeter master_meter;
+    
+    // Told on the main thread when a plugin reports the file it loaded
+    ArielPatchSetFunc patch_set_func;
+    gpointer patch_set_data;
 };
 
 #define ARIEL_TYPE_PLUGIN_INFO (ariel_plugin_info_get_type())
@@ -86,6 +321,7 @@ typedef struct {
     GHashTable *uri_to_id;
     GHashTable *id_to_uri;
     uint32_t next_id;
+    GMutex lock;                  // Plugins may map URIs from loader threads
 } ArielURIDMap;
 
 // Worker response item structure
@@ -111,12 +347,25 @@ struct _ArielPluginManager {
     const LilvPlugins *plugins;
     GListStore *plugin_store;
     GListStore *active_plugin_store;
+    GHashTable *plugin_index;     // URI -> ArielPluginInfo (borrowed from plugin_store)
+    GHashTable *lilv_index;       // URI -> const LilvPlugin (borrowed from world)
     ArielConfig *config;
     ArielURIDMap *urid_map;
     ArielWorkerSchedule *worker_schedule;
     LV2_Feature **features;
+    ArielPluginPool *plugin_pool;     // Warm instances of recently removed plugins
+    ArielPluginUsage *usage;          // Per-URI load counts, for prewarm
+    ArielPresetIndex *preset_index;   // Plugin URI -> presets, created on first listing
+    ArielSceneBank *scenes;           // Scenes of the current chain
+    ArielMidiMapper *midi_mapper;     // MIDI learn and CC mappings of the current chain
 };
 
+#define ARIEL_PLUGIN_POOL_BUDGET (256 * 1024 * 1024)
+
+// Blocks of silence run through new instances before they go live
+#define ARIEL_WARM_UP_BLOCKS      4
+#define ARIEL_WARM_UP_BLOCK_SIZE  256   // Used when the engine has no block size yet
+
 // Function prototypes
 
 // Application
@@ -133,7 +382,8 @@ void ariel_window_setup_ui(ArielWindow *window);
 GtkWidget *ariel_create_header_bar(ArielWindow *window);
 GtkWidget *ariel_create_plugin_list(ArielWindow *window);
 GtkWidget *ariel_create_mixer(ArielWindow *window);
-GtkWidget *ariel_create_mixer_channel(const char *name, int channel_id);
+GtkWidget *ariel_create_mixer_channel(ArielActivePlugin *plugin);
+void ariel_update_mixer(ArielWindow *window);
 GtkWidget *ariel_create_transport(ArielWindow *window);
 void ariel_show_settings_dialog(ArielWindow *window);
 
@@ -141,10 +391,15 @@ void ariel_show_settings_dialog(ArielWindow *window);
 void ariel_save_theme_preference(const char *theme_name);
 char *ariel_load_theme_preference(void);
 void ariel_apply_saved_theme(void);
+void ariel_save_crossfade_preference(guint crossfade_ms);
+guint ariel_load_crossfade_preference(void);
+void ariel_save_capture_preferences(guint minutes, gboolean lock_memory);
+void ariel_load_capture_preferences(guint *minutes, gboolean *lock_memory);
 void ariel_transport_play(ArielWindow *window);
 void ariel_transport_stop(ArielWindow *window);
 void ariel_transport_record(ArielWindow *window);
 void ariel_transport_update_ui(ArielWindow *window);
+void ariel_transport_save_capture(ArielWindow *window);
 
 // Active Plugins View
 GtkWidget *ariel_create_active_plugins_view(ArielWindow *window);
@@ -155,6 +410,16 @@ void ariel_update_active_plugins_view(ArielWindow *window);
 void setup_plugin_list_item(GtkListItemFactory *factory, GtkListItem *list_item, gpointer user_data);
 void bind_plugin_list_item(GtkListItemFactory *factory, GtkListItem *list_item, gpointer user_data);
 
+// Plugin Search (ranked fuzzy matching, scored off the main thread)
+typedef struct _ArielPluginSearch ArielPluginSearch;
+typedef void (*ArielPluginSearchResultsFunc)(ArielPluginSearch *search, gpointer user_data);
+ArielPluginSearch *ariel_plugin_search_new(GListModel *plugins, ArielPluginSearchResultsFunc results_func, gpointer results_data);
+void ariel_plugin_search_free(ArielPluginSearch *search);
+void ariel_plugin_search_set_query(ArielPluginSearch *search, const char *query);
+gboolean ariel_plugin_search_is_active(ArielPluginSearch *search);
+gboolean ariel_plugin_search_lookup(ArielPluginSearch *search, ArielPluginInfo *info, gint *score);
+gint ariel_plugin_search_fuzzy_score(const char *needle, const char *haystack, const char *original);
+
 // Audio Engine
 ArielAudioEngine *ariel_audio_engine_new(void);
 gboolean ariel_audio_engine_start(ArielAudioEngine *engine);
@@ -162,6 +427,56 @@ void ariel_audio_engine_stop(ArielAudioEngine *engine);
 void ariel_audio_engine_free(ArielAudioEngine *engine);
 void ariel_audio_engine_set_plugin_manager(ArielAudioEngine *engine, ArielPluginManager *manager);
 
+// Real-time chain and engine commands
+ArielProcessChain *ariel_process_chain_new(GListModel *plugins);
+void ariel_process_chain_free(ArielProcessChain *chain);
+void ariel_audio_engine_init_chain(ArielAudioEngine *engine);
+void ariel_audio_engine_free_chain(ArielAudioEngine *engine);
+gboolean ariel_audio_engine_send_command(ArielAudioEngine *engine, const ArielEngineCommand *command);
+void ariel_audio_engine_process_commands(ArielAudioEngine *engine);
+void ariel_audio_engine_collect_garbage(ArielAudioEngine *engine);
+gboolean ariel_audio_engine_collect_garbage_cb(gpointer user_data);
+void ariel_audio_engine_sync_chain(ArielAudioEngine *engine);
+void ariel_audio_engine_crossfade_next_chain(ArielAudioEngine *engine);
+void ariel_audio_engine_on_chain_changed(GListModel *model, guint position, guint removed, guint added, gpointer user_data);
+void ariel_audio_engine_process_chain(ArielAudioEngine *engine, float *buffer_L, float *buffer_R, jack_nframes_t nframes);
+void ariel_audio_engine_set_morph_position(ArielAudioEngine *engine, float position);
+float ariel_audio_engine_get_morph_position(ArielAudioEngine *engine);
+gboolean ariel_audio_engine_set_morph(ArielAudioEngine *engine, ArielSceneMorph *morph);
+void ariel_audio_engine_stop_morph(ArielAudioEngine *engine);
+void ariel_audio_engine_receive_midi(ArielAudioEngine *engine, const ArielMidiEvent *event);
+void ariel_audio_engine_update_position(ArielAudioEngine *engine, const ArielTimePosition *position, jack_nframes_t nframes);
+void ariel_audio_engine_set_transport_rolling(ArielAudioEngine *engine, gboolean rolling);
+void ariel_audio_engine_set_patch_set_func(ArielAudioEngine *engine, ArielPatchSetFunc func, gpointer user_data);
+
+// Warm instance pool
+ArielPluginPool *ariel_plugin_pool_new(gsize memory_budget);
+void ariel_plugin_pool_free(ArielPluginPool *pool);
+void ariel_plugin_pool_set_budget(ArielPluginPool *pool, gsize memory_budget);
+void ariel_plugin_pool_release(ArielPluginPool *pool, ArielActivePlugin *plugin);
+ArielActivePlugin *ariel_plugin_pool_acquire(ArielPluginPool *pool, const char *uri, guint state_hash, gboolean exact);
+
+// LV2 state snapshots
+gboolean ariel_active_plugin_has_state(ArielActivePlugin *plugin);
+GBytes *ariel_active_plugin_save_state(ArielActivePlugin *plugin);
+gboolean ariel_active_plugin_restore_state(ArielActivePlugin *plugin, GBytes *snapshot);
+gboolean ariel_active_plugin_has_thread_safe_restore(ArielActivePlugin *plugin);
+void ariel_active_plugin_restore_state_async(ArielActivePlugin *plugin, GBytes *snapshot, ArielPluginLoadedFunc callback, gpointer user_data);
+void ariel_state_save_to_keyfile(ArielActivePlugin *plugin, GKeyFile *keyfile, const char *group);
+GBytes *ariel_state_load_from_keyfile(GKeyFile *keyfile, const char *group);
+
+// Content-addressed store for files referenced by plugin state
+char *ariel_state_store_add(const char *config_dir, const char *path);
+guint ariel_state_store_gc(const char *config_dir);
+
+// Plugin usage statistics and prewarm
+ArielPluginUsage *ariel_plugin_usage_new(const char *config_dir);
+void ariel_plugin_usage_free(ArielPluginUsage *usage);
+void ariel_plugin_usage_save(ArielPluginUsage *usage);
+void ariel_plugin_usage_record(ArielPluginUsage *usage, const char *uri);
+char **ariel_plugin_usage_get_top(ArielPluginUsage *usage, guint max_count);
+void ariel_plugin_manager_prewarm(ArielPluginManager *manager);
+
 // Plugin Info
 ArielPluginInfo *ariel_plugin_info_new(const LilvPlugin *plugin);
 const char *ariel_plugin_info_get_name(ArielPluginInfo *info);
@@ -174,10 +489,24 @@ const char *ariel_plugin_info_get_uri(ArielPluginInfo *info);
 
 // Active Plugin
 ArielActivePlugin *ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine);
+ArielActivePlugin *ariel_active_plugin_prepare(ArielPluginInfo *plugin_info, ArielAudioEngine *engine);
+gboolean ariel_active_plugin_instantiate(ArielActivePlugin *plugin);
 void ariel_active_plugin_process(ArielActivePlugin *plugin, jack_nframes_t nframes);
 void ariel_active_plugin_activate(ArielActivePlugin *plugin);
 void ariel_active_plugin_deactivate(ArielActivePlugin *plugin);  
 const char *ariel_active_plugin_get_name(ArielActivePlugin *plugin);
+const char *ariel_active_plugin_get_library_path(ArielActivePlugin *plugin);
+void ariel_active_plugin_reset_parameters(ArielActivePlugin *plugin);
+void ariel_active_plugin_warm_up(ArielActivePlugin *plugin, guint n_blocks);
+ArielPluginManager *ariel_active_plugin_get_manager(ArielActivePlugin *plugin);
+ArielAudioEngine *ariel_active_plugin_get_engine(ArielActivePlugin *plugin);
+guint ariel_active_plugin_get_state_hash(ArielActivePlugin *plugin);
+void ariel_active_plugin_set_state_snapshot(ArielActivePlugin *plugin, GBytes *snapshot);
+guint ariel_plugin_state_hash(const float *values, guint n_values);
+gsize ariel_active_plugin_get_memory_cost(ArielActivePlugin *plugin);
+void ariel_active_plugin_ref_chain(ArielActivePlugin *plugin);
+void ariel_active_plugin_unref_chain(ArielActivePlugin *plugin);
+gboolean ariel_active_plugin_is_in_chain(ArielActivePlugin *plugin);
 gboolean ariel_active_plugin_is_active(ArielActivePlugin *plugin);
 void ariel_active_plugin_connect_audio_ports(ArielActivePlugin *plugin, float **input_buffers, float **output_buffers);
 
@@ -192,25 +521,139 @@ guint ariel_active_plugin_get_n_audio_inputs(ArielActivePlugin *plugin);
 guint ariel_active_plugin_get_n_audio_outputs(ArielActivePlugin *plugin);
 void ariel_active_plugin_set_bypass(ArielActivePlugin *plugin, gboolean bypass);
 gboolean ariel_active_plugin_get_bypass(ArielActivePlugin *plugin);
+void ariel_active_plugin_apply_controls(ArielActivePlugin *plugin, const float *values, guint n_values, gboolean bypass);
+ArielControlKind ariel_active_plugin_get_control_kind(ArielActivePlugin *plugin, uint32_t index);
+float *ariel_active_plugin_get_control_inputs(ArielActivePlugin *plugin);
+void ariel_active_plugin_get_control_range(ArielActivePlugin *plugin, uint32_t index, float *min, float *max);
+ArielSlotStage *ariel_active_plugin_get_slot_stage(ArielActivePlugin *plugin);
+ArielMeter *ariel_active_plugin_get_meter(ArielActivePlugin *plugin);
+guint ariel_active_plugin_get_n_control_outputs(ArielActivePlugin *plugin);
+uint32_t ariel_active_plugin_get_control_output_port_index(ArielActivePlugin *plugin, guint index);
+gboolean ariel_active_plugin_read_control_outputs(ArielActivePlugin *plugin, float *values, guint n_values);
+void ariel_active_plugin_set_slot_mix(ArielActivePlugin *plugin, const ArielSlotMix *mix);
+void ariel_active_plugin_get_slot_mix(ArielActivePlugin *plugin, ArielSlotMix *mix);
 
 // Atom Messaging for File Parameters
 void ariel_active_plugin_set_file_parameter(ArielActivePlugin *plugin, const char *file_path);
 void ariel_active_plugin_set_file_parameter_with_uri(ArielActivePlugin *plugin, const char *file_path, const char *parameter_uri);
 gboolean ariel_active_plugin_supports_file_parameters(ArielActivePlugin *plugin);
+guint ariel_active_plugin_dispatch_atom_outputs(ArielActivePlugin *plugin, ArielPatchSetFunc func, gpointer user_data);
+const char *ariel_active_plugin_get_reported_file(ArielActivePlugin *plugin, const char *property_uri);
+gboolean ariel_active_plugin_has_atom_outputs(ArielActivePlugin *plugin);
 
 // Preset Management
 gboolean ariel_active_plugin_save_preset(ArielActivePlugin *plugin, const char *preset_name, const char *preset_dir);
-gboolean ariel_active_plugin_load_preset(ArielActivePlugin *plugin, const char *preset_path);
-char **ariel_active_plugin_list_presets(ArielActivePlugin *plugin, const char *preset_dir);
-void ariel_active_plugin_free_preset_list(char **preset_list);
+gboolean ariel_active_plugin_load_preset(ArielActivePlugin *plugin, const char *preset_path, ArielPluginLoadedFunc callback, gpointer user_data);
+GPtrArray *ariel_active_plugin_list_presets(ArielActivePlugin *plugin, const char *preset_dir);
+
+// Preset index
+typedef struct {
+    char *name;
+    char *path;       // The .preset file, or the preset URI for LV2 presets
+} ArielPresetEntry;
+
+ArielPresetIndex *ariel_preset_index_new(void);
+void ariel_preset_index_free(ArielPresetIndex *index);
+GPtrArray *ariel_preset_index_list(ArielPresetIndex *index, ArielPluginManager *manager, const char *preset_dir, const char *uri);
+void ariel_preset_index_add(ArielPresetIndex *index, const char *preset_path, const char *uri);
 
 // Plugin Chain Presets
 gboolean ariel_save_plugin_chain_preset(ArielPluginManager *manager, const char *preset_name, const char *preset_dir);
 gboolean ariel_load_plugin_chain_preset(ArielPluginManager *manager, ArielAudioEngine *engine, const char *preset_path);
+typedef void (*ArielChainLoadedFunc)(gboolean success, gpointer user_data);
+void ariel_load_plugin_chain_preset_async(ArielPluginManager *manager, ArielAudioEngine *engine, const char *preset_path, ArielChainLoadedFunc callback, gpointer user_data);
 char **ariel_list_plugin_chain_presets(const char *preset_dir);
 void ariel_free_plugin_chain_preset_list(char **preset_list);
 
+// Scenes
+typedef void (*ArielSceneRecalledFunc)(guint index, gpointer user_data);
+ArielSceneBank *ariel_scene_bank_new(void);
+void ariel_scene_bank_free(ArielSceneBank *bank);
+void ariel_scene_bank_set_recalled_func(ArielSceneBank *bank, ArielSceneRecalledFunc func, gpointer user_data);
+guint ariel_scene_bank_get_n_scenes(ArielSceneBank *bank);
+const char *ariel_scene_bank_get_name(ArielSceneBank *bank, guint index);
+gint ariel_scene_bank_find(ArielSceneBank *bank, const char *name);
+gint ariel_scene_bank_capture(ArielSceneBank *bank, ArielPluginManager *manager, const char *name);
+void ariel_scene_bank_remove(ArielSceneBank *bank, guint index);
+gboolean ariel_scene_bank_recall(ArielSceneBank *bank, ArielPluginManager *manager, ArielAudioEngine *engine, guint index);
+gboolean ariel_scene_bank_recall_by_name(ArielSceneBank *bank, ArielPluginManager *manager, ArielAudioEngine *engine, const char *name);
+void ariel_scene_bank_save_to_keyfile(ArielSceneBank *bank, GKeyFile *keyfile);
+void ariel_scene_bank_load_from_keyfile(ArielSceneBank *bank, GKeyFile *keyfile);
+void ariel_scene_recall_free(ArielSceneRecall *recall);
+gboolean ariel_scene_bank_morph(ArielSceneBank *bank, ArielPluginManager *manager, ArielAudioEngine *engine, guint from, guint to);
+void ariel_scene_morph_apply(ArielSceneMorph *morph, float position);
+void ariel_scene_morph_free(ArielSceneMorph *morph);
+
+// MIDI learn and CC mapping
+typedef void (*ArielMidiMapChangedFunc)(gboolean mappings_changed, gpointer user_data);
+ArielMidiMapper *ariel_midi_mapper_new(ArielPluginManager *manager);
+void ariel_midi_mapper_free(ArielMidiMapper *mapper);
+void ariel_midi_mapper_set_changed_func(ArielMidiMapper *mapper, ArielMidiMapChangedFunc func, gpointer user_data);
+const ArielMidiMapping *ariel_midi_mapper_lookup(ArielMidiMapper *mapper, ArielActivePlugin *plugin, guint port);
+gboolean ariel_midi_mapper_is_learning(ArielMidiMapper *mapper, ArielActivePlugin *plugin, guint port);
+void ariel_midi_mapper_learn(ArielMidiMapper *mapper, ArielAudioEngine *engine, ArielActivePlugin *plugin, guint port);
+void ariel_midi_mapper_cancel_learn(ArielMidiMapper *mapper, ArielAudioEngine *engine);
+void ariel_midi_mapper_forget(ArielMidiMapper *mapper, ArielAudioEngine *engine, ArielActivePlugin *plugin, guint port);
+void ariel_midi_mapper_replace_plugin(ArielMidiMapper *mapper, ArielActivePlugin *old_plugin, ArielActivePlugin *new_plugin);
+void ariel_midi_mapper_publish(ArielMidiMapper *mapper, ArielAudioEngine *engine);
+void ariel_midi_mapper_dispatch(ArielMidiMapper *mapper, ArielAudioEngine *engine);
+void ariel_midi_mapper_save_to_keyfile(ArielMidiMapper *mapper, GKeyFile *keyfile);
+void ariel_midi_mapper_load_from_keyfile(ArielMidiMapper *mapper, ArielAudioEngine *engine, GKeyFile *keyfile);
+gboolean ariel_midi_map_apply(const ArielMidiMap *map, guint8 channel, guint8 cc, guint8 value);
+void ariel_midi_map_free(ArielMidiMap *map);
+
+// Recorder and retrospective capture (Unix only): input and output to disk
+// without file I/O on the audio thread
+ArielRecorder *ariel_recorder_new(const char *prefix, guint sample_rate);
+void ariel_recorder_free(ArielRecorder *recorder);
+void ariel_recorder_write(ArielRecorder *recorder, const float *in_L, const float *in_R,
+                          const float *out_L, const float *out_R, jack_nframes_t nframes);
+gboolean ariel_audio_engine_start_recording(ArielAudioEngine *engine, const char *prefix);
+void ariel_audio_engine_stop_recording(ArielAudioEngine *engine);
+ArielCapture *ariel_capture_new(guint sample_rate, guint seconds, gboolean lock_memory);
+ArielCapture *ariel_capture_ref(ArielCapture *capture);
+void ariel_capture_unref(ArielCapture *capture);
+void ariel_capture_write(ArielCapture *capture, const float *in_L, const float *in_R,
+                         const float *out_L, const float *out_R, jack_nframes_t nframes);
+gboolean ariel_capture_save(ArielCapture *capture, const char *prefix, guint seconds);
+void ariel_audio_engine_prepare_capture(ArielAudioEngine *engine);
+gboolean ariel_audio_engine_save_capture(ArielAudioEngine *engine, const char *prefix);
+
+// File player: a memory-mapped WAV file read ahead into the chain input
+ArielFilePlayer *ariel_file_player_new(const char *path, guint engine_rate);
+void ariel_file_player_free(ArielFilePlayer *player);
+void ariel_file_player_set_loop(ArielFilePlayer *player, gboolean loop);
+void ariel_file_player_set_mix(ArielFilePlayer *player, gboolean mix);
+void ariel_file_player_read(ArielFilePlayer *player, float *L, float *R, jack_nframes_t nframes);
+gboolean ariel_audio_engine_play_file(ArielAudioEngine *engine, const char *path, gboolean mix);
+
+// Slot mix stage: gain, dry/wet and pan around each plugin in the chain
+ArielSlotStage *ariel_slot_stage_new(void);
+void ariel_slot_stage_free(ArielSlotStage *stage);
+void ariel_slot_stage_set(ArielSlotStage *stage, const ArielSlotMix *mix);
+void ariel_slot_stage_get(ArielSlotStage *stage, ArielSlotMix *mix);
+void ariel_slot_stage_begin(ArielSlotStage *stage, float *buffer_L, float *buffer_R,
+                            float *dry_L, float *dry_R, jack_nframes_t nframes);
+void ariel_slot_stage_end(ArielSlotStage *stage, float *buffer_L, float *buffer_R,
+                          const float *dry_L, const float *dry_R, jack_nframes_t nframes);
+void ariel_slot_mix_save_to_keyfile(const ArielSlotMix *mix, GKeyFile *keyfile, const char *group);
+void ariel_slot_mix_load_from_keyfile(ArielSlotMix *mix, GKeyFile *keyfile, const char *group);
+float ariel_db_to_gain(double db);
+
+// Meters: measured on the audio thread, drawn at the display's frame rate
+void ariel_meter_update(ArielMeter *meter, const float *L, const float *R, guint nframes);
+void ariel_meter_take(ArielMeter *meter, float peak[2], float rms[2]);
+GtkWidget *ariel_meter_widget_new(ArielMeter *meter, GObject *owner, GtkOrientation orientation);
+void ariel_meters_attach(GtkWidget *widget);
+
+// Control socket (Unix only): "scene <name|N>" and "scenes" line commands
+typedef struct _ArielControlServer ArielControlServer;
+ArielControlServer *ariel_control_server_new(ArielApp *app);
+void ariel_control_server_free(ArielControlServer *server);
+
 GtkWidget *ariel_create_parameter_controls(ArielActivePlugin *plugin);
+void ariel_parameter_controls_sync(void);
+void ariel_parameter_controls_show_file(ArielActivePlugin *plugin, const char *parameter_uri, const char *file_path);
 
 // Configuration
 ArielConfig *ariel_config_new(void);
@@ -223,7 +666,11 @@ ArielPluginManager *ariel_plugin_manager_new(void);
 void ariel_plugin_manager_refresh(ArielPluginManager *manager);
 gboolean ariel_plugin_manager_load_cache(ArielPluginManager *manager);
 void ariel_plugin_manager_save_cache(ArielPluginManager *manager);
+ArielPluginInfo *ariel_plugin_manager_find_plugin(ArielPluginManager *manager, const char *uri);
 ArielActivePlugin *ariel_plugin_manager_load_plugin(ArielPluginManager *manager, ArielPluginInfo *plugin_info, ArielAudioEngine *engine);
+void ariel_plugin_manager_remove_plugin(ArielPluginManager *manager, ArielActivePlugin *plugin);
+void ariel_plugin_manager_clear_plugins(ArielPluginManager *manager);
+void ariel_plugin_manager_load_plugin_async(ArielPluginManager *manager, ArielPluginInfo *plugin_info, ArielAudioEngine *engine, ArielPluginLoadedFunc callback, gpointer user_data);
 void ariel_plugin_manager_free(ArielPluginManager *manager);
 
 // URID Map support
@@ -235,8 +682,8 @@ LV2_Feature **ariel_create_lv2_features(ArielPluginManager *manager, ArielAudioE
 void ariel_free_lv2_features(LV2_Feature **features);
 
 // LV2 Atom Path support
-char *ariel_map_absolute_path(LV2_State_Handle handle, const char *absolute_path);
-char *ariel_map_abstract_path(LV2_State_Handle handle, const char *abstract_path);
+char *ariel_map_absolute_path(LV2_State_Handle handle, const char *abstract_path);
+char *ariel_map_abstract_path(LV2_State_Handle handle, const char *absolute_path);
 LV2_URID ariel_get_atom_path_urid(ArielPluginManager *manager);
 
 // LV2 Worker Schedule support
@@ -249,7 +696,7 @@ void ariel_worker_process_responses(ArielWorkerSchedule *worker);
 
 // Active Plugin Worker Interface
 void ariel_active_plugin_process_worker_responses(ArielActivePlugin *plugin);
-void ariel_active_plugin_process_ui_messages(ArielActivePlugin *plugin);
+void ariel_active_plugin_fill_atom_inputs(ArielActivePlugin *plugin);
 gboolean ariel_active_plugin_has_work_interface(ArielActivePlugin *plugin);
 LilvInstance *ariel_active_plugin_get_instance(ArielActivePlugin *plugin);
 
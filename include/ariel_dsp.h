@@ -0,0 +1,112 @@
+#ifndef ARIEL_DSP_H
+#define ARIEL_DSP_H
+
+#include <glib.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Buffer kernels for the host's own audio work (see dsp_kernels.c). Every
+// kernel takes unaligned buffers of any length. One table is picked for
+// the CPU when the engine is created; until then the scalar one is used.
+typedef struct {
+    const char *name;
+    void (*copy)(float *dst, const float *src, guint n);
+    void (*fill)(float *dst, float value, guint n);
+    void (*gain)(float *buffer, float gain, guint n);
+    void (*gain_ramp)(float *buffer, float *copy, float gain, float step, guint n);
+    void (*mix_add)(float *dst, const float *src, float gain, guint n);
+    void (*blend)(float *buffer, const float *dry, float wet, float wet_step,
+                  float dry_gain, float dry_step, guint n);
+    float (*peak)(const float *src, guint n);
+    float (*sum_squares)(const float *src, guint n);
+    guint (*scrub)(float *buffer, guint n);
+} ArielDspKernels;
+
+extern const ArielDspKernels *ariel_dsp;
+
+void ariel_dsp_init(void);
+
+// Every table built into this binary, scalar reference first, and whether
+// the running CPU can execute a given one
+const ArielDspKernels *const *ariel_dsp_get_variants(guint *n_variants);
+gboolean ariel_dsp_variant_supported(const ArielDspKernels *kernels);
+
+// dst = src
+static inline void
+ariel_dsp_copy(float *dst, const float *src, guint n)
+{
+    ariel_dsp->copy(dst, src, n);
+}
+
+// dst = value
+static inline void
+ariel_dsp_fill(float *dst, float value, guint n)
+{
+    ariel_dsp->fill(dst, value, n);
+}
+
+// buffer *= gain
+static inline void
+ariel_dsp_gain(float *buffer, float gain, guint n)
+{
+    ariel_dsp->gain(buffer, gain, n);
+}
+
+// buffer[i] *= gain + i * step, copying the input to copy first unless it is NULL
+static inline void
+ariel_dsp_gain_ramp(float *buffer, float *copy, float gain, float step, guint n)
+{
+    ariel_dsp->gain_ramp(buffer, copy, gain, step, n);
+}
+
+// dst += src * gain
+static inline void
+ariel_dsp_mix_add(float *dst, const float *src, float gain, guint n)
+{
+    ariel_dsp->mix_add(dst, src, gain, n);
+}
+
+// buffer[i] = buffer[i] * (wet + i * wet_step) + dry[i] * (dry_gain + i * dry_step),
+// without the dry term when dry is NULL
+static inline void
+ariel_dsp_blend(float *buffer, const float *dry, float wet, float wet_step,
+                float dry_gain, float dry_step, guint n)
+{
+    ariel_dsp->blend(buffer, dry, wet, wet_step, dry_gain, dry_step, n);
+}
+
+// Left channel to both, for plugins with a single output
+static inline void
+ariel_dsp_stereoize(const float *L, float *R, guint n)
+{
+    ariel_dsp->copy(R, L, n);
+}
+
+// Largest absolute sample
+static inline float
+ariel_dsp_peak(const float *src, guint n)
+{
+    return ariel_dsp->peak(src, n);
+}
+
+static inline float
+ariel_dsp_rms(const float *src, guint n)
+{
+    return n > 0 ? sqrtf(ariel_dsp->sum_squares(src, n) / (float)n) : 0.0f;
+}
+
+// Zero every NaN or infinite sample; returns how many there were
+static inline guint
+ariel_dsp_scrub(float *buffer, guint n)
+{
+    return ariel_dsp->scrub(buffer, n);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ARIEL_DSP_H
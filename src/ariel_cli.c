@@ -1,6 +1,7 @@
 #include "ariel.h"
 #include <ncurses.h>
 #include <string.h>
+#include <math.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
@@ -10,6 +11,9 @@
 #include <limits.h>
 
 // CLI-specific enums and structures
+// How often the selected plugin's outputs are polled between keys
+#define CLI_OUTPUT_POLL_MS 50
+
 typedef enum {
     CLI_PANEL_PLUGIN_LIST = 0,
     CLI_PANEL_ACTIVE_PLUGINS = 1,
@@ -44,6 +48,11 @@ typedef struct {
     int plugin_list_scroll_offset;
     int active_plugins_scroll_offset;
     int plugin_controls_scroll_offset;
+    
+    // Control outputs of the selected plugin, as last drawn
+    ArielActivePlugin *outputs_plugin;  // Compared only, not a reference
+    float *output_values;
+    guint n_output_values;
 } ArielCLI;
 
 static ArielCLI *g_cli = NULL;
@@ -95,6 +104,7 @@ static void cli_draw_plugin_list(ArielCLI *cli);
 static void cli_draw_active_plugins(ArielCLI *cli);
 static void cli_draw_plugin_controls(ArielCLI *cli);
 static void cli_draw_controls(ArielCLI *cli);
+static void cli_poll_plugin_outputs(ArielCLI *cli);
 static void cli_draw_status(ArielCLI *cli);
 static void cli_refresh_all(ArielCLI *cli);
 static void cli_handle_input(ArielCLI *cli, int ch);
@@ -106,6 +116,8 @@ static void cli_toggle_bypass(ArielCLI *cli);
 static char* cli_file_picker(ArielCLI *cli, const char *initial_dir);
 static void cli_load_file(ArielCLI *cli);
 static void cli_adjust_parameter(ArielCLI *cli, float delta);
+static void cli_capture_scene(ArielCLI *cli);
+static void cli_recall_scene(ArielCLI *cli, guint index);
 static void cli_cleanup(ArielCLI *cli);
 
 // Get plugin name safely
@@ -517,6 +529,29 @@ static void cli_draw_plugin_controls(ArielCLI *cli)
             row++;
         }
         
+        // Show the plugin's outputs below, as last polled
+        guint n_outputs = ariel_active_plugin_get_n_control_outputs(plugin);
+        const LilvPlugin *lilv_plugin = ariel_active_plugin_get_lilv_plugin(plugin);
+        if (n_outputs > 0 && lilv_plugin && row < win_height - 2) {
+            row++;
+            mvwprintw(cli->plugin_controls_win, row++, 2, "Outputs:");
+            for (guint i = 0; i < n_outputs && row < win_height - 1; i++) {
+                uint32_t port_index = ariel_active_plugin_get_control_output_port_index(plugin, i);
+                const LilvPort *port = lilv_plugin_get_port_by_index(lilv_plugin, port_index);
+                LilvNode *name = port ? lilv_port_get_name(lilv_plugin, port) : NULL;
+                const char *output_name = name ? lilv_node_as_string(name) : "Output";
+                
+                if (cli->outputs_plugin == plugin && i < cli->n_output_values) {
+                    mvwprintw(cli->plugin_controls_win, row, 4, "%-20.20s %10.3f", output_name, cli->output_values[i]);
+                } else {
+                    mvwprintw(cli->plugin_controls_win, row, 4, "%-20.20s %10s", output_name, "--");
+                }
+                
+                lilv_node_free(name);
+                row++;
+            }
+        }
+        
         // Show scrolling indicator
         if (cli->max_plugin_controls > display_height) {
             mvwprintw(cli->plugin_controls_win, win_height - 1, win_width - 10, " %d/%d ", 
@@ -529,6 +564,48 @@ static void cli_draw_plugin_controls(ArielCLI *cli)
     wrefresh(cli->plugin_controls_win);
 }
 
+// Follow the selected plugin's control outputs between keys, redrawing its
+// panel only when one of them changed
+static void cli_poll_plugin_outputs(ArielCLI *cli)
+{
+    if (!cli->plugin_manager) return;
+    
+    GListModel *model = G_LIST_MODEL(cli->plugin_manager->active_plugin_store);
+    if (cli->active_plugin_selected < 0 ||
+        (guint)cli->active_plugin_selected >= g_list_model_get_n_items(model)) return;
+    
+    ArielActivePlugin *plugin = g_list_model_get_item(model, cli->active_plugin_selected);
+    if (!plugin) return;
+    
+    guint n_outputs = ariel_active_plugin_get_n_control_outputs(plugin);
+    float *fresh = n_outputs > 0 ? g_newa(float, n_outputs) : NULL;
+    gboolean changed = FALSE;
+    
+    if (fresh && ariel_active_plugin_read_control_outputs(plugin, fresh, n_outputs)) {
+        if (cli->outputs_plugin != plugin || cli->n_output_values != n_outputs) {
+            g_free(cli->output_values);
+            cli->output_values = g_new0(float, n_outputs);
+            cli->n_output_values = n_outputs;
+            cli->outputs_plugin = plugin;
+            changed = TRUE;
+        }
+        
+        // Thousandths are all the panel shows
+        for (guint i = 0; i < n_outputs; i++) {
+            if (changed || roundf(fresh[i] * 1000.0f) != roundf(cli->output_values[i] * 1000.0f)) {
+                cli->output_values[i] = fresh[i];
+                changed = TRUE;
+            }
+        }
+    }
+    
+    g_object_unref(plugin);
+    
+    if (changed) {
+        cli_draw_plugin_controls(cli);
+    }
+}
+
 static void cli_draw_controls(ArielCLI *cli)
 {
     if (!cli->controls_win) return;
@@ -565,6 +642,12 @@ static void cli_draw_controls(ArielCLI *cli)
     mvwprintw(cli->controls_win, row++, 4, "s - Start/Stop audio engine");
     row++;
     
+    // Scenes
+    mvwprintw(cli->controls_win, row++, 2, "Scenes:");
+    mvwprintw(cli->controls_win, row++, 4, "n - Capture chain as a new scene");
+    mvwprintw(cli->controls_win, row++, 4, "1-9 - Recall scene");
+    row++;
+    
     // Navigation
     mvwprintw(cli->controls_win, row++, 2, "Navigation:");
     mvwprintw(cli->controls_win, row++, 4, "Tab/←→ - Switch panels");
@@ -710,6 +793,17 @@ static void cli_handle_input(ArielCLI *cli, int ch)
             }
             break;
             
+        case 'n':
+        case 'N':
+            cli_capture_scene(cli);
+            break;
+            
+        case '1': case '2': case '3':
+        case '4': case '5': case '6':
+        case '7': case '8': case '9':
+            cli_recall_scene(cli, (guint)(ch - '1'));
+            break;
+            
         case '+':
         case '=':
             if (cli->current_panel == CLI_PANEL_PLUGIN_CONTROLS) {
@@ -883,17 +977,13 @@ static void cli_remove_plugin(ArielCLI *cli)
     // Suppress output during plugin operations
     OutputSuppressor *suppressor = suppress_output();
     
-    // Get the plugin before removing it to properly clean up
+    // Remove plugin from active list; the instance stays warm for reuse
     ArielActivePlugin *active_plugin = g_list_model_get_item(model, cli->active_plugin_selected);
     if (active_plugin) {
-        // Deactivate before removing
-        ariel_active_plugin_set_active(active_plugin, FALSE);
+        ariel_plugin_manager_remove_plugin(cli->plugin_manager, active_plugin);
         g_object_unref(active_plugin);
     }
     
-    // Remove plugin from active list
-    g_list_store_remove(cli->plugin_manager->active_plugin_store, cli->active_plugin_selected);
-    
     // Restore output
     restore_output(suppressor);
     
@@ -948,6 +1038,27 @@ static void cli_toggle_audio_engine(ArielCLI *cli)
     restore_output(suppressor);
 }
 
+static void cli_capture_scene(ArielCLI *cli)
+{
+    if (!cli->plugin_manager || !cli->plugin_manager->scenes) return;
+    
+    char *name = g_strdup_printf("Scene %u", ariel_scene_bank_get_n_scenes(cli->plugin_manager->scenes) + 1);
+    OutputSuppressor *suppressor = suppress_output();
+    ariel_scene_bank_capture(cli->plugin_manager->scenes, cli->plugin_manager, name);
+    restore_output(suppressor);
+    g_free(name);
+}
+
+static void cli_recall_scene(ArielCLI *cli, guint index)
+{
+    if (!cli->plugin_manager || !cli->plugin_manager->scenes || !cli->audio_engine) return;
+    if (index >= ariel_scene_bank_get_n_scenes(cli->plugin_manager->scenes)) return;
+    
+    OutputSuppressor *suppressor = suppress_output();
+    ariel_scene_bank_recall(cli->plugin_manager->scenes, cli->plugin_manager, cli->audio_engine, index);
+    restore_output(suppressor);
+}
+
 static void cli_toggle_bypass(ArielCLI *cli)
 {
     if (!cli->plugin_manager || cli->active_plugin_selected < 0) return;
@@ -1330,6 +1441,8 @@ static void cli_cleanup(ArielCLI *cli)
         ariel_audio_engine_stop(cli->audio_engine);
     }
     
+    g_free(cli->output_values);
+    
     endwin();
 }
 
@@ -1371,7 +1484,9 @@ int ariel_cli_main(int argc, char **argv)
     keypad(stdscr, TRUE);
     noecho();
     curs_set(0); // Hide cursor
-    // Remove timeout - we want blocking input to prevent constant refreshing
+    // Wake up between keys to poll plugin outputs and run pending GLib
+    // sources; the screen is only redrawn when an output changed
+    timeout(CLI_OUTPUT_POLL_MS);
     
     // Initialize colors
     if (has_colors()) {
@@ -1415,12 +1530,19 @@ int ariel_cli_main(int argc, char **argv)
     
     // Main loop
     while (g_cli->running) {
-        // Handle input - blocking call, no timeout
+        // Handle input, or poll the selected plugin's outputs on timeout
         int ch = getch();
         if (ch != ERR) {
             cli_handle_input(g_cli, ch);
-            // Only refresh after user input
+            // Only refresh everything after user input
             cli_refresh_all(g_cli);
+        } else {
+            cli_poll_plugin_outputs(g_cli);
+        }
+        
+        // No GLib main loop runs here, so dispatch the engine's reclaim
+        // timer, MIDI and plugin reports and any finished async loads
+        while (g_main_context_iteration(NULL, FALSE)) {
         }
     }
     
@@ -0,0 +1,230 @@
+#include "ariel.h"
+#include <stdio.h>
+#include <string.h>
+
+// Control socket.
+//
+// A Unix socket in the user's runtime directory that takes one command per
+// line, so scenes can be switched from scripts, foot controllers bridged
+// by other tools, or a shell:
+//
+//   scenes             list the scenes of the current chain
+//   scene <name|N>     recall a scene by name or 1-based number
+//   capture <name>     store the chain's current settings as a scene
+//   morph <N> <M>      arm a morph between scenes N and M (1-based)
+//   position <0..1>    move the armed morph
+//
+// Every command is answered with "ok" or "error <reason>". Commands run on
+// the main loop, like the UI's.
+
+#ifdef G_OS_UNIX
+
+#include <gio/gunixsocketaddress.h>
+#include <glib/gstdio.h>
+
+#define ARIEL_CONTROL_SOCKET "ariel.sock"
+
+struct _ArielControlServer {
+    ArielApp *app;
+    GSocketService *service;
+    GCancellable *cancellable;   // Cancelled on free; clients then stop
+    char *path;
+};
+
+typedef struct {
+    ArielControlServer *server;  // Only valid while cancellable is not cancelled
+    GCancellable *cancellable;
+    GSocketConnection *connection;
+    GDataInputStream *input;
+} ArielControlClient;
+
+static void ariel_control_client_read(ArielControlClient *client);
+
+static void
+ariel_control_client_free(ArielControlClient *client)
+{
+    g_object_unref(client->input);
+    g_object_unref(client->connection);
+    g_object_unref(client->cancellable);
+    g_free(client);
+}
+
+static void
+ariel_control_client_reply(ArielControlClient *client, const char *reply)
+{
+    GOutputStream *output = g_io_stream_get_output_stream(G_IO_STREAM(client->connection));
+    g_output_stream_write_all(output, reply, strlen(reply), NULL, client->cancellable, NULL);
+    g_output_stream_write_all(output, "\n", 1, NULL, client->cancellable, NULL);
+}
+
+static void
+ariel_control_client_handle(ArielControlClient *client, char *line)
+{
+    ArielControlServer *server = client->server;
+    ArielPluginManager *manager = ariel_app_get_plugin_manager(server->app);
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(server->app);
+
+    g_strstrip(line);
+    if (*line == '\0') {
+        return;
+    }
+
+    if (!manager || !manager->scenes || !engine) {
+        ariel_control_client_reply(client, "error engine not running");
+        return;
+    }
+
+    char *argument = strchr(line, ' ');
+    if (argument) {
+        *argument++ = '\0';
+        g_strstrip(argument);
+    }
+
+    if (g_str_equal(line, "scenes")) {
+        guint n_scenes = ariel_scene_bank_get_n_scenes(manager->scenes);
+        for (guint i = 0; i < n_scenes; i++) {
+            char *entry = g_strdup_printf("%u %s", i + 1, ariel_scene_bank_get_name(manager->scenes, i));
+            ariel_control_client_reply(client, entry);
+            g_free(entry);
+        }
+        ariel_control_client_reply(client, "ok");
+    } else if (g_str_equal(line, "scene") && argument && *argument) {
+        gboolean recalled = ariel_scene_bank_recall_by_name(manager->scenes, manager, engine, argument);
+        ariel_control_client_reply(client, recalled ? "ok" : "error no such scene for this chain");
+    } else if (g_str_equal(line, "capture") && argument && *argument) {
+        gint index = ariel_scene_bank_capture(manager->scenes, manager, argument);
+        ariel_control_client_reply(client, index >= 0 ? "ok" : "error chain is empty");
+    } else if (g_str_equal(line, "morph") && argument && *argument) {
+        guint from = 0;
+        guint to = 0;
+        if (sscanf(argument, "%u %u", &from, &to) != 2 || from == 0 || to == 0) {
+            ariel_control_client_reply(client, "error usage: morph <N> <M>");
+            return;
+        }
+        gboolean armed = ariel_scene_bank_morph(manager->scenes, manager, engine, from - 1, to - 1);
+        ariel_control_client_reply(client, armed ? "ok" : "error scenes do not match this chain");
+    } else if (g_str_equal(line, "position") && argument && *argument) {
+        char *end = NULL;
+        gdouble position = g_ascii_strtod(argument, &end);
+        if (end == argument || *end != '\0') {
+            ariel_control_client_reply(client, "error usage: position <0..1>");
+            return;
+        }
+        ariel_audio_engine_set_morph_position(engine, (float)position);
+        ariel_control_client_reply(client, "ok");
+    } else {
+        ariel_control_client_reply(client, "error unknown command");
+    }
+}
+
+static void
+on_control_line_read(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+    ArielControlClient *client = user_data;
+    GError *error = NULL;
+
+    char *line = g_data_input_stream_read_line_finish(G_DATA_INPUT_STREAM(source), result, NULL, &error);
+    if (!line || g_cancellable_is_cancelled(client->cancellable)) {
+        // End of stream, a read error, or the server is gone
+        g_clear_error(&error);
+        g_free(line);
+        ariel_control_client_free(client);
+        return;
+    }
+
+    ariel_control_client_handle(client, line);
+    g_free(line);
+    ariel_control_client_read(client);
+}
+
+static void
+ariel_control_client_read(ArielControlClient *client)
+{
+    g_data_input_stream_read_line_async(client->input, G_PRIORITY_DEFAULT, client->cancellable,
+                                        on_control_line_read, client);
+}
+
+static gboolean
+on_control_incoming(G_GNUC_UNUSED GSocketService *service, GSocketConnection *connection,
+                    G_GNUC_UNUSED GObject *source_object, ArielControlServer *server)
+{
+    ArielControlClient *client = g_new0(ArielControlClient, 1);
+    client->server = server;
+    client->cancellable = g_object_ref(server->cancellable);
+    client->connection = g_object_ref(connection);
+    client->input = g_data_input_stream_new(g_io_stream_get_input_stream(G_IO_STREAM(connection)));
+    g_data_input_stream_set_newline_type(client->input, G_DATA_STREAM_NEWLINE_TYPE_ANY);
+
+    ariel_control_client_read(client);
+    return TRUE;
+}
+
+ArielControlServer *
+ariel_control_server_new(ArielApp *app)
+{
+    ArielControlServer *server = g_new0(ArielControlServer, 1);
+    server->app = app;
+    server->cancellable = g_cancellable_new();
+    server->path = g_build_filename(g_get_user_runtime_dir(), ARIEL_CONTROL_SOCKET, NULL);
+
+    // The application is single-instance, so a leftover socket is stale
+    g_unlink(server->path);
+
+    GError *error = NULL;
+    GSocketAddress *address = g_unix_socket_address_new(server->path);
+    server->service = g_socket_service_new();
+
+    if (!g_socket_listener_add_address(G_SOCKET_LISTENER(server->service), address,
+                                       G_SOCKET_TYPE_STREAM, G_SOCKET_PROTOCOL_DEFAULT,
+                                       NULL, NULL, &error)) {
+        g_warning("Could not open control socket %s: %s", server->path, error->message);
+        g_error_free(error);
+        g_object_unref(address);
+        g_object_unref(server->service);
+        g_object_unref(server->cancellable);
+        g_free(server->path);
+        g_free(server);
+        return NULL;
+    }
+    g_object_unref(address);
+
+    g_signal_connect(server->service, "incoming", G_CALLBACK(on_control_incoming), server);
+    g_socket_service_start(server->service);
+
+    g_print("Control socket listening on %s\n", server->path);
+    return server;
+}
+
+void
+ariel_control_server_free(ArielControlServer *server)
+{
+    if (!server) return;
+
+    g_cancellable_cancel(server->cancellable);
+    g_socket_service_stop(server->service);
+    g_socket_listener_close(G_SOCKET_LISTENER(server->service));
+    g_signal_handlers_disconnect_by_data(server->service, server);
+    g_object_unref(server->service);
+    g_object_unref(server->cancellable);
+
+    g_unlink(server->path);
+    g_free(server->path);
+    g_free(server);
+}
+
+#else
+
+// No Unix sockets here; scenes stay reachable from the UI and the CLI
+
+ArielControlServer *
+ariel_control_server_new(G_GNUC_UNUSED ArielApp *app)
+{
+    return NULL;
+}
+
+void
+ariel_control_server_free(G_GNUC_UNUSED ArielControlServer *server)
+{
+}
+
+#endif
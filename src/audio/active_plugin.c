@@ -1,9 +1,22 @@
+#define _GNU_SOURCE
 #include "ariel.h"
+#include <stdio.h>
 #include <string.h>
+#include <stdatomic.h>
+#include <gmodule.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
 #include <lv2/atom/atom.h>
 #include <lv2/atom/forge.h>
 #include <lv2/atom/util.h>
 #include <lv2/patch/patch.h>
+#include <lv2/port-props/port-props.h>
+#include <lv2/midi/midi.h>
+#include <lv2/time/time.h>
+
+// Room for the Atom outputs the main thread has not read yet
+#define ARIEL_ATOM_OUTPUT_RING_SIZE  (16 * 1024)
 
 // ArielActivePlugin structure
 struct _ArielActivePlugin {
@@ -13,6 +26,8 @@ struct _ArielActivePlugin {
     ArielPluginInfo *plugin_info;
     const LilvPlugin *lilv_plugin;
     LilvInstance *instance;
+    char *library_path;
+    GModule *library;
     
     // Plugin properties
     char *name;
@@ -30,6 +45,10 @@ struct _ArielActivePlugin {
     float **audio_output_buffers;
     float *control_input_values;
     float *control_output_values;
+    float *control_output_snapshot;     // Two copies of the outputs for the UI, see publish
+    gint control_output_serial;         // Copies published; its low bit picks the newest
+    float *control_default_values;
+    ArielControlKind *control_kinds;    // How each control input morphs
     
     // Port index mappings
     uint32_t *audio_input_port_indices;
@@ -45,6 +64,8 @@ struct _ArielActivePlugin {
     void **atom_input_buffers;
     void **atom_output_buffers;
     uint32_t atom_buffer_size;
+    jack_ringbuffer_t *atom_output_ring; // Non-empty output sequences for the main thread
+    GHashTable *reported_files;         // Parameter URI -> path the plugin reported (main thread)
     
     // URIDs for Atom messaging
     LV2_URID_Map *urid_map;
@@ -52,19 +73,49 @@ struct _ArielActivePlugin {
     LV2_URID atom_Object ;
     LV2_URID atom_String;
     LV2_URID atom_Sequence;
+    LV2_URID atom_Chunk;
+    LV2_URID atom_URID;
+    LV2_URID midi_MidiEvent;
+    LV2_URID time_Position;
+    LV2_URID time_frame;
+    LV2_URID time_speed;
+    LV2_URID time_bar;
+    LV2_URID time_barBeat;
+    LV2_URID time_beatUnit;
+    LV2_URID time_beatsPerBar;
+    LV2_URID time_beatsPerMinute;
     LV2_URID patch_Set;
     LV2_URID patch_property;
     LV2_URID patch_value;
     LV2_URID plugin_model_uri;
     
-    // Audio engine reference
+    // Audio engine and plugin manager references
     ArielAudioEngine *engine;
+    ArielPluginManager *manager;
     
     // UI communication
     GAsyncQueue *ui_messages;
     
-    // Atom message state tracking
-    gint atom_message_cycles;
+    // Atom input state (audio thread)
+    LV2_Atom_Forge forge;               // Initialized with the URID map at setup
+    gint midi_input;                    // Atom input that takes midi:MidiEvent, or -1
+    gint time_input;                    // Atom input that takes time:Position, or -1
+    guint time_serial;                  // Engine position_serial last sent
+    gboolean atom_inputs_dirty;         // Some input still holds last cycle's events
+    
+    // Host-side gain, dry/wet and pan around the plugin, and the slot's output level
+    ArielSlotStage *slot_stage;
+    ArielMeter meter;
+    
+    // Number of chain snapshots holding this plugin (main thread only)
+    guint chain_refs;
+    
+    // Resident memory the instance added when it was created
+    gsize memory_cost;
+    
+    // Hash of the state snapshot last saved from or restored into the
+    // instance, 0 if unknown; atomic
+    gint state_snapshot_hash;
 };
 
 // UI message structure for thread-safe communication
@@ -77,6 +128,12 @@ typedef struct {
 
 G_DEFINE_FINAL_TYPE(ArielActivePlugin, ariel_active_plugin, G_TYPE_OBJECT)
 
+// lilv keeps a shared table of open plugin libraries that is not thread-safe,
+// so instantiation and teardown on loader threads are serialized here. Every
+// lookup lilv_plugin_instantiate needs from the world is made once in prepare,
+// on the main thread, so under the lock it only reads cached data.
+static GMutex lilv_instance_mutex;
+
 static void
 ariel_active_plugin_finalize(GObject *object)
 {
@@ -87,14 +144,23 @@ ariel_active_plugin_finalize(GObject *object)
     
     // Free instance
     if (plugin->instance) {
+        g_mutex_lock(&lilv_instance_mutex);
         lilv_instance_free(plugin->instance);
+        g_mutex_unlock(&lilv_instance_mutex);
     }
+    if (plugin->library) {
+        g_module_close(plugin->library);
+    }
+    g_free(plugin->library_path);
     
     // Free buffers
     g_free(plugin->audio_input_buffers);
     g_free(plugin->audio_output_buffers);
+    g_free(plugin->control_default_values);
+    g_free(plugin->control_kinds);
     g_free(plugin->control_input_values);    //g_free(plugin->control_output_values);\n    \n    // Free port index arrays\n    g_free(plugin->audio_input_port_indices);\n    g_free(plugin->audio_output_port_indices);\n    g_free(plugin->control_input_port_indices);\n    g_free(plugin->control_output_port_indices);\r
     g_free(plugin->control_output_values);
+    g_free(plugin->control_output_snapshot);
 
     // Free port index arrays
     g_free(plugin->audio_input_port_indices);
@@ -116,10 +182,16 @@ ariel_active_plugin_finalize(GObject *object)
     }
     g_free(plugin->atom_input_port_indices);
     g_free(plugin->atom_output_port_indices);
+    if (plugin->atom_output_ring) {
+        jack_ringbuffer_free(plugin->atom_output_ring);
+    }
+    g_hash_table_destroy(plugin->reported_files);
 
     // Free strings
     g_free(plugin->name);
     
+    ariel_slot_stage_free(plugin->slot_stage);
+    
     // Clean up UI message queue
     if (plugin->ui_messages) {
         ArielUIMessage *msg;
@@ -162,17 +234,40 @@ ariel_active_plugin_init(ArielActivePlugin *plugin)
     plugin->audio_output_buffers = NULL;
     plugin->control_input_values = NULL;
     plugin->control_output_values = NULL;
+    plugin->control_output_snapshot = NULL;
+    plugin->control_output_serial = 0;
     plugin->atom_input_port_indices = NULL;
     plugin->atom_output_port_indices = NULL;
     plugin->atom_input_buffers = NULL;
     plugin->atom_output_buffers = NULL;
+    plugin->atom_output_ring = NULL;
+    plugin->reported_files = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
     plugin->engine = NULL;
     plugin->ui_messages = g_async_queue_new();
-    plugin->atom_message_cycles = 0;
+    plugin->midi_input = -1;
+    plugin->time_input = -1;
+    plugin->atom_inputs_dirty = FALSE;
+    plugin->slot_stage = ariel_slot_stage_new();
 }
 
 ArielActivePlugin *
 ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
+{
+    ArielActivePlugin *plugin = ariel_active_plugin_prepare(plugin_info, engine);
+    if (!plugin) return NULL;
+    
+    if (!ariel_active_plugin_instantiate(plugin)) {
+        g_object_unref(plugin);
+        return NULL;
+    }
+    
+    return plugin;
+}
+
+// Introspect ports and set defaults without instantiating. This queries the
+// lilv world, so it must run on the main thread.
+ArielActivePlugin *
+ariel_active_plugin_prepare(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
 {
     if (!plugin_info || !engine) return NULL;
     
@@ -192,6 +287,20 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
         return NULL;
     }
     
+    // Resolve everything instantiate needs from the world here, since this
+    // loads the plugin's data files and instantiate may run on another thread
+    const LilvNode *library_uri = lilv_plugin_get_library_uri(plugin->lilv_plugin);
+    if (library_uri) {
+        char *library_path = lilv_file_uri_parse(lilv_node_as_uri(library_uri), NULL);
+        plugin->library_path = g_strdup(library_path);
+        lilv_free(library_path);
+    }
+    if (!plugin->library_path || !lilv_plugin_get_bundle_uri(plugin->lilv_plugin)) {
+        g_warning("No library or bundle for plugin %s", plugin->name);
+        g_object_unref(plugin);
+        return NULL;
+    }
+    
     // Proper port introspection
     plugin->n_audio_inputs = 0;
     plugin->n_audio_outputs = 0;
@@ -209,6 +318,8 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
     LilvNode *atom_port_uri = lilv_new_uri(world, LV2_ATOM__AtomPort);
     LilvNode *input_port_uri = lilv_new_uri(world, LILV_URI_INPUT_PORT);
     LilvNode *output_port_uri = lilv_new_uri(world, LILV_URI_OUTPUT_PORT);
+    LilvNode *midi_event_uri = lilv_new_uri(world, LV2_MIDI__MidiEvent);
+    LilvNode *time_position_uri = lilv_new_uri(world, LV2_TIME__Position);
     
     // Count ports by type
     const uint32_t num_ports = lilv_plugin_get_num_ports(plugin->lilv_plugin);
@@ -300,6 +411,16 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
         } else if (lilv_port_is_a(plugin->lilv_plugin, port, atom_port_uri)) {
             if (lilv_port_is_a(plugin->lilv_plugin, port, input_port_uri)) {
                 if (atom_in_idx < plugin->n_atom_inputs) {
+                    // Engine MIDI goes to the first input that accepts it
+                    if (plugin->midi_input < 0 &&
+                        lilv_port_supports_event(plugin->lilv_plugin, port, midi_event_uri)) {
+                        plugin->midi_input = (gint)atom_in_idx;
+                    }
+                    // Likewise the transport position, for tempo-synced plugins
+                    if (plugin->time_input < 0 &&
+                        lilv_port_supports_event(plugin->lilv_plugin, port, time_position_uri)) {
+                        plugin->time_input = (gint)atom_in_idx;
+                    }
                     plugin->atom_input_port_indices[atom_in_idx++] = i;
                 }
             } else if (lilv_port_is_a(plugin->lilv_plugin, port, output_port_uri)) {
@@ -311,6 +432,8 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
     }
 
     // Free URI nodes again
+    lilv_node_free(midi_event_uri);
+    lilv_node_free(time_position_uri);
     lilv_node_free(audio_port_uri);
     lilv_node_free(control_port_uri);
     lilv_node_free(atom_port_uri);
@@ -322,12 +445,20 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
         g_malloc0(plugin->n_control_inputs * sizeof(float)) : NULL;
     plugin->control_output_values = plugin->n_control_outputs > 0 ? 
         g_malloc0(plugin->n_control_outputs * sizeof(float)) : NULL;
+    plugin->control_output_snapshot = plugin->n_control_outputs > 0 ? 
+        g_malloc0(2 * plugin->n_control_outputs * sizeof(float)) : NULL;
     
     // Initialize control input values with defaults
     if (plugin->n_control_inputs > 0) {
         // Create URI nodes once for this loop
         LilvNode *control_uri = lilv_new_uri(world, LILV_URI_CONTROL_PORT);
         LilvNode *input_uri = lilv_new_uri(world, LILV_URI_INPUT_PORT);
+        LilvNode *toggled_uri = lilv_new_uri(world, LV2_CORE__toggled);
+        LilvNode *integer_uri = lilv_new_uri(world, LV2_CORE__integer);
+        LilvNode *enumeration_uri = lilv_new_uri(world, LV2_CORE__enumeration);
+        LilvNode *logarithmic_uri = lilv_new_uri(world, LV2_PORT_PROPS__logarithmic);
+        
+        plugin->control_kinds = g_new(ArielControlKind, plugin->n_control_inputs);
         
         uint32_t control_idx = 0;
         for (uint32_t i = 0; i < num_ports && control_idx < plugin->n_control_inputs; i++) {
@@ -347,6 +478,16 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
                     plugin->control_input_values[control_idx] = 0.0f;
                 }
                 
+                if (lilv_port_has_property(plugin->lilv_plugin, port, toggled_uri) ||
+                    lilv_port_has_property(plugin->lilv_plugin, port, integer_uri) ||
+                    lilv_port_has_property(plugin->lilv_plugin, port, enumeration_uri)) {
+                    plugin->control_kinds[control_idx] = ARIEL_CONTROL_STEPPED;
+                } else if (lilv_port_has_property(plugin->lilv_plugin, port, logarithmic_uri)) {
+                    plugin->control_kinds[control_idx] = ARIEL_CONTROL_LOGARITHMIC;
+                } else {
+                    plugin->control_kinds[control_idx] = ARIEL_CONTROL_LINEAR;
+                }
+                
                 control_idx++;
             }
         }
@@ -354,6 +495,15 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
         // Free URI nodes
         lilv_node_free(control_uri);
         lilv_node_free(input_uri);
+        lilv_node_free(toggled_uri);
+        lilv_node_free(integer_uri);
+        lilv_node_free(enumeration_uri);
+        lilv_node_free(logarithmic_uri);
+        
+        // Kept so a pooled instance can be reset for reuse
+        plugin->control_default_values = g_new(float, plugin->n_control_inputs);
+        memcpy(plugin->control_default_values, plugin->control_input_values,
+               plugin->n_control_inputs * sizeof(float));
     }
 
     // Get LV2 features from plugin manager
@@ -366,11 +516,11 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
         return NULL;
     }
     
-    // Create or update features with engine reference
-    if (plugin_manager->features) {
-        ariel_free_lv2_features(plugin_manager->features);
+    // Features are shared by every instance and live as long as the manager,
+    // since plugins keep pointers to them
+    if (!plugin_manager->features) {
+        plugin_manager->features = ariel_create_lv2_features(plugin_manager, engine);
     }
-    plugin_manager->features = ariel_create_lv2_features(plugin_manager, engine);
     
     if (!plugin_manager->features) {
         g_warning("Failed to create LV2 features for %s", plugin->name);
@@ -378,13 +528,80 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
         return NULL;
     }
     
+    // Check required features now, which is also the last world lookup
+    // lilv_plugin_instantiate makes
+    LilvNodes *required = lilv_plugin_get_required_features(plugin->lilv_plugin);
+    LILV_FOREACH(nodes, i, required) {
+        const char *feature_uri = lilv_node_as_uri(lilv_nodes_get(required, i));
+        gboolean supported = FALSE;
+        for (guint j = 0; plugin_manager->features[j] && !supported; j++) {
+            supported = strcmp(plugin_manager->features[j]->URI, feature_uri) == 0;
+        }
+        if (!supported) {
+            g_warning("Plugin %s requires unsupported feature %s", plugin->name, feature_uri);
+            lilv_nodes_free(required);
+            g_object_unref(plugin);
+            return NULL;
+        }
+    }
+    lilv_nodes_free(required);
+    
+    plugin->manager = plugin_manager;
+    return plugin;
+}
+
+// Resident set size of the process, or 0 where it cannot be read
+static gsize
+ariel_resident_memory(void)
+{
+#ifdef __linux__
+    gsize size = 0, resident = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    if (statm) {
+        if (fscanf(statm, "%" G_GSIZE_FORMAT " %" G_GSIZE_FORMAT, &size, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(statm);
+    }
+    return resident * (gsize)sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+// Instantiate a prepared plugin and connect its ports. Safe to call from a
+// loader thread; the plugin must not be in the chain yet.
+gboolean
+ariel_active_plugin_instantiate(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), FALSE);
+    g_return_val_if_fail(plugin->instance == NULL, FALSE);
+    
+    ArielPluginManager *manager = plugin->manager;
+    if (!manager || !manager->features) {
+        g_warning("Plugin %s was not prepared", plugin->name);
+        return FALSE;
+    }
+    
+    // Only an estimate when several loaders run at once, but good enough
+    // to budget the warm pool
+    gsize resident_before = ariel_resident_memory();
+    
+    // Map and relocate the binary outside the lilv lock, so several loader
+    // threads can do the expensive part at once. lilv's own dlopen of the
+    // same path then only takes another reference.
+    if (!plugin->library) {
+        plugin->library = g_module_open(plugin->library_path, G_MODULE_BIND_LOCAL);
+    }
+    
     // Create plugin instance with LV2 features
-    plugin->instance = lilv_plugin_instantiate(plugin->lilv_plugin, engine->sample_rate, 
-                                              (const LV2_Feature* const*)plugin_manager->features);
+    g_mutex_lock(&lilv_instance_mutex);
+    plugin->instance = lilv_plugin_instantiate(plugin->lilv_plugin, plugin->engine->sample_rate, 
+                                              (const LV2_Feature* const*)manager->features);
+    g_mutex_unlock(&lilv_instance_mutex);
     if (!plugin->instance) {
         g_warning("Failed to instantiate plugin %s", plugin->name);
-        g_object_unref(plugin);
-        return NULL;
+        return FALSE;
     }
 
     // Connect control ports to their value arrays (with safety checks)
@@ -419,13 +636,24 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
         
         if (!plugin->urid_map) {
             g_warning("Could not find LV2_URID_Map in features");
-            return NULL;
+            return FALSE;
         }
         
         plugin->atom_Path = ariel_urid_map(manager->urid_map, LV2_ATOM__Path);
         plugin->atom_Object = ariel_urid_map(manager->urid_map, LV2_ATOM__Object);
         plugin->atom_String = ariel_urid_map(manager->urid_map, LV2_ATOM__String);
         plugin->atom_Sequence = ariel_urid_map(manager->urid_map, LV2_ATOM__Sequence);
+        plugin->atom_Chunk = ariel_urid_map(manager->urid_map, LV2_ATOM__Chunk);
+        plugin->atom_URID = ariel_urid_map(manager->urid_map, LV2_ATOM__URID);
+        plugin->midi_MidiEvent = ariel_urid_map(manager->urid_map, LV2_MIDI__MidiEvent);
+        plugin->time_Position = ariel_urid_map(manager->urid_map, LV2_TIME__Position);
+        plugin->time_frame = ariel_urid_map(manager->urid_map, LV2_TIME__frame);
+        plugin->time_speed = ariel_urid_map(manager->urid_map, LV2_TIME__speed);
+        plugin->time_bar = ariel_urid_map(manager->urid_map, LV2_TIME__bar);
+        plugin->time_barBeat = ariel_urid_map(manager->urid_map, LV2_TIME__barBeat);
+        plugin->time_beatUnit = ariel_urid_map(manager->urid_map, LV2_TIME__beatUnit);
+        plugin->time_beatsPerBar = ariel_urid_map(manager->urid_map, LV2_TIME__beatsPerBar);
+        plugin->time_beatsPerMinute = ariel_urid_map(manager->urid_map, LV2_TIME__beatsPerMinute);
         plugin->patch_Set = ariel_urid_map(manager->urid_map, LV2_PATCH__Set);
         plugin->patch_property = ariel_urid_map(manager->urid_map, LV2_PATCH__property);
         plugin->patch_value = ariel_urid_map(manager->urid_map, LV2_PATCH__value);
@@ -433,6 +661,9 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
         // Neural Amp Modeler specific model parameter URI
         plugin->plugin_model_uri = ariel_urid_map(manager->urid_map, 
             "http://github.com/mikeoliphant/neural-amp-modeler-lv2#model");
+        
+        // Mapping URIDs is not real-time safe, so the forge is set up here
+        lv2_atom_forge_init(&plugin->forge, plugin->urid_map);
     }
     
     // Set up Atom buffers (4KB should be sufficient for most messages)
@@ -471,13 +702,90 @@ ariel_active_plugin_new(ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
                                      plugin->atom_output_port_indices[i],
                                      plugin->atom_output_buffers[i]);
         }
+        
+        plugin->atom_output_ring = jack_ringbuffer_create(ARIEL_ATOM_OUTPUT_RING_SIZE);
+        jack_ringbuffer_mlock(plugin->atom_output_ring);
     }
 
     // Audio ports will be connected dynamically during processing
 
+    gsize resident_after = ariel_resident_memory();
+    plugin->memory_cost = resident_after > resident_before ? resident_after - resident_before : 0;
+
     g_print("Created active plugin: %s\n", plugin->name);
     
-    return plugin;
+    return TRUE;
+}
+
+// Control outputs for the UI.
+//
+// After each run the audio thread copies the plugin's control outputs into
+// one of two snapshots and then bumps control_output_serial, whose low bit
+// names the copy just written. A reader copies the newest snapshot and
+// checks that the serial did not move meanwhile: a seqlock whose writer
+// never waits and never writes over the copy it last published, so a
+// reader only has to retry when a whole cycle ends during its copy. The UI
+// polls once per frame, however many cycles ran in between.
+static void
+ariel_active_plugin_publish_control_outputs(ArielActivePlugin *plugin)
+{
+    if (!plugin->control_output_snapshot) {
+        return;
+    }
+    
+    guint serial = (guint)g_atomic_int_get(&plugin->control_output_serial) + 1;
+    float *snapshot = plugin->control_output_snapshot + (serial & 1) * plugin->n_control_outputs;
+    memcpy(snapshot, plugin->control_output_values, plugin->n_control_outputs * sizeof(float));
+    g_atomic_int_set(&plugin->control_output_serial, (gint)serial);
+}
+
+// Atom outputs for the UI.
+//
+// Before each run the output buffers are offered to the plugin as an empty
+// chunk of their full capacity, which it overwrites with the sequence it
+// writes. After the run every sequence holding at least one event is
+// copied whole into the plugin's ring, with the port it came from; empty
+// ones, the usual case, cost one comparison. The main thread drains the
+// ring on its regular pass and reads the patch:Set messages, so the UI
+// learns which file a plugin actually loaded. A full ring drops the
+// sequence rather than wait.
+typedef struct {
+    uint32_t port;                      // Atom output, 0 .. n_atom_outputs - 1
+    uint32_t size;                      // Bytes of the LV2_Atom_Sequence that follows
+} ArielAtomOutputHeader;
+
+static void
+ariel_active_plugin_reset_atom_outputs(ArielActivePlugin *plugin)
+{
+    for (guint i = 0; plugin->atom_output_buffers && i < plugin->n_atom_outputs; i++) {
+        LV2_Atom *atom = (LV2_Atom *)plugin->atom_output_buffers[i];
+        atom->type = plugin->atom_Chunk;
+        atom->size = plugin->atom_buffer_size - sizeof(LV2_Atom);
+    }
+}
+
+static void
+ariel_active_plugin_publish_atom_outputs(ArielActivePlugin *plugin)
+{
+    if (!plugin->atom_output_ring) {
+        return;
+    }
+    
+    for (guint i = 0; i < plugin->n_atom_outputs; i++) {
+        const LV2_Atom_Sequence *seq = plugin->atom_output_buffers[i];
+        if (seq->atom.type != plugin->atom_Sequence ||
+            seq->atom.size <= sizeof(LV2_Atom_Sequence_Body) ||
+            seq->atom.size > plugin->atom_buffer_size - sizeof(LV2_Atom)) {
+            continue;
+        }
+        
+        ArielAtomOutputHeader header = { i, (uint32_t)sizeof(LV2_Atom) + seq->atom.size };
+        if (jack_ringbuffer_write_space(plugin->atom_output_ring) < sizeof(header) + header.size) {
+            continue;
+        }
+        jack_ringbuffer_write(plugin->atom_output_ring, (const char *)&header, sizeof(header));
+        jack_ringbuffer_write(plugin->atom_output_ring, (const char *)seq, header.size);
+    }
 }
 
 void
@@ -487,24 +795,63 @@ ariel_active_plugin_process(ArielActivePlugin *plugin, jack_nframes_t nframes)
         return;
     }
     
-    // Process UI messages before running plugin (jalv-style approach)
-    ariel_active_plugin_process_ui_messages(plugin);
+    // Deliver UI messages and this cycle's MIDI (jalv-style approach)
+    ariel_active_plugin_fill_atom_inputs(plugin);
     
-    // Reset Atom output buffers for each processing cycle
-    if (plugin->atom_output_buffers && plugin->n_atom_outputs > 0) {
-        for (guint i = 0; i < plugin->n_atom_outputs; i++) {
-            if (plugin->atom_output_buffers[i]) {
-                LV2_Atom_Sequence *seq = (LV2_Atom_Sequence*)plugin->atom_output_buffers[i];
-                seq->atom.type = plugin->atom_Sequence;
-                seq->atom.size = sizeof(LV2_Atom_Sequence_Body);
-                seq->body.unit = 0;
-                seq->body.pad = 0;
-            }
-        }
-    }
+    // Hand the Atom output buffers back empty for this cycle
+    ariel_active_plugin_reset_atom_outputs(plugin);
     
     // Run the plugin
     lilv_instance_run(plugin->instance, nframes);
+    
+    ariel_active_plugin_publish_control_outputs(plugin);
+    ariel_active_plugin_publish_atom_outputs(plugin);
+}
+
+// Run a freshly activated instance through a few blocks of silence at the
+// engine's block size, off the audio thread, so lazy allocations and
+// first-touch page faults in run() happen before it joins the live chain.
+// The plugin must not be in a chain yet.
+void
+ariel_active_plugin_warm_up(ArielActivePlugin *plugin, guint n_blocks)
+{
+    g_return_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin));
+    
+    if (!plugin->instance || !plugin->active || n_blocks == 0) {
+        return;
+    }
+    
+    guint block_size = plugin->engine && plugin->engine->buffer_size > 0 ?
+        (guint)plugin->engine->buffer_size : ARIEL_WARM_UP_BLOCK_SIZE;
+    block_size = MIN(block_size, 8192);
+    
+    // A zeroed buffer per port, so plugins that misbehave in place are safe
+    guint n_buffers = plugin->n_audio_inputs + plugin->n_audio_outputs;
+    float *buffers = g_new0(float, (gsize)MAX(n_buffers, 1) * block_size);
+    
+    for (guint i = 0; i < plugin->n_audio_inputs; i++) {
+        lilv_instance_connect_port(plugin->instance, plugin->audio_input_port_indices[i],
+                                   buffers + (gsize)i * block_size);
+    }
+    for (guint i = 0; i < plugin->n_audio_outputs; i++) {
+        lilv_instance_connect_port(plugin->instance, plugin->audio_output_port_indices[i],
+                                   buffers + (gsize)(plugin->n_audio_inputs + i) * block_size);
+    }
+    
+    gint64 start_time = g_get_monotonic_time();
+    for (guint block = 0; block < n_blocks; block++) {
+        // Inputs stay silent even if the plugin wrote to them
+        memset(buffers, 0, (gsize)plugin->n_audio_inputs * block_size * sizeof(float));
+        
+        ariel_active_plugin_reset_atom_outputs(plugin);
+        lilv_instance_run(plugin->instance, block_size);
+    }
+    
+    // Safe to free: the audio thread connects its own buffers before every run
+    g_free(buffers);
+    
+    g_print("Warmed up %s with %u blocks of %u frames in %.2f ms\n", plugin->name, n_blocks,
+            block_size, (g_get_monotonic_time() - start_time) / 1000.0);
 }
 
 void
@@ -538,6 +885,27 @@ ariel_active_plugin_get_name(ArielActivePlugin *plugin)
     return plugin->name;
 }
 
+ArielPluginManager *
+ariel_active_plugin_get_manager(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), NULL);
+    return plugin->manager;
+}
+
+ArielAudioEngine *
+ariel_active_plugin_get_engine(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), NULL);
+    return plugin->engine;
+}
+
+const char *
+ariel_active_plugin_get_library_path(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), NULL);
+    return plugin->library_path;
+}
+
 const LilvPlugin *
 ariel_active_plugin_get_lilv_plugin(ArielActivePlugin *plugin)
 {
@@ -693,6 +1061,143 @@ ariel_active_plugin_get_bypass(ArielActivePlugin *plugin)
     return plugin ? plugin->bypass : FALSE;
 }
 
+ArielControlKind
+ariel_active_plugin_get_control_kind(ArielActivePlugin *plugin, uint32_t index)
+{
+    if (!plugin || !plugin->control_kinds || index >= plugin->n_control_inputs) {
+        return ARIEL_CONTROL_LINEAR;
+    }
+    return plugin->control_kinds[index];
+}
+
+// Range of a control input from its port description (main thread)
+void
+ariel_active_plugin_get_control_range(ArielActivePlugin *plugin, uint32_t index, float *min, float *max)
+{
+    *min = 0.0f;
+    *max = 1.0f;
+    
+    if (!plugin || !plugin->lilv_plugin || index >= plugin->n_control_inputs) {
+        return;
+    }
+    
+    const LilvPort *port = lilv_plugin_get_port_by_index(plugin->lilv_plugin,
+                                                         plugin->control_input_port_indices[index]);
+    LilvNode *min_node = NULL;
+    LilvNode *max_node = NULL;
+    lilv_port_get_range(plugin->lilv_plugin, port, NULL, &min_node, &max_node);
+    
+    if (min_node) {
+        *min = lilv_node_as_float(min_node);
+        lilv_node_free(min_node);
+    }
+    if (max_node) {
+        *max = lilv_node_as_float(max_node);
+        lilv_node_free(max_node);
+    }
+}
+
+// The slot's mix stage. It lives as long as the plugin; the audio thread
+// runs it around every process call.
+ArielSlotStage *
+ariel_active_plugin_get_slot_stage(ArielActivePlugin *plugin)
+{
+    return plugin ? plugin->slot_stage : NULL;
+}
+
+void
+ariel_active_plugin_set_slot_mix(ArielActivePlugin *plugin, const ArielSlotMix *mix)
+{
+    if (plugin) {
+        ariel_slot_stage_set(plugin->slot_stage, mix);
+    }
+}
+
+void
+ariel_active_plugin_get_slot_mix(ArielActivePlugin *plugin, ArielSlotMix *mix)
+{
+    if (plugin) {
+        ariel_slot_stage_get(plugin->slot_stage, mix);
+    } else {
+        *mix = (ArielSlotMix)ARIEL_SLOT_MIX_UNITY;
+    }
+}
+
+// Level at the slot's output, after its mix stage; lives as long as the plugin
+ArielMeter *
+ariel_active_plugin_get_meter(ArielActivePlugin *plugin)
+{
+    return plugin ? &plugin->meter : NULL;
+}
+
+guint
+ariel_active_plugin_get_n_control_outputs(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), 0);
+    return plugin->n_control_outputs;
+}
+
+uint32_t
+ariel_active_plugin_get_control_output_port_index(ArielActivePlugin *plugin, guint index)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), 0);
+    g_return_val_if_fail(index < plugin->n_control_outputs, 0);
+    return plugin->control_output_port_indices[index];
+}
+
+// Copy the control outputs of the latest cycle into values, which holds
+// n_values floats (any thread). Returns FALSE, leaving values undefined,
+// if the plugin has not run yet or kept publishing while we read.
+gboolean
+ariel_active_plugin_read_control_outputs(ArielActivePlugin *plugin, float *values, guint n_values)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), FALSE);
+    
+    guint n = MIN(n_values, plugin->n_control_outputs);
+    if (n == 0 || !plugin->control_output_snapshot) {
+        return FALSE;
+    }
+    
+    for (guint attempt = 0; attempt < 4; attempt++) {
+        guint serial = (guint)g_atomic_int_get(&plugin->control_output_serial);
+        if (serial == 0) {
+            return FALSE;
+        }
+        
+        memcpy(values, plugin->control_output_snapshot + (serial & 1) * plugin->n_control_outputs,
+               n * sizeof(float));
+        
+        // The copy must be complete before the serial is checked again
+        atomic_thread_fence(memory_order_acquire);
+        if ((guint)g_atomic_int_get(&plugin->control_output_serial) == serial) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+// The buffer the control inputs are connected to. It lives as long as the
+// plugin, so the audio thread may write through it directly.
+float *
+ariel_active_plugin_get_control_inputs(ArielActivePlugin *plugin)
+{
+    return plugin ? plugin->control_input_values : NULL;
+}
+
+// Overwrite the connected control inputs in one go. Runs on the audio
+// thread for scene recall, so it must not allocate, lock or print.
+void
+ariel_active_plugin_apply_controls(ArielActivePlugin *plugin, const float *values, guint n_values, gboolean bypass)
+{
+    if (!plugin) return;
+    
+    if (plugin->control_input_values && n_values > 0) {
+        memcpy(plugin->control_input_values, values,
+               MIN(n_values, plugin->n_control_inputs) * sizeof(float));
+    }
+    plugin->bypass = bypass;
+}
+
 // Preset Management Functions
 gboolean
 ariel_active_plugin_save_preset(ArielActivePlugin *plugin, const char *preset_name, const char *preset_dir)
@@ -726,11 +1231,19 @@ ariel_active_plugin_save_preset(ArielActivePlugin *plugin, const char *preset_na
         g_free(param_key);
     }
     
+    // Internal state (loaded models, IRs, ...) for plugins that expose it
+    ariel_state_save_to_keyfile(plugin, preset_file, "plugin");
+    
     // Save preset file
     gsize length;
     char *preset_data = g_key_file_to_data(preset_file, &length, NULL);
     gboolean success = g_file_set_contents(preset_path, preset_data, length, NULL);
     
+    if (success && plugin->manager) {
+        ariel_preset_index_add(plugin->manager->preset_index, preset_path,
+                               ariel_plugin_info_get_uri(plugin->plugin_info));
+    }
+    
     // Cleanup
     g_free(preset_data);
     g_free(preset_path);
@@ -743,10 +1256,90 @@ ariel_active_plugin_save_preset(ArielActivePlugin *plugin, const char *preset_na
     return success;
 }
 
+// lilv port value callback for LV2 presets
+static void
+ariel_active_plugin_set_port_value(const char *port_symbol, void *user_data, const void *value,
+                                   uint32_t size, uint32_t type)
+{
+    ArielActivePlugin *plugin = user_data;
+    LV2_URID_Map *map = plugin->urid_map;
+    float control;
+    
+    if (type == map->map(map->handle, LV2_ATOM__Float) && size == sizeof(float)) {
+        control = *(const float *)value;
+    } else if (type == map->map(map->handle, LV2_ATOM__Double) && size == sizeof(double)) {
+        control = (float)*(const double *)value;
+    } else if (type == map->map(map->handle, LV2_ATOM__Int) && size == sizeof(int32_t)) {
+        control = (float)*(const int32_t *)value;
+    } else {
+        return;
+    }
+    
+    for (guint i = 0; i < plugin->n_control_inputs; i++) {
+        const LilvPort *port = lilv_plugin_get_port_by_index(plugin->lilv_plugin,
+                                                             plugin->control_input_port_indices[i]);
+        if (g_str_equal(lilv_node_as_string(lilv_port_get_symbol(plugin->lilv_plugin, port)), port_symbol)) {
+            plugin->control_input_values[i] = control;
+            return;
+        }
+    }
+}
+
+// Load a pset:Preset shipped with the plugin
+static gboolean
+ariel_active_plugin_load_lv2_preset(ArielActivePlugin *plugin, const char *preset_uri,
+                                    ArielPluginLoadedFunc callback, gpointer user_data)
+{
+    LilvWorld *world = plugin->manager->world;
+    LilvNode *preset = lilv_new_uri(world, preset_uri);
+    lilv_world_load_resource(world, preset);
+    LilvState *state = lilv_state_new_from_world(world, plugin->urid_map, preset);
+    lilv_node_free(preset);
+    
+    if (!state) {
+        g_warning("Failed to load LV2 preset %s", preset_uri);
+        return FALSE;
+    }
+    
+    const char *label = lilv_state_get_label(state) ? lilv_state_get_label(state) : preset_uri;
+    lilv_state_emit_port_values(state, ariel_active_plugin_set_port_value, plugin);
+    
+    // lilv restores directly, so a running plugin must allow concurrent restore
+    if (lilv_state_get_num_properties(state) > 0 && plugin->instance) {
+        if (!ariel_active_plugin_is_in_chain(plugin) || ariel_active_plugin_has_thread_safe_restore(plugin)) {
+            lilv_state_restore(state, plugin->instance, NULL, NULL, 0,
+                               (const LV2_Feature *const *)plugin->manager->features);
+        } else {
+            g_warning("Plugin %s is running; loaded the controls of preset %s only",
+                      plugin->name, label);
+        }
+    }
+    
+    g_print("Loaded LV2 preset '%s' for plugin %s\n", label, plugin->name);
+    lilv_state_free(state);
+    
+    if (callback) callback(plugin, user_data);
+    return TRUE;
+}
+
+// Load a preset. Controls apply at once; internal state is restored without
+// interrupting audio, possibly into a replacement instance, and callback runs
+// on the main thread with the plugin that ends up holding the preset.
+// preset_path may also be the URI of an LV2 preset, as listed by
+// ariel_active_plugin_list_presets.
 gboolean
-ariel_active_plugin_load_preset(ArielActivePlugin *plugin, const char *preset_path)
+ariel_active_plugin_load_preset(ArielActivePlugin *plugin, const char *preset_path,
+                                ArielPluginLoadedFunc callback, gpointer user_data)
 {
-    if (!plugin || !preset_path || !g_file_test(preset_path, G_FILE_TEST_EXISTS)) {
+    if (!plugin || !preset_path) {
+        return FALSE;
+    }
+    
+    if (!g_path_is_absolute(preset_path) && strchr(preset_path, ':') && plugin->manager) {
+        return ariel_active_plugin_load_lv2_preset(plugin, preset_path, callback, user_data);
+    }
+    
+    if (!g_file_test(preset_path, G_FILE_TEST_EXISTS)) {
         return FALSE;
     }
     
@@ -793,6 +1386,7 @@ ariel_active_plugin_load_preset(ArielActivePlugin *plugin, const char *preset_pa
         g_free(param_key);
     }
     
+    GBytes *state = ariel_state_load_from_keyfile(preset_file, "plugin");
     g_key_file_free(preset_file);
     
     char *preset_name = g_path_get_basename(preset_path);
@@ -802,66 +1396,33 @@ ariel_active_plugin_load_preset(ArielActivePlugin *plugin, const char *preset_pa
     g_print("Loaded preset '%s' for plugin %s\n", preset_name, plugin->name);
     g_free(preset_name);
     
+    // Internal state follows in the background
+    if (state) {
+        ariel_active_plugin_restore_state_async(plugin, state, callback, user_data);
+        g_bytes_unref(state);
+    } else if (callback) {
+        callback(plugin, user_data);
+    }
+    
     return TRUE;
 }
 
-char **
+// Presets for this plugin: user presets in preset_dir, then the plugin's
+// LV2 presets. Returns ArielPresetEntry items; free with g_ptr_array_unref.
+GPtrArray *
 ariel_active_plugin_list_presets(ArielActivePlugin *plugin, const char *preset_dir)
 {
-    if (!plugin || !preset_dir || !g_file_test(preset_dir, G_FILE_TEST_IS_DIR)) {
+    if (!plugin || !plugin->manager) {
         return NULL;
     }
     
-    GDir *dir = g_dir_open(preset_dir, 0, NULL);
-    if (!dir) {
-        return NULL;
+    // Listing goes through the index, so only this plugin's presets are touched
+    if (!plugin->manager->preset_index) {
+        plugin->manager->preset_index = ariel_preset_index_new();
     }
     
-    GPtrArray *preset_list = g_ptr_array_new();
-    const char *filename;
-    
-    // Get plugin URI for filtering
-    const char *plugin_uri = ariel_plugin_info_get_uri(plugin->plugin_info);
-    
-    while ((filename = g_dir_read_name(dir)) != NULL) {
-        if (g_str_has_suffix(filename, ".preset")) {
-            char *preset_path = g_build_filename(preset_dir, filename, NULL);
-            
-            // Check if preset is for this plugin
-            GKeyFile *preset_file = g_key_file_new();
-            if (g_key_file_load_from_file(preset_file, preset_path, G_KEY_FILE_NONE, NULL)) {
-                char *saved_uri = g_key_file_get_string(preset_file, "plugin", "uri", NULL);
-                
-                if (saved_uri && strcmp(saved_uri, plugin_uri) == 0) {
-                    // Remove .preset extension from filename
-                    char *preset_name = g_strndup(filename, strlen(filename) - 7);
-                    g_ptr_array_add(preset_list, preset_name);
-                }
-                
-                g_free(saved_uri);
-            }
-            
-            g_key_file_free(preset_file);
-            g_free(preset_path);
-        }
-    }
-    
-    g_dir_close(dir);
-    
-    // Convert to NULL-terminated string array
-    g_ptr_array_add(preset_list, NULL);
-    return (char **)g_ptr_array_free(preset_list, FALSE);
-}
-
-void
-ariel_active_plugin_free_preset_list(char **preset_list)
-{
-    if (!preset_list) return;
-    
-    for (int i = 0; preset_list[i] != NULL; i++) {
-        g_free(preset_list[i]);
-    }
-    g_free(preset_list);
+    return ariel_preset_index_list(plugin->manager->preset_index, plugin->manager, preset_dir,
+                                   ariel_plugin_info_get_uri(plugin->plugin_info));
 }
 
 // Send file path to plugin via thread-safe UI message queue (jalv-style approach)
@@ -897,8 +1458,10 @@ ariel_active_plugin_set_file_parameter_with_uri(ArielActivePlugin *plugin, const
     // Queue message for processing in audio thread
     g_async_queue_push(plugin->ui_messages, msg);
     
+    // The state no longer matches any saved snapshot
+    ariel_active_plugin_set_state_snapshot(plugin, NULL);
+    
     ariel_log(INFO, "Queued file parameter for plugin %s: %s", plugin->name, file_path);
-    g_print("Neural model will be loaded: %s\n", file_path);
 }
 
 // Send file path to plugin via Atom message (backward compatibility)
@@ -918,6 +1481,101 @@ ariel_active_plugin_set_file_parameter(ArielActivePlugin *plugin, const char *fi
     ariel_active_plugin_set_file_parameter_with_uri(plugin, file_path, model_uri);
 }
 
+// The path of a patch:Set message, or NULL if atom is something else
+static char *
+ariel_active_plugin_parse_patch_set(ArielActivePlugin *plugin, const LV2_Atom *atom, const char **property_uri)
+{
+    if (atom->type != plugin->atom_Object) {
+        return NULL;
+    }
+    
+    const LV2_Atom_Object *object = (const LV2_Atom_Object *)atom;
+    if (object->body.otype != plugin->patch_Set) {
+        return NULL;
+    }
+    
+    const LV2_Atom *property = NULL;
+    const LV2_Atom *value = NULL;
+    lv2_atom_object_get(object, plugin->patch_property, &property, plugin->patch_value, &value, 0);
+    if (!property || property->type != plugin->atom_URID || !value ||
+        (value->type != plugin->atom_Path && value->type != plugin->atom_String)) {
+        return NULL;
+    }
+    
+    *property_uri = ariel_urid_unmap(plugin->manager->urid_map, ((const LV2_Atom_URID *)property)->body);
+    if (!*property_uri) {
+        return NULL;
+    }
+    return g_strndup(LV2_ATOM_BODY_CONST(value), value->size);
+}
+
+// Read what the plugin sent through its Atom outputs since the last call
+// (main thread). Every file it reports loading for a parameter is kept,
+// and passed to func if it differs from the last one; returns how many
+// were new.
+guint
+ariel_active_plugin_dispatch_atom_outputs(ArielActivePlugin *plugin, ArielPatchSetFunc func, gpointer user_data)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), 0);
+    
+    jack_ringbuffer_t *ring = plugin->atom_output_ring;
+    if (!ring || !plugin->manager) {
+        return 0;
+    }
+    
+    guint n_changed = 0;
+    ArielAtomOutputHeader header;
+    while (jack_ringbuffer_peek(ring, (char *)&header, sizeof(header)) == sizeof(header)) {
+        // The sequence may still be on its way
+        if (jack_ringbuffer_read_space(ring) < sizeof(header) + header.size) {
+            break;
+        }
+        jack_ringbuffer_read_advance(ring, sizeof(header));
+        
+        LV2_Atom_Sequence *seq = g_malloc(header.size);
+        jack_ringbuffer_read(ring, (char *)seq, header.size);
+        
+        LV2_ATOM_SEQUENCE_FOREACH(seq, event) {
+            const char *property_uri = NULL;
+            char *path = ariel_active_plugin_parse_patch_set(plugin, &event->body, &property_uri);
+            if (!path) {
+                continue;
+            }
+            
+            if (g_strcmp0(g_hash_table_lookup(plugin->reported_files, property_uri), path) == 0) {
+                g_free(path);
+                continue;
+            }
+            
+            g_hash_table_replace(plugin->reported_files, g_strdup(property_uri), path);
+            n_changed++;
+            if (func) {
+                func(plugin, property_uri, path, user_data);
+            }
+        }
+        
+        g_free(seq);
+    }
+    
+    return n_changed;
+}
+
+// The file the plugin last reported for a parameter, or NULL (main thread)
+const char *
+ariel_active_plugin_get_reported_file(ArielActivePlugin *plugin, const char *property_uri)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), NULL);
+    return g_hash_table_lookup(plugin->reported_files, property_uri);
+}
+
+// Whether the plugin can tell the host what it loaded
+gboolean
+ariel_active_plugin_has_atom_outputs(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), FALSE);
+    return plugin->atom_output_ring != NULL;
+}
+
 // Check if plugin supports file parameters via Atom messaging
 gboolean
 ariel_active_plugin_supports_file_parameters(ArielActivePlugin *plugin)
@@ -1024,89 +1682,120 @@ ariel_active_plugin_process_worker_responses(ArielActivePlugin *plugin)
     g_mutex_unlock(&worker->response_mutex);
 }
 
-// Process UI messages in audio thread (jalv-style communication)
+// Write the transport position as a time:Position object at frame 0
+static void
+ariel_active_plugin_forge_position(ArielActivePlugin *plugin, LV2_Atom_Forge *forge,
+                                   const ArielTimePosition *position)
+{
+    LV2_Atom_Forge_Frame frame;
+    if (!lv2_atom_forge_frame_time(forge, 0) ||
+        !lv2_atom_forge_object(forge, &frame, 0, plugin->time_Position)) {
+        return;
+    }
+    
+    lv2_atom_forge_key(forge, plugin->time_frame);
+    lv2_atom_forge_long(forge, position->frame);
+    lv2_atom_forge_key(forge, plugin->time_speed);
+    lv2_atom_forge_float(forge, position->rolling ? 1.0f : 0.0f);
+    
+    if (position->has_bbt) {
+        lv2_atom_forge_key(forge, plugin->time_barBeat);
+        lv2_atom_forge_float(forge, position->bar_beat);
+        lv2_atom_forge_key(forge, plugin->time_bar);
+        lv2_atom_forge_long(forge, position->bar);
+        lv2_atom_forge_key(forge, plugin->time_beatUnit);
+        lv2_atom_forge_int(forge, position->beat_unit);
+        lv2_atom_forge_key(forge, plugin->time_beatsPerBar);
+        lv2_atom_forge_float(forge, position->beats_per_bar);
+        lv2_atom_forge_key(forge, plugin->time_beatsPerMinute);
+        lv2_atom_forge_float(forge, position->beats_per_minute);
+    }
+    
+    lv2_atom_forge_pop(forge, &frame);
+}
+
+// Build this cycle's atom input sequences (audio thread). UI messages go
+// to the first atom input at frame 0, the transport position to the
+// plugin's time:Position input at frame 0 when it changed, and engine MIDI
+// to the plugin's MIDI input at its frame offsets. Events landing on one
+// port share its sequence in that order. Inputs left untouched stay
+// empty, so a cycle with nothing to send costs a few checks, and plugins
+// that don't take time:Position never look at the transport.
 void
-ariel_active_plugin_process_ui_messages(ArielActivePlugin *plugin)
+ariel_active_plugin_fill_atom_inputs(ArielActivePlugin *plugin)
 {
-    if (!plugin || !plugin->ui_messages || plugin->n_atom_inputs == 0) {
+    if (!plugin || plugin->n_atom_inputs == 0 || !plugin->atom_input_buffers || !plugin->urid_map) {
         return;
     }
     
-    ArielUIMessage *msg;
+    ArielAudioEngine *engine = plugin->engine;
+    ArielUIMessage *msg = plugin->ui_messages ? g_async_queue_try_pop(plugin->ui_messages) : NULL;
+    guint n_midi = plugin->midi_input >= 0 && engine ? engine->n_midi_events : 0;
+    gboolean send_position = plugin->time_input >= 0 && engine &&
+                             plugin->time_serial != engine->position_serial;
     
-    // Process all queued UI messages
-    while ((msg = g_async_queue_try_pop(plugin->ui_messages)) != NULL) {
-        // Create patch:Set message in Atom input buffer
-        if (plugin->atom_input_buffers && plugin->atom_input_buffers[0]) {
-            LV2_Atom_Sequence *seq = (LV2_Atom_Sequence*)plugin->atom_input_buffers[0];
-            
-            // Reset sequence
-            seq->atom.type = plugin->atom_Sequence;
-            seq->atom.size = sizeof(LV2_Atom_Sequence_Body);
-            seq->body.unit = 0;
-            seq->body.pad = 0;
-            
-            // Create Atom forge for message
-            LV2_Atom_Forge forge;
-            lv2_atom_forge_init(&forge, plugin->urid_map);
-            
-            uint8_t *buffer = (uint8_t*)seq + sizeof(LV2_Atom_Sequence);
-            size_t buffer_size = plugin->atom_buffer_size - sizeof(LV2_Atom_Sequence);
-            lv2_atom_forge_set_buffer(&forge, buffer, buffer_size);
-            
-            // Build patch:Set message exactly like NAM plugin expects
-            LV2_Atom_Forge_Frame frame;
-            if (lv2_atom_forge_sequence_head(&forge, &frame, 0)) {
-                // Create event with frame time 0
-                lv2_atom_forge_frame_time(&forge, 0);
-                
-                LV2_Atom_Forge_Frame object_frame;
-                if (lv2_atom_forge_object(&forge, &object_frame, 0, plugin->patch_Set)) {
-                    // Add patch:property key with the parameter URID as value
-                    lv2_atom_forge_key(&forge, plugin->patch_property);
-                    lv2_atom_forge_urid(&forge, msg->property);
-                    
-                    // Add patch:value key with the file path as atom:Path
-                    lv2_atom_forge_key(&forge, plugin->patch_value);
-                    lv2_atom_forge_path(&forge, msg->data, msg->size);
-                    
-                    lv2_atom_forge_pop(&forge, &object_frame);
-                }
-                lv2_atom_forge_pop(&forge, &frame);
-                
-                // Update sequence size
-                seq->atom.size = sizeof(LV2_Atom_Sequence_Body) + forge.offset;
-                
-                // Mark that we sent a message, will clear after a few cycles
-                plugin->atom_message_cycles = 3; // Clear after 3 processing cycles
-                
-                ariel_log(INFO, "Processed UI message for plugin %s: property=%u, type=%u, size=%u",
-                          plugin->name, msg->property, msg->type, msg->size);
+    if (!msg && n_midi == 0 && !send_position && !plugin->atom_inputs_dirty) {
+        return;
+    }
+    
+    // Last cycle's events must not be seen twice
+    for (guint i = 0; i < plugin->n_atom_inputs; i++) {
+        LV2_Atom_Sequence *seq = (LV2_Atom_Sequence*)plugin->atom_input_buffers[i];
+        seq->atom.type = plugin->atom_Sequence;
+        seq->atom.size = sizeof(LV2_Atom_Sequence_Body);
+        seq->body.unit = 0;
+        seq->body.pad = 0;
+    }
+    plugin->atom_inputs_dirty = FALSE;
+    
+    LV2_Atom_Forge *forge = &plugin->forge;
+    
+    for (guint i = 0; i < plugin->n_atom_inputs; i++) {
+        gboolean ui_here = msg && i == 0;
+        gboolean position_here = send_position && (gint)i == plugin->time_input;
+        gboolean midi_here = n_midi > 0 && (gint)i == plugin->midi_input;
+        
+        if (!ui_here && !position_here && !midi_here) {
+            continue;
+        }
+        
+        LV2_Atom_Forge_Frame frame;
+        lv2_atom_forge_set_buffer(forge, plugin->atom_input_buffers[i], plugin->atom_buffer_size);
+        lv2_atom_forge_sequence_head(forge, &frame, 0);
+        
+        for (; ui_here && msg; msg = g_async_queue_try_pop(plugin->ui_messages)) {
+            // patch:Set with an atom:Path value, as NAM and similar plugins expect
+            LV2_Atom_Forge_Frame object_frame;
+            if (lv2_atom_forge_frame_time(forge, 0) &&
+                lv2_atom_forge_object(forge, &object_frame, 0, plugin->patch_Set)) {
+                lv2_atom_forge_key(forge, plugin->patch_property);
+                lv2_atom_forge_urid(forge, msg->property);
+                lv2_atom_forge_key(forge, plugin->patch_value);
+                lv2_atom_forge_path(forge, msg->data, msg->size);
+                lv2_atom_forge_pop(forge, &object_frame);
             }
+            g_free(msg);
         }
         
-        g_free(msg);
-    }
-    
-    // Handle clearing of atom input buffer after plugin has processed the message
-    if (plugin->atom_message_cycles > 0) {
-        plugin->atom_message_cycles--;
+        if (position_here) {
+            ariel_active_plugin_forge_position(plugin, forge, &engine->position);
+            plugin->time_serial = engine->position_serial;
+        }
         
-        // After the delay period, clear the buffer to prevent repeated processing
-        if (plugin->atom_message_cycles == 0 && 
-            plugin->atom_input_buffers && 
-            plugin->atom_input_buffers[0]) {
-            
-            LV2_Atom_Sequence *seq = (LV2_Atom_Sequence*)plugin->atom_input_buffers[0];
-            
-            // Reset to empty sequence
-            seq->atom.type = plugin->atom_Sequence;
-            seq->atom.size = sizeof(LV2_Atom_Sequence_Body);
-            seq->body.unit = 0;
-            seq->body.pad = 0;
-            
-            ariel_log(INFO, "Cleared atom input buffer for plugin %s after processing delay", plugin->name);
+        if (midi_here) {
+            const ArielMidiEvent *events = engine->midi_events;
+            for (guint j = 0; j < n_midi; j++) {
+                // A full buffer drops the rest of this cycle's events
+                if (!lv2_atom_forge_frame_time(forge, events[j].time) ||
+                    !lv2_atom_forge_atom(forge, events[j].size, plugin->midi_MidiEvent) ||
+                    !lv2_atom_forge_write(forge, events[j].data, events[j].size)) {
+                    break;
+                }
+            }
         }
+        
+        lv2_atom_forge_pop(forge, &frame);
+        plugin->atom_inputs_dirty = TRUE;
     }
 }
 
@@ -1124,6 +1813,86 @@ ariel_active_plugin_get_plugin_info(ArielActivePlugin *plugin)
     return plugin->plugin_info;
 }
 
+// Restore every control input to its default value
+void
+ariel_active_plugin_reset_parameters(ArielActivePlugin *plugin)
+{
+    g_return_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin));
+    
+    if (plugin->control_default_values) {
+        memcpy(plugin->control_input_values, plugin->control_default_values,
+               plugin->n_control_inputs * sizeof(float));
+    }
+}
+
+// Hash of the control input values and of the LV2 state snapshot the
+// instance was last saved to or restored from, used to match pooled
+// instances. The plugin's state is not saved again here: that would hash
+// and store every file it references on each release.
+guint
+ariel_active_plugin_get_state_hash(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), 0);
+    
+    return ariel_plugin_state_hash(plugin->control_input_values, plugin->n_control_inputs) ^
+           (guint)g_atomic_int_get(&plugin->state_snapshot_hash);
+}
+
+// Remember the snapshot the instance's state now matches, or forget it
+// with NULL once the state changed some other way (any thread)
+void
+ariel_active_plugin_set_state_snapshot(ArielActivePlugin *plugin, GBytes *snapshot)
+{
+    g_return_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin));
+    g_atomic_int_set(&plugin->state_snapshot_hash, snapshot ? (gint)g_bytes_hash(snapshot) : 0);
+}
+
+// FNV-1a over the raw values, so equal parameter sets hash equally
+guint
+ariel_plugin_state_hash(const float *values, guint n_values)
+{
+    guint32 hash = 2166136261u;
+    const guint8 *bytes = (const guint8 *)values;
+    
+    for (gsize i = 0; values && i < n_values * sizeof(float); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+gsize
+ariel_active_plugin_get_memory_cost(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), 0);
+    return plugin->memory_cost;
+}
+
+// Chain snapshots count their plugins, so the main thread knows when the
+// audio thread can no longer be running one
+void
+ariel_active_plugin_ref_chain(ArielActivePlugin *plugin)
+{
+    // Not run since it last left a chain, so it needs the position again
+    if (plugin->chain_refs++ == 0) {
+        plugin->time_serial = 0;
+    }
+}
+
+void
+ariel_active_plugin_unref_chain(ArielActivePlugin *plugin)
+{
+    g_return_if_fail(plugin->chain_refs > 0);
+    plugin->chain_refs--;
+}
+
+gboolean
+ariel_active_plugin_is_in_chain(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), FALSE);
+    return plugin->chain_refs > 0;
+}
+
 void
 ariel_active_plugin_set_active(ArielActivePlugin *plugin, gboolean active)
 {
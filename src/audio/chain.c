@@ -0,0 +1,744 @@
+#include "ariel.h"
+#include <math.h>
+#include <string.h>
+
+// Real-time plugin chain.
+//
+// The audio thread never touches active_plugin_store. Whenever the store
+// changes, the main thread builds an immutable ArielProcessChain snapshot
+// and sends it through a lock-free command ring. The audio thread picks it
+// up at the start of its next cycle and hands the previous snapshot back
+// through the reclaim ring, so plugins are only unreferenced (and possibly
+// finalized) on a non-RT thread.
+//
+// A swap may ask for a crossfade. The outgoing chain then keeps running on
+// a copy of the input next to the new one, with an equal-power fade
+// between them, and is retired once the fade is over. A plugin cannot run
+// in both chains, so when the new chain keeps the other plugins and only
+// replaces some in place, as a state restore does, the fade happens per
+// slot instead: the outgoing instance runs on a copy of that slot's input
+// and the two outputs are faded there.
+//
+// Scene recalls travel the same way: the audio thread copies every value
+// of the compiled scene at one cycle boundary, then hands the scene back
+// through the reclaim ring to be freed. A scene morph is installed the
+// same way and then runs at the start of every cycle.
+//
+// MIDI arrives from the backend at the start of each cycle and is kept
+// for the chain's plugins to read. A Program Change also recalls the scene
+// with that number, from the main thread's next garbage collection pass.
+// Control Changes go through the MIDI map table (see midi_map.c) right
+// here on the audio thread.
+//
+// The same pass reads what plugins sent back through their Atom outputs
+// (see active_plugin.c) and tells the UI which files they loaded.
+//
+// The transport position is taken once per cycle too; plugins that follow
+// it are sent time:Position only when it changed.
+
+#define ARIEL_COMMAND_RING_SIZE  (64 * sizeof(ArielEngineCommand))
+#define ARIEL_RECLAIM_RING_SIZE  (64 * sizeof(ArielEngineCommand))
+#define ARIEL_RECLAIM_INTERVAL   100  // ms between garbage collection passes
+#define ARIEL_FADE_MAX_FRAMES    8192 // Longer periods swap without a fade
+#define ARIEL_CROSSFADE_SEGMENT  64   // Most frames per straight piece of the fade curve
+#define ARIEL_CROSSFADE_PIECES   32   // Fewest straight pieces per fade
+
+// Scratch input for the outgoing chain, or the outgoing plugin of a slot,
+// during a crossfade (audio thread only)
+static float fade_buffer_L[ARIEL_FADE_MAX_FRAMES];
+static float fade_buffer_R[ARIEL_FADE_MAX_FRAMES];
+
+// Dry copy of a slot's input while its mix stage blends (audio thread only)
+static float slot_dry_L[ARIEL_FADE_MAX_FRAMES];
+static float slot_dry_R[ARIEL_FADE_MAX_FRAMES];
+
+ArielProcessChain *
+ariel_process_chain_new(GListModel *plugins)
+{
+    ArielProcessChain *chain = g_malloc0(sizeof(ArielProcessChain));
+    guint n_items = plugins ? g_list_model_get_n_items(plugins) : 0;
+
+    chain->plugins = g_new0(ArielActivePlugin *, MAX(n_items, 1));
+    for (guint i = 0; i < n_items; i++) {
+        ArielActivePlugin *plugin = g_list_model_get_item(plugins, i);
+        if (plugin) {
+            // The chain keeps the reference taken by get_item
+            chain->plugins[chain->n_plugins++] = plugin;
+            ariel_active_plugin_ref_chain(plugin);
+        }
+    }
+
+    return chain;
+}
+
+void
+ariel_process_chain_free(ArielProcessChain *chain)
+{
+    if (!chain) return;
+
+    for (guint i = 0; i < chain->n_plugins; i++) {
+        ariel_active_plugin_unref_chain(chain->plugins[i]);
+        g_object_unref(chain->plugins[i]);
+    }
+    g_free(chain->plugins);
+    g_free(chain);
+}
+
+// Release whatever a consumed or undeliverable command still owns
+static void
+ariel_engine_command_release(ArielEngineCommand *command)
+{
+    switch (command->type) {
+    case ARIEL_ENGINE_COMMAND_SET_CHAIN:
+        ariel_process_chain_free(command->chain);
+        break;
+    case ARIEL_ENGINE_COMMAND_RECALL_SCENE:
+        ariel_scene_recall_free(command->scene);
+        break;
+    case ARIEL_ENGINE_COMMAND_SET_MORPH:
+        ariel_scene_morph_free(command->morph);
+        break;
+    case ARIEL_ENGINE_COMMAND_SET_MIDI_MAP:
+        ariel_midi_map_free(command->midi_map);
+        break;
+    case ARIEL_ENGINE_COMMAND_SET_RECORDER:
+        ariel_recorder_free(command->recorder);
+        break;
+    case ARIEL_ENGINE_COMMAND_SET_PLAYER:
+        ariel_file_player_free(command->player);
+        break;
+    }
+}
+
+void
+ariel_audio_engine_init_chain(ArielAudioEngine *engine)
+{
+    engine->chain = ariel_process_chain_new(NULL);
+    engine->crossfade_ms = ARIEL_DEFAULT_CROSSFADE_MS;
+    engine->midi_program = -1;
+    engine->position_serial = 1;
+    engine->command_ring = jack_ringbuffer_create(ARIEL_COMMAND_RING_SIZE);
+    engine->reclaim_ring = jack_ringbuffer_create(ARIEL_RECLAIM_RING_SIZE);
+    jack_ringbuffer_mlock(engine->command_ring);
+    jack_ringbuffer_mlock(engine->reclaim_ring);
+
+    engine->reclaim_source = g_timeout_add(ARIEL_RECLAIM_INTERVAL,
+                                           ariel_audio_engine_collect_garbage_cb, engine);
+}
+
+void
+ariel_audio_engine_free_chain(ArielAudioEngine *engine)
+{
+    if (engine->reclaim_source) {
+        g_source_remove(engine->reclaim_source);
+        engine->reclaim_source = 0;
+    }
+
+    // The audio thread is gone, so pending commands can be dropped here
+    if (engine->command_ring) {
+        ArielEngineCommand command;
+        while (jack_ringbuffer_read(engine->command_ring, (char *)&command, sizeof(command)) == sizeof(command)) {
+            ariel_engine_command_release(&command);
+        }
+        jack_ringbuffer_free(engine->command_ring);
+        engine->command_ring = NULL;
+    }
+
+    ariel_audio_engine_collect_garbage(engine);
+    if (engine->reclaim_ring) {
+        jack_ringbuffer_free(engine->reclaim_ring);
+        engine->reclaim_ring = NULL;
+    }
+
+    ariel_process_chain_free(engine->fade_chain);
+    engine->fade_chain = NULL;
+    ariel_process_chain_free(engine->chain);
+    engine->chain = NULL;
+    ariel_scene_morph_free(engine->morph);
+    engine->morph = NULL;
+    g_clear_pointer(&engine->morph_plugins, g_ptr_array_unref);
+    ariel_midi_map_free(engine->midi_map);
+    engine->midi_map = NULL;
+    ariel_recorder_free(engine->recorder);
+    engine->recorder = NULL;
+    ariel_file_player_free(engine->player);
+    engine->player = NULL;
+}
+
+// Hand a chain the audio thread no longer uses back to the main thread.
+// Callers make sure the reclaim ring has room.
+static void
+ariel_audio_engine_retire_chain(ArielAudioEngine *engine, ArielProcessChain *chain)
+{
+    ArielEngineCommand retired = {
+        .type = ARIEL_ENGINE_COMMAND_SET_CHAIN,
+        .chain = chain,
+    };
+    jack_ringbuffer_write(engine->reclaim_ring, (const char *)&retired, sizeof(retired));
+}
+
+// Running a plugin in both chains would process it twice per cycle
+static gboolean
+ariel_process_chain_shares_plugins(ArielProcessChain *a, ArielProcessChain *b)
+{
+    for (guint i = 0; i < a->n_plugins; i++) {
+        for (guint j = 0; j < b->n_plugins; j++) {
+            if (a->plugins[i] == b->plugins[j]) {
+                return TRUE;
+            }
+        }
+    }
+    return FALSE;
+}
+
+// Whether to only differs from from by plugins replaced in place, none of
+// them moving to another slot, so each changed slot can fade on its own
+static gboolean
+ariel_process_chain_replaces_slots(ArielProcessChain *from, ArielProcessChain *to)
+{
+    gboolean replaced = FALSE;
+
+    if (from->n_plugins != to->n_plugins) {
+        return FALSE;
+    }
+
+    for (guint i = 0; i < to->n_plugins; i++) {
+        if (from->plugins[i] == to->plugins[i]) {
+            continue;
+        }
+        for (guint j = 0; j < to->n_plugins; j++) {
+            if (from->plugins[i] == to->plugins[j] || to->plugins[i] == from->plugins[j]) {
+                return FALSE;
+            }
+        }
+        replaced = TRUE;
+    }
+    return replaced;
+}
+
+// Apply one command; runs on the audio thread, or on the caller while the
+// audio thread is stopped
+static void
+ariel_audio_engine_apply_command(ArielAudioEngine *engine, ArielEngineCommand *command)
+{
+    switch (command->type) {
+    case ARIEL_ENGINE_COMMAND_SET_CHAIN:
+        // A fade still in progress is cut short
+        if (engine->fade_chain) {
+            ariel_audio_engine_retire_chain(engine, engine->fade_chain);
+            engine->fade_chain = NULL;
+        }
+
+        if (command->fade_frames > 0 &&
+            !ariel_process_chain_shares_plugins(engine->chain, command->chain)) {
+            engine->fade_chain = engine->chain;
+            engine->fade_slots = FALSE;
+            engine->fade_position = 0;
+            engine->fade_length = command->fade_frames;
+        } else if (command->fade_frames > 0 &&
+                   ariel_process_chain_replaces_slots(engine->chain, command->chain)) {
+            engine->fade_chain = engine->chain;
+            engine->fade_slots = TRUE;
+            engine->fade_position = 0;
+            engine->fade_length = command->fade_frames;
+        } else {
+            ariel_audio_engine_retire_chain(engine, engine->chain);
+        }
+        engine->chain = command->chain;
+        break;
+    case ARIEL_ENGINE_COMMAND_RECALL_SCENE: {
+        ArielSceneRecall *scene = command->scene;
+        for (guint i = 0; i < scene->n_plugins; i++) {
+            ariel_active_plugin_apply_controls(scene->plugins[i],
+                                               scene->values + scene->offsets[i],
+                                               scene->counts[i], scene->bypass[i]);
+        }
+        jack_ringbuffer_write(engine->reclaim_ring, (const char *)command, sizeof(*command));
+        break;
+    }
+    case ARIEL_ENGINE_COMMAND_SET_MORPH:
+        if (engine->morph) {
+            ArielEngineCommand retired = {
+                .type = ARIEL_ENGINE_COMMAND_SET_MORPH,
+                .morph = engine->morph,
+            };
+            jack_ringbuffer_write(engine->reclaim_ring, (const char *)&retired, sizeof(retired));
+        }
+        engine->morph = command->morph;
+        break;
+    case ARIEL_ENGINE_COMMAND_SET_MIDI_MAP:
+        if (engine->midi_map) {
+            ArielEngineCommand retired = {
+                .type = ARIEL_ENGINE_COMMAND_SET_MIDI_MAP,
+                .midi_map = engine->midi_map,
+            };
+            jack_ringbuffer_write(engine->reclaim_ring, (const char *)&retired, sizeof(retired));
+        }
+        engine->midi_map = command->midi_map;
+        break;
+    case ARIEL_ENGINE_COMMAND_SET_RECORDER:
+        if (engine->recorder) {
+            // Finishing the files is left to the main thread
+            ArielEngineCommand retired = {
+                .type = ARIEL_ENGINE_COMMAND_SET_RECORDER,
+                .recorder = engine->recorder,
+            };
+            jack_ringbuffer_write(engine->reclaim_ring, (const char *)&retired, sizeof(retired));
+        }
+        engine->recorder = command->recorder;
+        break;
+    case ARIEL_ENGINE_COMMAND_SET_PLAYER:
+        if (engine->player) {
+            ArielEngineCommand retired = {
+                .type = ARIEL_ENGINE_COMMAND_SET_PLAYER,
+                .player = engine->player,
+            };
+            jack_ringbuffer_write(engine->reclaim_ring, (const char *)&retired, sizeof(retired));
+        }
+        engine->player = command->player;
+        break;
+    }
+}
+
+// Drain pending commands at a cycle boundary (audio thread)
+void
+ariel_audio_engine_process_commands(ArielAudioEngine *engine)
+{
+    if (!engine->command_ring) return;
+
+    ArielEngineCommand command;
+
+    // Only take a command if its leftovers (at most the current chain and
+    // one still fading out) can be handed back; otherwise leave it queued
+    // for the next cycle rather than free it here
+    while (jack_ringbuffer_read_space(engine->command_ring) >= sizeof(command) &&
+           jack_ringbuffer_write_space(engine->reclaim_ring) >= 2 * sizeof(command)) {
+        jack_ringbuffer_read(engine->command_ring, (char *)&command, sizeof(command));
+        ariel_audio_engine_apply_command(engine, &command);
+    }
+}
+
+// Queue a command for the audio thread. Must be called from the main thread,
+// which is the ring's only writer. Ownership of the payload moves to the
+// engine, even on failure.
+gboolean
+ariel_audio_engine_send_command(ArielAudioEngine *engine, const ArielEngineCommand *command)
+{
+    ArielEngineCommand copy = *command;
+
+    if (!engine->active) {
+        // No audio thread: apply queued commands in order, then this one
+        ariel_audio_engine_collect_garbage(engine);
+        ariel_audio_engine_process_commands(engine);
+        ariel_audio_engine_collect_garbage(engine);
+        ariel_audio_engine_apply_command(engine, &copy);
+        ariel_audio_engine_collect_garbage(engine);
+        return TRUE;
+    }
+
+    if (jack_ringbuffer_write_space(engine->command_ring) < sizeof(copy)) {
+        ARIEL_WARN("Engine command ring full, dropping command %d", copy.type);
+        ariel_engine_command_release(&copy);
+        return FALSE;
+    }
+
+    jack_ringbuffer_write(engine->command_ring, (const char *)&copy, sizeof(copy));
+    return TRUE;
+}
+
+// Free everything the audio thread has handed back (main thread)
+void
+ariel_audio_engine_collect_garbage(ArielAudioEngine *engine)
+{
+    if (!engine || !engine->reclaim_ring) return;
+
+    ArielEngineCommand retired;
+    while (jack_ringbuffer_read(engine->reclaim_ring, (char *)&retired, sizeof(retired)) == sizeof(retired)) {
+        ariel_engine_command_release(&retired);
+    }
+}
+
+// Recall the scene picked by the last MIDI Program Change (main thread)
+static void
+ariel_audio_engine_dispatch_midi(ArielAudioEngine *engine)
+{
+    gint program = g_atomic_int_get(&engine->midi_program);
+    if (program < 0 || !g_atomic_int_compare_and_exchange(&engine->midi_program, program, -1)) {
+        return;
+    }
+
+    ArielPluginManager *manager = engine->plugin_manager;
+    if (manager && manager->scenes && (guint)program < ariel_scene_bank_get_n_scenes(manager->scenes)) {
+        ariel_scene_bank_recall(manager->scenes, manager, engine, (guint)program);
+    }
+}
+
+// Take this cycle's transport position (audio thread). Plugins are only
+// sent a new time:Position when it differs from where the last one leads:
+// the transport started, stopped or jumped, or the tempo or meter changed.
+void
+ariel_audio_engine_update_position(ArielAudioEngine *engine, const ArielTimePosition *position,
+                                   jack_nframes_t nframes)
+{
+    const ArielTimePosition *last = &engine->position;
+    gboolean changed = position->rolling != last->rolling ||
+                       position->has_bbt != last->has_bbt ||
+                       position->frame != engine->position_next_frame ||
+                       position->beats_per_minute != last->beats_per_minute ||
+                       position->beats_per_bar != last->beats_per_bar ||
+                       position->beat_unit != last->beat_unit;
+
+    engine->position = *position;
+    engine->position_next_frame = position->frame + (position->rolling ? nframes : 0);
+    if (changed) {
+        engine->position_serial++;
+    }
+}
+
+// Learned controllers and moved controls, coalesced per pass (main thread)
+static void
+ariel_audio_engine_dispatch_midi_map(ArielAudioEngine *engine)
+{
+    if (engine->plugin_manager) {
+        ariel_midi_mapper_dispatch(engine->plugin_manager->midi_mapper, engine);
+    }
+}
+
+// Files the chain's plugins reported loading since the last pass (main thread)
+static void
+ariel_audio_engine_dispatch_plugin_reports(ArielAudioEngine *engine)
+{
+    ArielPluginManager *manager = engine->plugin_manager;
+    if (!manager || !manager->active_plugin_store) return;
+
+    GListModel *model = G_LIST_MODEL(manager->active_plugin_store);
+    guint n_plugins = g_list_model_get_n_items(model);
+    for (guint i = 0; i < n_plugins; i++) {
+        ArielActivePlugin *plugin = g_list_model_get_item(model, i);
+        ariel_active_plugin_dispatch_atom_outputs(plugin, engine->patch_set_func, engine->patch_set_data);
+        g_object_unref(plugin);
+    }
+}
+
+// Called on the main thread whenever a plugin reports a new file for one
+// of its parameters
+void
+ariel_audio_engine_set_patch_set_func(ArielAudioEngine *engine, ArielPatchSetFunc func, gpointer user_data)
+{
+    g_return_if_fail(engine != NULL);
+
+    engine->patch_set_func = func;
+    engine->patch_set_data = user_data;
+}
+
+gboolean
+ariel_audio_engine_collect_garbage_cb(gpointer user_data)
+{
+    ariel_audio_engine_collect_garbage((ArielAudioEngine *)user_data);
+    ariel_audio_engine_dispatch_midi((ArielAudioEngine *)user_data);
+    ariel_audio_engine_dispatch_midi_map((ArielAudioEngine *)user_data);
+    ariel_audio_engine_dispatch_plugin_reports((ArielAudioEngine *)user_data);
+    return G_SOURCE_CONTINUE;
+}
+
+// Queue one incoming MIDI event for this cycle's plugins (audio thread).
+// Backends reset n_midi_events at the start of each cycle.
+void
+ariel_audio_engine_receive_midi(ArielAudioEngine *engine, const ArielMidiEvent *event)
+{
+    if (engine->n_midi_events >= ARIEL_MIDI_MAX_EVENTS) {
+        return;
+    }
+    engine->midi_events[engine->n_midi_events++] = *event;
+
+    if (event->size >= 2 && (event->data[0] & 0xF0) == 0xC0) {
+        g_atomic_int_set(&engine->midi_program, event->data[1]);
+    } else if (event->size >= 3 && (event->data[0] & 0xF0) == 0xB0) {
+        guint8 channel = event->data[0] & 0x0F;
+        guint8 cc = event->data[1] & 0x7F;
+
+        // While learning, the first controller is reported instead of applied
+        if (g_atomic_int_get(&engine->midi_learn) &&
+            g_atomic_int_compare_and_exchange(&engine->midi_learn, 1, 0)) {
+            g_atomic_int_set(&engine->midi_learned, ((channel << 8) | cc) + 1);
+        } else if (engine->midi_map && ariel_midi_map_apply(engine->midi_map, channel, cc, event->data[2])) {
+            g_atomic_int_set(&engine->midi_values_changed, 1);
+        }
+    }
+}
+
+static gboolean
+ariel_audio_engine_retry_sync(gpointer user_data)
+{
+    ArielAudioEngine *engine = user_data;
+    engine->sync_retry_source = 0;
+    ariel_audio_engine_sync_chain(engine);
+    return G_SOURCE_REMOVE;
+}
+
+// Publish the current contents of active_plugin_store to the audio thread
+void
+ariel_audio_engine_sync_chain(ArielAudioEngine *engine)
+{
+    if (!engine || !engine->plugin_manager || !engine->command_ring) return;
+
+    ariel_audio_engine_collect_garbage(engine);
+
+    // A morph only makes sense against the chain it was compiled for; stop
+    // it before it writes into plugins that are leaving
+    if (engine->morph_plugins) {
+        GListStore *store = engine->plugin_manager->active_plugin_store;
+        for (guint i = 0; i < engine->morph_plugins->len; i++) {
+            if (!g_list_store_find(store, g_ptr_array_index(engine->morph_plugins, i), NULL)) {
+                ariel_audio_engine_stop_morph(engine);
+                break;
+            }
+        }
+    }
+
+    ArielEngineCommand command = {
+        .type = ARIEL_ENGINE_COMMAND_SET_CHAIN,
+        .chain = ariel_process_chain_new(G_LIST_MODEL(engine->plugin_manager->active_plugin_store)),
+    };
+
+    if (engine->crossfade_next && engine->active) {
+        command.fade_frames = (guint)(engine->crossfade_ms * engine->sample_rate / 1000.0f);
+    }
+    engine->crossfade_next = FALSE;
+
+    // Mappings follow their plugins in and out of the chain
+    ariel_midi_mapper_publish(engine->plugin_manager->midi_mapper, engine);
+
+    // Each snapshot is complete, so a later retry replaces a dropped one
+    if (!ariel_audio_engine_send_command(engine, &command) && !engine->sync_retry_source) {
+        engine->sync_retry_source = g_timeout_add(10, ariel_audio_engine_retry_sync, engine);
+    }
+}
+
+// Move the armed scene morph, 0 being its first scene and 1 its second.
+// Safe from any thread; the audio thread follows at its next cycle.
+void
+ariel_audio_engine_set_morph_position(ArielAudioEngine *engine, float position)
+{
+    if (!engine) return;
+
+    position = CLAMP(position, 0.0f, 1.0f);
+    g_atomic_int_set(&engine->morph_position, (gint)lroundf(position * ARIEL_MORPH_RESOLUTION));
+}
+
+float
+ariel_audio_engine_get_morph_position(ArielAudioEngine *engine)
+{
+    if (!engine) return 0.0f;
+    return (float)g_atomic_int_get(&engine->morph_position) / ARIEL_MORPH_RESOLUTION;
+}
+
+// Hand a compiled morph to the audio thread, replacing any armed one, or
+// disarm it with NULL. Ownership of morph moves to the engine, even on
+// failure.
+gboolean
+ariel_audio_engine_set_morph(ArielAudioEngine *engine, ArielSceneMorph *morph)
+{
+    if (!engine || !engine->command_ring) {
+        ariel_scene_morph_free(morph);
+        return FALSE;
+    }
+
+    // Remember what it drives, so chain changes can disarm it
+    GPtrArray *plugins = NULL;
+    if (morph) {
+        plugins = g_ptr_array_new_full(morph->n_plugins, g_object_unref);
+        for (guint i = 0; i < morph->n_plugins; i++) {
+            g_ptr_array_add(plugins, g_object_ref(morph->plugins[i]));
+        }
+    }
+
+    ArielEngineCommand command = {
+        .type = ARIEL_ENGINE_COMMAND_SET_MORPH,
+        .morph = morph,
+    };
+    if (!ariel_audio_engine_send_command(engine, &command)) {
+        g_clear_pointer(&plugins, g_ptr_array_unref);
+        return FALSE;
+    }
+
+    g_clear_pointer(&engine->morph_plugins, g_ptr_array_unref);
+    engine->morph_plugins = plugins;
+    return TRUE;
+}
+
+// Disarm the morph; controls keep the values it last set
+void
+ariel_audio_engine_stop_morph(ArielAudioEngine *engine)
+{
+    ariel_audio_engine_set_morph(engine, NULL);
+}
+
+// Crossfade into the chain published by the next change to the active
+// plugin store, instead of cutting over
+void
+ariel_audio_engine_crossfade_next_chain(ArielAudioEngine *engine)
+{
+    if (engine) {
+        engine->crossfade_next = TRUE;
+    }
+}
+
+void
+ariel_audio_engine_on_chain_changed(G_GNUC_UNUSED GListModel *model, G_GNUC_UNUSED guint position,
+                                    G_GNUC_UNUSED guint removed, G_GNUC_UNUSED guint added,
+                                    gpointer user_data)
+{
+    ariel_audio_engine_sync_chain((ArielAudioEngine *)user_data);
+}
+
+// Run one slot's plugin over one block in place, inside its mix stage
+// (audio thread)
+static void
+ariel_process_slot_run(ArielActivePlugin *plugin, float *buffer_L, float *buffer_R, jack_nframes_t nframes)
+{
+    if (!ariel_active_plugin_is_active(plugin)) {
+        return;
+    }
+
+    float *input_buffers[2] = { buffer_L, buffer_R };
+    float *output_buffers[2] = { buffer_L, buffer_R };
+    float *dry_L = nframes <= ARIEL_FADE_MAX_FRAMES ? slot_dry_L : NULL;
+    float *dry_R = nframes <= ARIEL_FADE_MAX_FRAMES ? slot_dry_R : NULL;
+
+    // A bypassed slot passes its input through untouched
+    ArielSlotStage *stage = ariel_active_plugin_get_bypass(plugin) ?
+        NULL : ariel_active_plugin_get_slot_stage(plugin);
+    if (stage) {
+        ariel_slot_stage_begin(stage, buffer_L, buffer_R, dry_L, dry_R, nframes);
+    }
+
+    ariel_active_plugin_connect_audio_ports(plugin, input_buffers, output_buffers);
+    ariel_active_plugin_process(plugin, nframes);
+
+    // For mono plugins, copy mono output to both channels
+    if (ariel_active_plugin_is_mono(plugin)) {
+        ariel_dsp_stereoize(buffer_L, buffer_R, nframes);
+    }
+
+    if (stage) {
+        ariel_slot_stage_end(stage, buffer_L, buffer_R, dry_L, dry_R, nframes);
+    }
+    ariel_meter_update(ariel_active_plugin_get_meter(plugin), buffer_L, buffer_R, nframes);
+}
+
+// Fade from the outgoing signal in fade_L/fade_R to the incoming one in
+// buffer_L/buffer_R, position frames into a fade of length frames
+static void
+ariel_crossfade_mix(float *buffer_L, float *buffer_R, const float *fade_L, const float *fade_R,
+                    guint position, guint length, jack_nframes_t nframes)
+{
+    // Equal power: gains follow a quarter sine, so summed power stays
+    // constant. The curve is followed in short straight segments, each
+    // mixed by the blend kernel.
+    const float step = (float)G_PI_2 / (float)length;
+    const guint segment = CLAMP(length / ARIEL_CROSSFADE_PIECES, 1, ARIEL_CROSSFADE_SEGMENT);
+    jack_nframes_t i = 0;
+    while (i < nframes && position + i < length) {
+        guint n = MIN(MIN(segment, nframes - i), length - (position + i));
+        float start = step * (float)(position + i);
+        float end = step * (float)(position + i + n);
+        float gain_in = sinf(start);
+        float gain_out = cosf(start);
+        float in_step = (sinf(end) - gain_in) / (float)n;
+        float out_step = (cosf(end) - gain_out) / (float)n;
+
+        ariel_dsp_blend(buffer_L + i, fade_L + i, gain_in, in_step, gain_out, out_step, n);
+        ariel_dsp_blend(buffer_R + i, fade_R + i, gain_in, in_step, gain_out, out_step, n);
+        i += n;
+    }
+    // Past the end of the fade only the incoming signal is heard, as it is
+}
+
+// Run one chain over one block in place. With fade_from, each slot whose
+// plugin differs there also runs the outgoing plugin and fades from it;
+// nframes must then fit the fade buffers (audio thread).
+static void
+ariel_process_chain_run(ArielProcessChain *chain, ArielProcessChain *fade_from,
+                        guint fade_position, guint fade_length,
+                        float *buffer_L, float *buffer_R, jack_nframes_t nframes)
+{
+    if (!chain || chain->n_plugins == 0) {
+        return;
+    }
+
+    // Process each active plugin in series
+    for (guint i = 0; i < chain->n_plugins; i++) {
+        ArielActivePlugin *plugin = chain->plugins[i];
+        ArielActivePlugin *outgoing = fade_from ? fade_from->plugins[i] : NULL;
+
+        if (!outgoing || outgoing == plugin) {
+            ariel_process_slot_run(plugin, buffer_L, buffer_R, nframes);
+            continue;
+        }
+
+        ariel_dsp_copy(fade_buffer_L, buffer_L, nframes);
+        ariel_dsp_copy(fade_buffer_R, buffer_R, nframes);
+        ariel_process_slot_run(outgoing, fade_buffer_L, fade_buffer_R, nframes);
+        ariel_process_slot_run(plugin, buffer_L, buffer_R, nframes);
+        ariel_crossfade_mix(buffer_L, buffer_R, fade_buffer_L, fade_buffer_R,
+                            fade_position, fade_length, nframes);
+    }
+}
+
+// Follow the morph position, if it moved since the last cycle (audio thread)
+static void
+ariel_audio_engine_run_morph(ArielAudioEngine *engine)
+{
+    ArielSceneMorph *morph = engine->morph;
+    if (!morph) return;
+
+    float position = (float)g_atomic_int_get(&engine->morph_position) / ARIEL_MORPH_RESOLUTION;
+    if (position != morph->position) {
+        ariel_scene_morph_apply(morph, position);
+    }
+}
+
+// Run the current chain over one block in place, crossfading from the
+// previous chain while a fade is in progress (audio thread)
+void
+ariel_audio_engine_process_chain(ArielAudioEngine *engine, float *buffer_L, float *buffer_R, jack_nframes_t nframes)
+{
+    ArielProcessChain *fade_chain = engine->fade_chain;
+
+    ariel_audio_engine_run_morph(engine);
+
+    if (!fade_chain) {
+        ariel_process_chain_run(engine->chain, NULL, 0, 0, buffer_L, buffer_R, nframes);
+        return;
+    }
+
+    if (engine->fade_position < engine->fade_length && nframes <= ARIEL_FADE_MAX_FRAMES) {
+        if (engine->fade_slots) {
+            ariel_process_chain_run(engine->chain, fade_chain, engine->fade_position, engine->fade_length,
+                                    buffer_L, buffer_R, nframes);
+        } else {
+            ariel_dsp_copy(fade_buffer_L, buffer_L, nframes);
+            ariel_dsp_copy(fade_buffer_R, buffer_R, nframes);
+
+            ariel_process_chain_run(fade_chain, NULL, 0, 0, fade_buffer_L, fade_buffer_R, nframes);
+            ariel_process_chain_run(engine->chain, NULL, 0, 0, buffer_L, buffer_R, nframes);
+            ariel_crossfade_mix(buffer_L, buffer_R, fade_buffer_L, fade_buffer_R,
+                                engine->fade_position, engine->fade_length, nframes);
+        }
+
+        engine->fade_position = MIN(engine->fade_position + nframes, engine->fade_length);
+    } else {
+        // Fade over (or period too long to fade): only the new chain is heard
+        engine->fade_position = engine->fade_length;
+        ariel_process_chain_run(engine->chain, NULL, 0, 0, buffer_L, buffer_R, nframes);
+    }
+
+    // Retire the old chain once the fade is done and there is room to
+    // hand it back; until then it is kept but no longer run
+    if (engine->fade_position >= engine->fade_length &&
+        jack_ringbuffer_write_space(engine->reclaim_ring) >= sizeof(ArielEngineCommand)) {
+        ariel_audio_engine_retire_chain(engine, fade_chain);
+        engine->fade_chain = NULL;
+    }
+}
@@ -0,0 +1,627 @@
+#include "ariel_dsp.h"
+#include <math.h>
+#include <string.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ARIEL_DSP_X86 1
+#endif
+
+// Buffer kernels.
+//
+// The host's own buffer work (copies, gains, blends, meters) goes through
+// one table of kernels. There is a scalar reference, and on x86 builds
+// with GCC or Clang also SSE2, AVX2 and AVX-512 versions, compiled with
+// target attributes so no special build flags are needed. The first call
+// to ariel_dsp_init asks the CPU what it has and keeps the widest table it
+// can run. Selection happens once, on the main thread, before the audio
+// thread starts. tests/dsp_kernels_test.c holds every table to the scalar
+// reference.
+
+static const float lane_index[16] = {
+    0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f,
+    8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f
+};
+
+// Scalar reference
+
+static void
+copy_scalar(float *dst, const float *src, guint n)
+{
+    memcpy(dst, src, n * sizeof(float));
+}
+
+static void
+fill_scalar(float *dst, float value, guint n)
+{
+    for (guint i = 0; i < n; i++) {
+        dst[i] = value;
+    }
+}
+
+static void
+gain_scalar(float *buffer, float gain, guint n)
+{
+    for (guint i = 0; i < n; i++) {
+        buffer[i] *= gain;
+    }
+}
+
+static void
+gain_ramp_scalar(float *buffer, float *copy, float gain, float step, guint n)
+{
+    for (guint i = 0; i < n; i++) {
+        if (copy) {
+            copy[i] = buffer[i];
+        }
+        buffer[i] *= gain + i * step;
+    }
+}
+
+static void
+mix_add_scalar(float *dst, const float *src, float gain, guint n)
+{
+    for (guint i = 0; i < n; i++) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+static void
+blend_scalar(float *buffer, const float *dry, float wet, float wet_step,
+             float dry_gain, float dry_step, guint n)
+{
+    for (guint i = 0; i < n; i++) {
+        float y = buffer[i] * (wet + i * wet_step);
+        if (dry) {
+            y += dry[i] * (dry_gain + i * dry_step);
+        }
+        buffer[i] = y;
+    }
+}
+
+static float
+peak_scalar(const float *src, guint n)
+{
+    float peak = 0.0f;
+    for (guint i = 0; i < n; i++) {
+        peak = MAX(peak, fabsf(src[i]));
+    }
+    return peak;
+}
+
+static float
+sum_squares_scalar(const float *src, guint n)
+{
+    float sum = 0.0f;
+    for (guint i = 0; i < n; i++) {
+        sum += src[i] * src[i];
+    }
+    return sum;
+}
+
+// A sample is NaN or infinite when all its exponent bits are set. Tested
+// on the bits, so it holds under -ffast-math too.
+static guint
+scrub_scalar(float *buffer, guint n)
+{
+    guint count = 0;
+    for (guint i = 0; i < n; i++) {
+        guint32 bits;
+        memcpy(&bits, buffer + i, sizeof(bits));
+        if ((bits & 0x7f800000u) == 0x7f800000u) {
+            buffer[i] = 0.0f;
+            count++;
+        }
+    }
+    return count;
+}
+
+static const ArielDspKernels scalar_kernels = {
+    "scalar",
+    copy_scalar,
+    fill_scalar,
+    gain_scalar,
+    gain_ramp_scalar,
+    mix_add_scalar,
+    blend_scalar,
+    peak_scalar,
+    sum_squares_scalar,
+    scrub_scalar,
+};
+
+#ifdef ARIEL_DSP_X86
+
+// SSE2: four samples at a time
+
+__attribute__((target("sse2"))) static void
+copy_sse2(float *dst, const float *src, guint n)
+{
+    guint i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(dst + i, _mm_loadu_ps(src + i));
+    }
+    copy_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("sse2"))) static void
+fill_sse2(float *dst, float value, guint n)
+{
+    const __m128 v = _mm_set1_ps(value);
+    guint i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(dst + i, v);
+    }
+    fill_scalar(dst + i, value, n - i);
+}
+
+__attribute__((target("sse2"))) static void
+gain_sse2(float *buffer, float gain, guint n)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    guint i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i), g));
+    }
+    gain_scalar(buffer + i, gain, n - i);
+}
+
+__attribute__((target("sse2"))) static void
+gain_ramp_sse2(float *buffer, float *copy, float gain, float step, guint n)
+{
+    const __m128 lanes = _mm_mul_ps(_mm_loadu_ps(lane_index), _mm_set1_ps(step));
+    guint i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 g = _mm_add_ps(_mm_set1_ps(gain + i * step), lanes);
+        __m128 x = _mm_loadu_ps(buffer + i);
+        if (copy) {
+            _mm_storeu_ps(copy + i, x);
+        }
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(x, g));
+    }
+    gain_ramp_scalar(buffer + i, copy ? copy + i : NULL, gain + i * step, step, n - i);
+}
+
+__attribute__((target("sse2"))) static void
+mix_add_sse2(float *dst, const float *src, float gain, guint n)
+{
+    const __m128 g = _mm_set1_ps(gain);
+    guint i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 y = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g));
+        _mm_storeu_ps(dst + i, y);
+    }
+    mix_add_scalar(dst + i, src + i, gain, n - i);
+}
+
+__attribute__((target("sse2"))) static void
+blend_sse2(float *buffer, const float *dry, float wet, float wet_step,
+           float dry_gain, float dry_step, guint n)
+{
+    const __m128 index = _mm_loadu_ps(lane_index);
+    const __m128 wet_lanes = _mm_mul_ps(index, _mm_set1_ps(wet_step));
+    const __m128 dry_lanes = _mm_mul_ps(index, _mm_set1_ps(dry_step));
+    guint i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 w = _mm_add_ps(_mm_set1_ps(wet + i * wet_step), wet_lanes);
+        __m128 y = _mm_mul_ps(_mm_loadu_ps(buffer + i), w);
+        if (dry) {
+            __m128 d = _mm_add_ps(_mm_set1_ps(dry_gain + i * dry_step), dry_lanes);
+            y = _mm_add_ps(y, _mm_mul_ps(_mm_loadu_ps(dry + i), d));
+        }
+        _mm_storeu_ps(buffer + i, y);
+    }
+    blend_scalar(buffer + i, dry ? dry + i : NULL, wet + i * wet_step, wet_step,
+                 dry_gain + i * dry_step, dry_step, n - i);
+}
+
+__attribute__((target("sse2"))) static float
+peak_sse2(const float *src, guint n)
+{
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 peak = _mm_setzero_ps();
+    guint i = 0;
+    for (; i + 4 <= n; i += 4) {
+        peak = _mm_max_ps(peak, _mm_and_ps(_mm_loadu_ps(src + i), abs_mask));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, peak);
+    float result = MAX(MAX(lanes[0], lanes[1]), MAX(lanes[2], lanes[3]));
+    return MAX(result, peak_scalar(src + i, n - i));
+}
+
+__attribute__((target("sse2"))) static float
+sum_squares_sse2(const float *src, guint n)
+{
+    __m128 sum = _mm_setzero_ps();
+    guint i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(src + i);
+        sum = _mm_add_ps(sum, _mm_mul_ps(x, x));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, sum);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sum_squares_scalar(src + i, n - i);
+}
+
+__attribute__((target("sse2"))) static guint
+scrub_sse2(float *buffer, guint n)
+{
+    const __m128i exponent = _mm_set1_epi32(0x7f800000);
+    guint count = 0;
+    guint i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(buffer + i);
+        __m128i bad = _mm_cmpeq_epi32(_mm_and_si128(_mm_castps_si128(x), exponent), exponent);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(bad));
+        if (mask) {
+            count += (guint)__builtin_popcount(mask);
+            _mm_storeu_ps(buffer + i, _mm_andnot_ps(_mm_castsi128_ps(bad), x));
+        }
+    }
+    return count + scrub_scalar(buffer + i, n - i);
+}
+
+static const ArielDspKernels sse2_kernels = {
+    "sse2",
+    copy_sse2,
+    fill_sse2,
+    gain_sse2,
+    gain_ramp_sse2,
+    mix_add_sse2,
+    blend_sse2,
+    peak_sse2,
+    sum_squares_sse2,
+    scrub_sse2,
+};
+
+// AVX2: eight samples at a time
+
+__attribute__((target("avx2"))) static void
+copy_avx2(float *dst, const float *src, guint n)
+{
+    guint i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_loadu_ps(src + i));
+    }
+    copy_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2"))) static void
+fill_avx2(float *dst, float value, guint n)
+{
+    const __m256 v = _mm256_set1_ps(value);
+    guint i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(dst + i, v);
+    }
+    fill_scalar(dst + i, value, n - i);
+}
+
+__attribute__((target("avx2"))) static void
+gain_avx2(float *buffer, float gain, guint n)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    guint i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(buffer + i, _mm256_mul_ps(_mm256_loadu_ps(buffer + i), g));
+    }
+    gain_scalar(buffer + i, gain, n - i);
+}
+
+__attribute__((target("avx2"))) static void
+gain_ramp_avx2(float *buffer, float *copy, float gain, float step, guint n)
+{
+    const __m256 lanes = _mm256_mul_ps(_mm256_loadu_ps(lane_index), _mm256_set1_ps(step));
+    guint i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 g = _mm256_add_ps(_mm256_set1_ps(gain + i * step), lanes);
+        __m256 x = _mm256_loadu_ps(buffer + i);
+        if (copy) {
+            _mm256_storeu_ps(copy + i, x);
+        }
+        _mm256_storeu_ps(buffer + i, _mm256_mul_ps(x, g));
+    }
+    gain_ramp_scalar(buffer + i, copy ? copy + i : NULL, gain + i * step, step, n - i);
+}
+
+__attribute__((target("avx2"))) static void
+mix_add_avx2(float *dst, const float *src, float gain, guint n)
+{
+    const __m256 g = _mm256_set1_ps(gain);
+    guint i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 y = _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+        _mm256_storeu_ps(dst + i, y);
+    }
+    mix_add_scalar(dst + i, src + i, gain, n - i);
+}
+
+__attribute__((target("avx2"))) static void
+blend_avx2(float *buffer, const float *dry, float wet, float wet_step,
+           float dry_gain, float dry_step, guint n)
+{
+    const __m256 index = _mm256_loadu_ps(lane_index);
+    const __m256 wet_lanes = _mm256_mul_ps(index, _mm256_set1_ps(wet_step));
+    const __m256 dry_lanes = _mm256_mul_ps(index, _mm256_set1_ps(dry_step));
+    guint i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 w = _mm256_add_ps(_mm256_set1_ps(wet + i * wet_step), wet_lanes);
+        __m256 y = _mm256_mul_ps(_mm256_loadu_ps(buffer + i), w);
+        if (dry) {
+            __m256 d = _mm256_add_ps(_mm256_set1_ps(dry_gain + i * dry_step), dry_lanes);
+            y = _mm256_add_ps(y, _mm256_mul_ps(_mm256_loadu_ps(dry + i), d));
+        }
+        _mm256_storeu_ps(buffer + i, y);
+    }
+    blend_scalar(buffer + i, dry ? dry + i : NULL, wet + i * wet_step, wet_step,
+                 dry_gain + i * dry_step, dry_step, n - i);
+}
+
+__attribute__((target("avx2"))) static float
+peak_avx2(const float *src, guint n)
+{
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 peak = _mm256_setzero_ps();
+    guint i = 0;
+    for (; i + 8 <= n; i += 8) {
+        peak = _mm256_max_ps(peak, _mm256_and_ps(_mm256_loadu_ps(src + i), abs_mask));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, peak);
+    float result = 0.0f;
+    for (guint j = 0; j < 8; j++) {
+        result = MAX(result, lanes[j]);
+    }
+    return MAX(result, peak_scalar(src + i, n - i));
+}
+
+__attribute__((target("avx2"))) static float
+sum_squares_avx2(const float *src, guint n)
+{
+    __m256 sum = _mm256_setzero_ps();
+    guint i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(src + i);
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(x, x));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, sum);
+    float result = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+                   ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    return result + sum_squares_scalar(src + i, n - i);
+}
+
+__attribute__((target("avx2"))) static guint
+scrub_avx2(float *buffer, guint n)
+{
+    const __m256i exponent = _mm256_set1_epi32(0x7f800000);
+    guint count = 0;
+    guint i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(buffer + i);
+        __m256i bad = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_castps_si256(x), exponent), exponent);
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(bad));
+        if (mask) {
+            count += (guint)__builtin_popcount(mask);
+            _mm256_storeu_ps(buffer + i, _mm256_andnot_ps(_mm256_castsi256_ps(bad), x));
+        }
+    }
+    return count + scrub_scalar(buffer + i, n - i);
+}
+
+static const ArielDspKernels avx2_kernels = {
+    "avx2",
+    copy_avx2,
+    fill_avx2,
+    gain_avx2,
+    gain_ramp_avx2,
+    mix_add_avx2,
+    blend_avx2,
+    peak_avx2,
+    sum_squares_avx2,
+    scrub_avx2,
+};
+
+// AVX-512: sixteen samples at a time
+
+__attribute__((target("avx512f"))) static void
+copy_avx512(float *dst, const float *src, guint n)
+{
+    guint i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(dst + i, _mm512_loadu_ps(src + i));
+    }
+    copy_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx512f"))) static void
+fill_avx512(float *dst, float value, guint n)
+{
+    const __m512 v = _mm512_set1_ps(value);
+    guint i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(dst + i, v);
+    }
+    fill_scalar(dst + i, value, n - i);
+}
+
+__attribute__((target("avx512f"))) static void
+gain_avx512(float *buffer, float gain, guint n)
+{
+    const __m512 g = _mm512_set1_ps(gain);
+    guint i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(buffer + i, _mm512_mul_ps(_mm512_loadu_ps(buffer + i), g));
+    }
+    gain_scalar(buffer + i, gain, n - i);
+}
+
+__attribute__((target("avx512f"))) static void
+gain_ramp_avx512(float *buffer, float *copy, float gain, float step, guint n)
+{
+    const __m512 lanes = _mm512_mul_ps(_mm512_loadu_ps(lane_index), _mm512_set1_ps(step));
+    guint i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 g = _mm512_add_ps(_mm512_set1_ps(gain + i * step), lanes);
+        __m512 x = _mm512_loadu_ps(buffer + i);
+        if (copy) {
+            _mm512_storeu_ps(copy + i, x);
+        }
+        _mm512_storeu_ps(buffer + i, _mm512_mul_ps(x, g));
+    }
+    gain_ramp_scalar(buffer + i, copy ? copy + i : NULL, gain + i * step, step, n - i);
+}
+
+__attribute__((target("avx512f"))) static void
+mix_add_avx512(float *dst, const float *src, float gain, guint n)
+{
+    const __m512 g = _mm512_set1_ps(gain);
+    guint i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 y = _mm512_add_ps(_mm512_loadu_ps(dst + i), _mm512_mul_ps(_mm512_loadu_ps(src + i), g));
+        _mm512_storeu_ps(dst + i, y);
+    }
+    mix_add_scalar(dst + i, src + i, gain, n - i);
+}
+
+__attribute__((target("avx512f"))) static void
+blend_avx512(float *buffer, const float *dry, float wet, float wet_step,
+             float dry_gain, float dry_step, guint n)
+{
+    const __m512 index = _mm512_loadu_ps(lane_index);
+    const __m512 wet_lanes = _mm512_mul_ps(index, _mm512_set1_ps(wet_step));
+    const __m512 dry_lanes = _mm512_mul_ps(index, _mm512_set1_ps(dry_step));
+    guint i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 w = _mm512_add_ps(_mm512_set1_ps(wet + i * wet_step), wet_lanes);
+        __m512 y = _mm512_mul_ps(_mm512_loadu_ps(buffer + i), w);
+        if (dry) {
+            __m512 d = _mm512_add_ps(_mm512_set1_ps(dry_gain + i * dry_step), dry_lanes);
+            y = _mm512_add_ps(y, _mm512_mul_ps(_mm512_loadu_ps(dry + i), d));
+        }
+        _mm512_storeu_ps(buffer + i, y);
+    }
+    blend_scalar(buffer + i, dry ? dry + i : NULL, wet + i * wet_step, wet_step,
+                 dry_gain + i * dry_step, dry_step, n - i);
+}
+
+__attribute__((target("avx512f"))) static float
+peak_avx512(const float *src, guint n)
+{
+    const __m512i abs_mask = _mm512_set1_epi32(0x7fffffff);
+    __m512 peak = _mm512_setzero_ps();
+    guint i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i bits = _mm512_and_si512(_mm512_castps_si512(_mm512_loadu_ps(src + i)), abs_mask);
+        peak = _mm512_max_ps(peak, _mm512_castsi512_ps(bits));
+    }
+    return MAX(_mm512_reduce_max_ps(peak), peak_scalar(src + i, n - i));
+}
+
+__attribute__((target("avx512f"))) static float
+sum_squares_avx512(const float *src, guint n)
+{
+    __m512 sum = _mm512_setzero_ps();
+    guint i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 x = _mm512_loadu_ps(src + i);
+        sum = _mm512_add_ps(sum, _mm512_mul_ps(x, x));
+    }
+    return _mm512_reduce_add_ps(sum) + sum_squares_scalar(src + i, n - i);
+}
+
+__attribute__((target("avx512f"))) static guint
+scrub_avx512(float *buffer, guint n)
+{
+    const __m512i exponent = _mm512_set1_epi32(0x7f800000);
+    guint count = 0;
+    guint i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 x = _mm512_loadu_ps(buffer + i);
+        __mmask16 bad = _mm512_cmpeq_epi32_mask(_mm512_and_si512(_mm512_castps_si512(x), exponent), exponent);
+        if (bad) {
+            count += (guint)__builtin_popcount(bad);
+            _mm512_storeu_ps(buffer + i, _mm512_maskz_mov_ps((__mmask16)~bad, x));
+        }
+    }
+    return count + scrub_scalar(buffer + i, n - i);
+}
+
+static const ArielDspKernels avx512_kernels = {
+    "avx512",
+    copy_avx512,
+    fill_avx512,
+    gain_avx512,
+    gain_ramp_avx512,
+    mix_add_avx512,
+    blend_avx512,
+    peak_avx512,
+    sum_squares_avx512,
+    scrub_avx512,
+};
+
+#endif
+
+const ArielDspKernels *ariel_dsp = &scalar_kernels;
+
+static const ArielDspKernels *const variants[] = {
+    &scalar_kernels,
+#ifdef ARIEL_DSP_X86
+    &sse2_kernels,
+    &avx2_kernels,
+    &avx512_kernels,
+#endif
+};
+
+const ArielDspKernels *const *
+ariel_dsp_get_variants(guint *n_variants)
+{
+    if (n_variants) {
+        *n_variants = G_N_ELEMENTS(variants);
+    }
+    return variants;
+}
+
+gboolean
+ariel_dsp_variant_supported(const ArielDspKernels *kernels)
+{
+    if (kernels == &scalar_kernels) {
+        return TRUE;
+    }
+
+#ifdef ARIEL_DSP_X86
+    __builtin_cpu_init();
+    if (kernels == &avx512_kernels) {
+        return __builtin_cpu_supports("avx512f");
+    }
+    if (kernels == &avx2_kernels) {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (kernels == &sse2_kernels) {
+        return __builtin_cpu_supports("sse2");
+    }
+#endif
+
+    return FALSE;
+}
+
+// Pick the widest kernels the CPU supports. Main thread, before the audio
+// thread starts.
+void
+ariel_dsp_init(void)
+{
+    static gsize initialized = 0;
+    if (!g_once_init_enter(&initialized)) {
+        return;
+    }
+
+    // Variants are listed narrowest first
+    for (guint i = G_N_ELEMENTS(variants); i > 0; i--) {
+        if (ariel_dsp_variant_supported(variants[i - 1])) {
+            ariel_dsp = variants[i - 1];
+            break;
+        }
+    }
+
+    g_print("Buffer kernels: %s\n", ariel_dsp->name);
+    g_once_init_leave(&initialized, 1);
+}
@@ -10,11 +10,16 @@ ariel_audio_engine_new(void)
         return NULL;
     }
     
+    // Buffer kernels for this CPU, picked before any audio thread runs
+    ariel_dsp_init();
+    
     engine->active = FALSE;
     engine->sample_rate = 44100.0f;
     engine->buffer_size = 1024;
     engine->plugin_manager = NULL;
     engine->client = NULL;
+    engine->capture_minutes = ARIEL_DEFAULT_CAPTURE_MINUTES;
+    engine->capture_lock_memory = TRUE;
     
     // Initialize port arrays to NULL
     for (int i = 0; i < 2; i++) {
@@ -22,6 +27,9 @@ ariel_audio_engine_new(void)
         engine->output_ports[i] = NULL;
     }
     
+    // Empty chain and command rings for the audio thread
+    ariel_audio_engine_init_chain(engine);
+    
     ARIEL_INFO("Audio engine created successfully");
     return engine;
 }
@@ -74,6 +82,14 @@ ariel_audio_engine_start(ArielAudioEngine *engine)
                                                  JACK_DEFAULT_AUDIO_TYPE,
                                                  JackPortIsOutput, 0);
     
+    // MIDI is optional; audio runs without it
+    engine->midi_input_port = jack_port_register(engine->client, "midi_in",
+                                                 JACK_DEFAULT_MIDI_TYPE,
+                                                 JackPortIsInput, 0);
+    if (!engine->midi_input_port) {
+        g_warning("Failed to register JACK MIDI input port");
+    }
+    
     if (!engine->input_ports[0] || !engine->input_ports[1] ||
         !engine->output_ports[0] || !engine->output_ports[1]) {
         g_warning("Failed to register JACK ports");
@@ -82,6 +98,9 @@ ariel_audio_engine_start(ArielAudioEngine *engine)
         return FALSE;
     }
     
+    // The capture ring is sized for this sample rate before audio runs
+    ariel_audio_engine_prepare_capture(engine);
+    
     // Activate client
     if (jack_activate(engine->client)) {
         g_warning("Failed to activate JACK client");
@@ -113,11 +132,41 @@ ariel_audio_engine_stop(ArielAudioEngine *engine)
         jack_client_close(engine->client);
         engine->client = NULL;
     }
+    engine->midi_input_port = NULL;
+    engine->n_midi_events = 0;
+    
+    // No audio thread any more, so an open take can be finished here
+    ariel_recorder_free(engine->recorder);
+    engine->recorder = NULL;
+    engine->recording = FALSE;
+    ariel_file_player_free(engine->player);
+    engine->player = NULL;
+    engine->file_player = NULL;
     engine->active = FALSE;
     g_print("Audio engine stopped\n");
 #endif
 }
 
+// Start or stop the shared transport; every client following it, and the
+// plugins of this one, pick the change up at their next cycle
+void
+ariel_audio_engine_set_transport_rolling(ArielAudioEngine *engine, gboolean rolling)
+{
+    if (!engine || !engine->active) {
+        return;
+    }
+    
+#ifndef _WIN32
+    if (engine->client) {
+        if (rolling) {
+            jack_transport_start(engine->client);
+        } else {
+            jack_transport_stop(engine->client);
+        }
+    }
+#endif
+}
+
 void
 ariel_audio_engine_free(ArielAudioEngine *engine)
 {
@@ -127,6 +176,15 @@ ariel_audio_engine_free(ArielAudioEngine *engine)
         ariel_audio_engine_stop(engine);
     }
     
+    if (engine->sync_retry_source) {
+        g_source_remove(engine->sync_retry_source);
+    }
+    if (engine->plugin_manager && engine->chain_changed_id) {
+        g_signal_handler_disconnect(engine->plugin_manager->active_plugin_store, engine->chain_changed_id);
+    }
+    ariel_audio_engine_free_chain(engine);
+    ariel_capture_unref(engine->capture);
+    
     g_free(engine);
 }
 
@@ -142,6 +200,19 @@ ariel_audio_engine_set_plugin_manager(ArielAudioEngine *engine, ArielPluginManag
         ARIEL_WARN("Plugin manager is NULL in set_plugin_manager");
     }
     
+    // Follow the active plugin list; the audio thread only sees snapshots
+    if (engine->plugin_manager && engine->chain_changed_id) {
+        g_signal_handler_disconnect(engine->plugin_manager->active_plugin_store, engine->chain_changed_id);
+        engine->chain_changed_id = 0;
+    }
+    
     engine->plugin_manager = manager;
+    
+    if (manager && manager->active_plugin_store) {
+        engine->chain_changed_id = g_signal_connect(manager->active_plugin_store, "items-changed",
+                                                    G_CALLBACK(ariel_audio_engine_on_chain_changed), engine);
+        ariel_audio_engine_sync_chain(engine);
+    }
+    
     ARIEL_INFO("Plugin manager set for audio engine");
 }
\ No newline at end of file
@@ -0,0 +1,476 @@
+#include "ariel.h"
+#include <math.h>
+#include <string.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+// File player.
+//
+// Plays a WAV file into the chain input, in place of the engine's input or
+// mixed with it, so chains can be auditioned on reference DI files. The
+// file is memory-mapped; a read-ahead thread decodes it to stereo float,
+// converts it to the engine's sample rate when they differ, and keeps a
+// ring buffer a couple of seconds ahead of the audio thread. The audio
+// thread only reads the ring; when it runs dry it plays silence, and once
+// a file that does not loop has played out the live input comes back.
+
+#define ARIEL_PLAYER_RING_SECONDS  2
+#define ARIEL_PLAYER_BLOCK_FRAMES  1024      // Frames converted per step
+#define ARIEL_PLAYER_POLL_US       5000
+
+typedef enum {
+    ARIEL_SAMPLE_U8,
+    ARIEL_SAMPLE_S16,
+    ARIEL_SAMPLE_S24,
+    ARIEL_SAMPLE_S32,
+    ARIEL_SAMPLE_F32,
+    ARIEL_SAMPLE_F64
+} ArielSampleFormat;
+
+struct _ArielFilePlayer {
+    GMappedFile *mapping;
+    const guint8 *data;                  // First frame in the mapping
+    gint64 n_frames;
+    guint channels;
+    guint frame_size;
+    ArielSampleFormat format;
+    guint file_rate;
+    guint engine_rate;
+
+    // Read-ahead thread
+    jack_ringbuffer_t *ring;             // Stereo interleaved float
+    GThread *reader;
+    gint running;                        // Atomic
+    gint loop;                           // Atomic
+    gint finished;                       // A file that does not loop has played out; atomic
+    double position;                     // Next source frame, reader only
+    float *block_L;                      // Decoded source frames, reader only
+    float *block_R;
+    float *out;
+
+    // Audio thread
+    gint mix;                            // Mix with the input instead of replacing it; atomic
+    gint underruns;                      // Atomic
+};
+
+static guint16
+read_u16(const guint8 *p)
+{
+    return (guint16)(p[0] | (p[1] << 8));
+}
+
+static guint32
+read_u32(const guint8 *p)
+{
+    return (guint32)p[0] | ((guint32)p[1] << 8) | ((guint32)p[2] << 16) | ((guint32)p[3] << 24);
+}
+
+// Find the fmt and data chunks of a RIFF/WAVE file
+static gboolean
+ariel_file_player_parse(ArielFilePlayer *player, const char *path)
+{
+    const guint8 *bytes = (const guint8 *)g_mapped_file_get_contents(player->mapping);
+    gsize length = g_mapped_file_get_length(player->mapping);
+    gboolean have_format = FALSE;
+
+    if (length < 12 || memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0) {
+        g_warning("%s is not a WAV file", path);
+        return FALSE;
+    }
+
+    gsize offset = 12;
+    while (offset + 8 <= length) {
+        const guint8 *chunk = bytes + offset;
+        gsize size = read_u32(chunk + 4);
+        gsize body = offset + 8;
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16 && body + size <= length) {
+            guint16 tag = read_u16(bytes + body);
+            guint16 bits = read_u16(bytes + body + 14);
+
+            // WAVE_FORMAT_EXTENSIBLE carries the real tag in its subformat
+            if (tag == 0xFFFE && size >= 40) {
+                tag = read_u16(bytes + body + 24);
+            }
+
+            player->channels = read_u16(bytes + body + 2);
+            player->file_rate = read_u32(bytes + body + 4);
+            player->frame_size = read_u16(bytes + body + 12);
+
+            if (tag == 1 && bits == 8) {
+                player->format = ARIEL_SAMPLE_U8;
+            } else if (tag == 1 && bits == 16) {
+                player->format = ARIEL_SAMPLE_S16;
+            } else if (tag == 1 && bits == 24) {
+                player->format = ARIEL_SAMPLE_S24;
+            } else if (tag == 1 && bits == 32) {
+                player->format = ARIEL_SAMPLE_S32;
+            } else if (tag == 3 && bits == 32) {
+                player->format = ARIEL_SAMPLE_F32;
+            } else if (tag == 3 && bits == 64) {
+                player->format = ARIEL_SAMPLE_F64;
+            } else {
+                g_warning("%s: unsupported WAV format %u with %u bits", path, tag, bits);
+                return FALSE;
+            }
+
+            // The decoder reads every channel's sample inside its frame
+            if (player->frame_size < player->channels * (bits / 8u)) {
+                g_warning("%s: block align %u too small for %u channels of %u bits", path,
+                          player->frame_size, player->channels, bits);
+                return FALSE;
+            }
+            have_format = TRUE;
+        } else if (memcmp(chunk, "data", 4) == 0 && have_format) {
+            // A data size past the end (or 0xFFFFFFFF from a stopped recorder) means "to the end"
+            gsize data_size = MIN(size, length - body);
+            if (player->channels == 0 || player->frame_size == 0 || player->file_rate == 0) {
+                break;
+            }
+            player->data = bytes + body;
+            player->n_frames = (gint64)(data_size / player->frame_size);
+            return player->n_frames > 0;
+        }
+
+        offset = body + size + (size & 1);
+    }
+
+    g_warning("%s has no audio data", path);
+    return FALSE;
+}
+
+static inline float
+ariel_file_player_sample(const ArielFilePlayer *player, const guint8 *p)
+{
+    switch (player->format) {
+    case ARIEL_SAMPLE_U8:
+        return (p[0] - 128) / 128.0f;
+    case ARIEL_SAMPLE_S16:
+        return (gint16)read_u16(p) / 32768.0f;
+    case ARIEL_SAMPLE_S24:
+        return (gint32)(((guint32)p[0] << 8) | ((guint32)p[1] << 16) | ((guint32)p[2] << 24)) / 2147483648.0f;
+    case ARIEL_SAMPLE_S32:
+        return (gint32)read_u32(p) / 2147483648.0f;
+    case ARIEL_SAMPLE_F32: {
+        guint32 bits = read_u32(p);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    case ARIEL_SAMPLE_F64: {
+        guint64 bits = read_u32(p) | ((guint64)read_u32(p + 4) << 32);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return (float)value;
+    }
+    }
+    return 0.0f;
+}
+
+// Decode source frames [start, start + n) to planar stereo. Frames outside
+// the file wrap around when looping and are silent otherwise; mono files
+// play on both sides.
+static void
+ariel_file_player_decode(ArielFilePlayer *player, gint64 start, guint n, float *L, float *R)
+{
+    gboolean loop = g_atomic_int_get(&player->loop);
+    guint sample_size = player->frame_size / player->channels;
+
+    for (guint i = 0; i < n; i++) {
+        gint64 frame = start + i;
+
+        if (frame < 0 || frame >= player->n_frames) {
+            if (!loop) {
+                L[i] = R[i] = 0.0f;
+                continue;
+            }
+            frame %= player->n_frames;
+            if (frame < 0) {
+                frame += player->n_frames;
+            }
+        }
+
+        const guint8 *p = player->data + (gsize)frame * player->frame_size;
+        L[i] = ariel_file_player_sample(player, p);
+        R[i] = player->channels > 1 ? ariel_file_player_sample(player, p + sample_size) : L[i];
+    }
+}
+
+// Catmull-Rom interpolation of one channel at n positions pos + k * step,
+// relative to src, which holds one frame before pos and two after the last.
+// Writes every other float of out, so both channels share the buffer.
+static void
+ariel_file_player_resample(const float *src, double pos, double step, guint n, float *out)
+{
+    guint k = 0;
+
+#ifdef __SSE__
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 four = _mm_set1_ps(4.0f);
+    const __m128 five = _mm_set1_ps(5.0f);
+
+    for (; k + 4 <= n; k += 4) {
+        float xm1[4], x0[4], x1[4], x2[4], t[4];
+        for (guint j = 0; j < 4; j++) {
+            double p = pos + (k + j) * step;
+            gint64 i = (gint64)p;
+            t[j] = (float)(p - i);
+            xm1[j] = src[i];
+            x0[j] = src[i + 1];
+            x1[j] = src[i + 2];
+            x2[j] = src[i + 3];
+        }
+
+        __m128 vm1 = _mm_loadu_ps(xm1);
+        __m128 v0 = _mm_loadu_ps(x0);
+        __m128 v1 = _mm_loadu_ps(x1);
+        __m128 v2 = _mm_loadu_ps(x2);
+        __m128 vt = _mm_loadu_ps(t);
+
+        // x0 + 0.5 t (x1 - xm1 + t (2 xm1 - 5 x0 + 4 x1 - x2 + t (3 (x0 - x1) + x2 - xm1)))
+        __m128 c3 = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(three, _mm_sub_ps(v0, v1)), v2), vm1);
+        __m128 c2 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(two, vm1), _mm_mul_ps(five, v0)),
+                                          _mm_mul_ps(four, v1)), v2);
+        __m128 c1 = _mm_sub_ps(v1, vm1);
+        __m128 y = _mm_add_ps(c2, _mm_mul_ps(vt, c3));
+        y = _mm_add_ps(c1, _mm_mul_ps(vt, y));
+        y = _mm_add_ps(v0, _mm_mul_ps(_mm_mul_ps(half, vt), y));
+
+        float result[4];
+        _mm_storeu_ps(result, y);
+        for (guint j = 0; j < 4; j++) {
+            out[2 * (k + j)] = result[j];
+        }
+    }
+#endif
+
+    for (; k < n; k++) {
+        double p = pos + k * step;
+        gint64 i = (gint64)p;
+        float t = (float)(p - i);
+        float xm1 = src[i], x0 = src[i + 1], x1 = src[i + 2], x2 = src[i + 3];
+
+        out[2 * k] = x0 + 0.5f * t * (x1 - xm1 + t * (2.0f * xm1 - 5.0f * x0 + 4.0f * x1 - x2 +
+                                                        t * (3.0f * (x0 - x1) + x2 - xm1)));
+    }
+}
+
+// Produce the next block at the engine's rate; FALSE once a file that does
+// not loop has played out
+static gboolean
+ariel_file_player_fill_block(ArielFilePlayer *player, guint n)
+{
+    if (!g_atomic_int_get(&player->loop) && player->position >= player->n_frames) {
+        // Everything is in the ring by now, so the audio thread may hand
+        // back to the input once it runs dry
+        g_atomic_int_set(&player->finished, 1);
+        return FALSE;
+    }
+    g_atomic_int_set(&player->finished, 0);
+
+    if (player->file_rate == player->engine_rate) {
+        gint64 start = (gint64)player->position;
+        ariel_file_player_decode(player, start, n, player->block_L, player->block_R);
+        for (guint k = 0; k < n; k++) {
+            player->out[2 * k] = player->block_L[k];
+            player->out[2 * k + 1] = player->block_R[k];
+        }
+        player->position = start + n;
+    } else {
+        double step = (double)player->file_rate / player->engine_rate;
+        gint64 first = (gint64)floor(player->position) - 1;
+        guint n_source = (guint)((gint64)floor(player->position + (n - 1) * step) - first) + 3;
+        double pos = player->position - (first + 1);
+
+        ariel_file_player_decode(player, first, n_source, player->block_L, player->block_R);
+        ariel_file_player_resample(player->block_L, pos, step, n, player->out);
+        ariel_file_player_resample(player->block_R, pos, step, n, player->out + 1);
+        player->position += n * step;
+    }
+
+    // Keep the position small while looping, so the fraction stays precise
+    if (g_atomic_int_get(&player->loop) && player->position >= player->n_frames) {
+        player->position = fmod(player->position, (double)player->n_frames);
+    }
+
+    jack_ringbuffer_write(player->ring, (const char *)player->out, (size_t)n * 2 * sizeof(float));
+    return TRUE;
+}
+
+static gpointer
+ariel_file_player_reader_thread(gpointer data)
+{
+    ArielFilePlayer *player = data;
+    size_t block_size = ARIEL_PLAYER_BLOCK_FRAMES * 2 * sizeof(float);
+
+    while (g_atomic_int_get(&player->running)) {
+        if (jack_ringbuffer_write_space(player->ring) < block_size ||
+            !ariel_file_player_fill_block(player, ARIEL_PLAYER_BLOCK_FRAMES)) {
+            g_usleep(ARIEL_PLAYER_POLL_US);
+        }
+    }
+    return NULL;
+}
+
+// Map a WAV file and start reading it ahead at the engine's sample rate
+ArielFilePlayer *
+ariel_file_player_new(const char *path, guint engine_rate)
+{
+    g_return_val_if_fail(path != NULL && engine_rate > 0, NULL);
+
+    GError *error = NULL;
+    GMappedFile *mapping = g_mapped_file_new(path, FALSE, &error);
+    if (!mapping) {
+        g_warning("Could not open %s: %s", path, error->message);
+        g_error_free(error);
+        return NULL;
+    }
+
+    ArielFilePlayer *player = g_new0(ArielFilePlayer, 1);
+    player->mapping = mapping;
+    player->engine_rate = engine_rate;
+    player->loop = 1;
+
+    if (!ariel_file_player_parse(player, path)) {
+        g_mapped_file_unref(mapping);
+        g_free(player);
+        return NULL;
+    }
+
+    // Enough source frames for one block at any supported ratio, plus the
+    // interpolation taps
+    double step = (double)player->file_rate / engine_rate;
+    guint max_source = (guint)ceil(ARIEL_PLAYER_BLOCK_FRAMES * MAX(step, 1.0)) + 8;
+    player->block_L = g_new(float, max_source);
+    player->block_R = g_new(float, max_source);
+    player->out = g_new(float, ARIEL_PLAYER_BLOCK_FRAMES * 2);
+
+    player->ring = jack_ringbuffer_create((size_t)engine_rate * ARIEL_PLAYER_RING_SECONDS * 2 * sizeof(float));
+    jack_ringbuffer_mlock(player->ring);
+
+    // Fill the ring before the audio thread sees the player
+    while (jack_ringbuffer_write_space(player->ring) >= ARIEL_PLAYER_BLOCK_FRAMES * 2 * sizeof(float) &&
+           ariel_file_player_fill_block(player, ARIEL_PLAYER_BLOCK_FRAMES)) {
+    }
+
+    player->running = 1;
+    player->reader = g_thread_new("ariel-file-player", ariel_file_player_reader_thread, player);
+
+    g_print("Playing %s: %" G_GINT64_FORMAT " frames, %u channels at %u Hz%s\n", path,
+            player->n_frames, player->channels, player->file_rate,
+            player->file_rate != engine_rate ? ", converted" : "");
+    return player;
+}
+
+// Stop reading and unmap the file. The audio thread must no longer be using it.
+void
+ariel_file_player_free(ArielFilePlayer *player)
+{
+    if (!player) return;
+
+    g_atomic_int_set(&player->running, 0);
+    g_thread_join(player->reader);
+
+    gint underruns = g_atomic_int_get(&player->underruns);
+    if (underruns > 0) {
+        g_warning("File player ran dry %d times", underruns);
+    }
+
+    jack_ringbuffer_free(player->ring);
+    g_free(player->block_L);
+    g_free(player->block_R);
+    g_free(player->out);
+    g_mapped_file_unref(player->mapping);
+    g_free(player);
+}
+
+void
+ariel_file_player_set_loop(ArielFilePlayer *player, gboolean loop)
+{
+    g_atomic_int_set(&player->loop, loop ? 1 : 0);
+}
+
+void
+ariel_file_player_set_mix(ArielFilePlayer *player, gboolean mix)
+{
+    g_atomic_int_set(&player->mix, mix ? 1 : 0);
+}
+
+// Play the next nframes into the chain input (audio thread), replacing it
+// or adding to it. L and R hold the live input on entry.
+void
+ariel_file_player_read(ArielFilePlayer *player, float *L, float *R, jack_nframes_t nframes)
+{
+    gboolean mix = g_atomic_int_get(&player->mix);
+    // Read before the ring, so a finished player's last frames are seen
+    gboolean finished = g_atomic_int_get(&player->finished);
+    jack_nframes_t available = (jack_nframes_t)(jack_ringbuffer_read_space(player->ring) / (2 * sizeof(float)));
+    jack_nframes_t n = MIN(nframes, available);
+
+    jack_ringbuffer_data_t vector[2];
+    jack_ringbuffer_get_read_vector(player->ring, vector);
+
+    jack_nframes_t frame = 0;
+    for (guint v = 0; v < 2 && frame < n; v++) {
+        const float *src = (const float *)vector[v].buf;
+        jack_nframes_t count = MIN(n - frame, (jack_nframes_t)(vector[v].len / (2 * sizeof(float))));
+
+        if (mix) {
+            for (jack_nframes_t i = 0; i < count; i++) {
+                L[frame + i] += src[2 * i];
+                R[frame + i] += src[2 * i + 1];
+            }
+        } else {
+            for (jack_nframes_t i = 0; i < count; i++) {
+                L[frame + i] = src[2 * i];
+                R[frame + i] = src[2 * i + 1];
+            }
+        }
+        frame += count;
+    }
+    jack_ringbuffer_read_advance(player->ring, (size_t)n * 2 * sizeof(float));
+
+    // A file that played out leaves the rest to the live input; otherwise
+    // the reader fell behind
+    if (n < nframes && !finished) {
+        g_atomic_int_inc(&player->underruns);
+        if (!mix) {
+            ariel_dsp_fill(L + n, 0.0f, nframes - n);
+            ariel_dsp_fill(R + n, 0.0f, nframes - n);
+        }
+    }
+}
+
+// Play a file into the chain input from the next cycle on, or stop the
+// current one with NULL. Main thread; engine->file_player is the player
+// until the next call.
+gboolean
+ariel_audio_engine_play_file(ArielAudioEngine *engine, const char *path, gboolean mix)
+{
+    g_return_val_if_fail(engine != NULL, FALSE);
+
+    ArielFilePlayer *player = NULL;
+    if (path) {
+        if (engine->sample_rate <= 0) {
+            return FALSE;
+        }
+        player = ariel_file_player_new(path, (guint)engine->sample_rate);
+        if (!player) {
+            return FALSE;
+        }
+        ariel_file_player_set_mix(player, mix);
+    }
+
+    ArielEngineCommand command = {
+        .type = ARIEL_ENGINE_COMMAND_SET_PLAYER,
+        .player = player,
+    };
+    if (!ariel_audio_engine_send_command(engine, &command)) {
+        return FALSE;
+    }
+    engine->file_player = player;
+    return TRUE;
+}
@@ -1,5 +1,64 @@
 #include "ariel.h"
 #include <string.h>
+#include <jack/midiport.h>
+
+// Gather this cycle's MIDI; the event data stays in JACK's port buffer,
+// which is valid until the cycle ends
+static void
+ariel_jack_collect_midi(ArielAudioEngine *engine, jack_nframes_t nframes)
+{
+    engine->n_midi_events = 0;
+    if (!engine->midi_input_port) {
+        return;
+    }
+
+    void *buffer = jack_port_get_buffer(engine->midi_input_port, nframes);
+    if (!buffer) {
+        return;
+    }
+
+    uint32_t n_events = jack_midi_get_event_count(buffer);
+    for (uint32_t i = 0; i < n_events; i++) {
+        jack_midi_event_t event;
+        if (jack_midi_event_get(&event, buffer, i) != 0) {
+            continue;
+        }
+
+        ArielMidiEvent midi_event = {
+            .time = event.time,
+            .size = (uint32_t)event.size,
+            .data = event.buffer,
+        };
+        ariel_audio_engine_receive_midi(engine, &midi_event);
+    }
+}
+
+// Read the transport once per cycle; plugins get a new time:Position only
+// when it changed
+static void
+ariel_jack_query_transport(ArielAudioEngine *engine, jack_nframes_t nframes)
+{
+    jack_position_t jack_position;
+    jack_transport_state_t state = jack_transport_query(engine->client, &jack_position);
+
+    ArielTimePosition position = {
+        .rolling = state == JackTransportRolling,
+        .has_bbt = (jack_position.valid & JackPositionBBT) != 0,
+        .frame = jack_position.frame,
+    };
+
+    if (position.has_bbt) {
+        double tick = jack_position.ticks_per_beat > 0.0 ?
+            jack_position.tick / jack_position.ticks_per_beat : 0.0;
+        position.bar = jack_position.bar - 1;
+        position.bar_beat = (float)(jack_position.beat - 1 + tick);
+        position.beats_per_bar = jack_position.beats_per_bar;
+        position.beat_unit = (int32_t)jack_position.beat_type;
+        position.beats_per_minute = (float)jack_position.beats_per_minute;
+    }
+
+    ariel_audio_engine_update_position(engine, &position, nframes);
+}
 
 int
 ariel_jack_process_callback(jack_nframes_t nframes, void *arg)
@@ -31,87 +90,76 @@ ariel_jack_process_callback(jack_nframes_t nframes, void *arg)
         return 1; // Can't proceed without output buffers
     }
     
+    // Pick up chain changes at the cycle boundary
+    ariel_audio_engine_process_commands(engine);
+    
+    // MIDI for this cycle; plugins read it while the chain runs
+    ariel_jack_collect_midi(engine, nframes);
+    ariel_jack_query_transport(engine, nframes);
+    
     // Process worker responses (must be done in audio thread context)
     if (engine->plugin_manager && engine->plugin_manager->worker_schedule) {
         ariel_worker_process_responses(engine->plugin_manager->worker_schedule);
     }
     
     // Process active plugins in chain
-    if (engine->plugin_manager && engine->plugin_manager->active_plugin_store) {
-        guint n_active = g_list_model_get_n_items(G_LIST_MODEL(engine->plugin_manager->active_plugin_store));
+    ArielProcessChain *chain = engine->chain;
+    if (chain && (chain->n_plugins > 0 || engine->fade_chain) && nframes <= 8192) {
+        // Create temporary buffers for plugin chaining
+        static float temp_buffer_L[8192];
+        static float temp_buffer_R[8192];
         
-        if (n_active > 0) {
-            // Create temporary buffers for plugin chaining
-            static float temp_buffer_L[8192];
-            static float temp_buffer_R[8192];
-            
-            // Initialize with input
-            if (input_L) memcpy(temp_buffer_L, input_L, sizeof(float) * nframes);
-            else memset(temp_buffer_L, 0, sizeof(float) * nframes);
-            
-            if (input_R) memcpy(temp_buffer_R, input_R, sizeof(float) * nframes);
-            else memset(temp_buffer_R, 0, sizeof(float) * nframes);
-            
-            float *current_L = temp_buffer_L;
-            float *current_R = temp_buffer_R;
-            
-            // Process each active plugin in series
-            for (guint i = 0; i < n_active; i++) {
-                ArielActivePlugin *plugin = g_list_model_get_item(
-                    G_LIST_MODEL(engine->plugin_manager->active_plugin_store), i);
-                
-                if (plugin && ariel_active_plugin_is_active(plugin)) {
-                    // Connect current buffers as input and output for in-place processing
-                    float *input_buffers[2] = { current_L, current_R };
-                    float *output_buffers[2] = { current_L, current_R };
-                    
-                    ariel_active_plugin_connect_audio_ports(plugin, input_buffers, output_buffers);
-                    
-                    // Process this plugin
-                    ariel_active_plugin_process(plugin, nframes);
-                    
-                    // For mono plugins, copy mono output to both channels
-                    if (ariel_active_plugin_is_mono(plugin)) {
-                        // Mono plugin - duplicate output to right channel
-                        memcpy(current_R, current_L, sizeof(float) * nframes);
-                    }
-                }
-                
-                if (plugin) g_object_unref(plugin);
-            }
-            
-            // Copy final result to output
-            if (output_L) memcpy(output_L, current_L, sizeof(float) * nframes);
-            if (output_R) memcpy(output_R, current_R, sizeof(float) * nframes);
-        } else {
-            // No active plugins, pass through input to output
-            if (input_L && output_L) {
-                memcpy(output_L, input_L, sizeof(jack_default_audio_sample_t) * nframes);
-            } else if (output_L) {
-                memset(output_L, 0, sizeof(jack_default_audio_sample_t) * nframes);
-            }
-            
-            if (input_R && output_R) {
-                memcpy(output_R, input_R, sizeof(jack_default_audio_sample_t) * nframes);
-            } else if (output_R) {
-                memset(output_R, 0, sizeof(jack_default_audio_sample_t) * nframes);
-            }
+        // Initialize with input
+        if (input_L) ariel_dsp_copy(temp_buffer_L, input_L, nframes);
+        else ariel_dsp_fill(temp_buffer_L, 0.0f, nframes);
+        
+        if (input_R) ariel_dsp_copy(temp_buffer_R, input_R, nframes);
+        else ariel_dsp_fill(temp_buffer_R, 0.0f, nframes);
+        
+        // A playing file replaces or joins the input
+        if (engine->player) {
+            ariel_file_player_read(engine->player, temp_buffer_L, temp_buffer_R, nframes);
         }
+        
+        // Process each active plugin in series
+        ariel_audio_engine_process_chain(engine, temp_buffer_L, temp_buffer_R, nframes);
+        
+        // A plugin that blew up must not reach the speakers
+        ariel_dsp_scrub(temp_buffer_L, nframes);
+        ariel_dsp_scrub(temp_buffer_R, nframes);
+        
+        // Copy final result to output
+        ariel_dsp_copy(output_L, temp_buffer_L, nframes);
+        ariel_dsp_copy(output_R, temp_buffer_R, nframes);
     } else {
-        // No plugin manager, pass through input to output
-        if (input_L && output_L) {
-            memcpy(output_L, input_L, sizeof(jack_default_audio_sample_t) * nframes);
-        } else if (output_L) {
-            memset(output_L, 0, sizeof(jack_default_audio_sample_t) * nframes);
+        // No active plugins, pass through input to output
+        if (input_L) {
+            ariel_dsp_copy(output_L, input_L, nframes);
+        } else {
+            ariel_dsp_fill(output_L, 0.0f, nframes);
+        }
+        
+        if (input_R) {
+            ariel_dsp_copy(output_R, input_R, nframes);
+        } else {
+            ariel_dsp_fill(output_R, 0.0f, nframes);
         }
         
-        if (input_R && output_R) {
-            memcpy(output_R, input_R, sizeof(jack_default_audio_sample_t) * nframes);
-        } else if (output_R) {
-            memset(output_R, 0, sizeof(jack_default_audio_sample_t) * nframes);
+        if (engine->player) {
+            ariel_file_player_read(engine->player, output_L, output_R, nframes);
         }
     }
     
+    ariel_meter_update(&engine->master_meter, output_L, output_R, nframes);
+    
+    // Dry input and processed output, for the writer thread to save
+    if (engine->recorder) {
+        ariel_recorder_write(engine->recorder, input_L, input_R, output_L, output_R, nframes);
+    }
+    if (engine->capture) {
+        ariel_capture_write(engine->capture, input_L, input_R, output_L, output_R, nframes);
+    }
+    
     return 0;
 }
 
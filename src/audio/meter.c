@@ -0,0 +1,49 @@
+#include "ariel.h"
+
+// Level meters.
+//
+// The audio thread measures peak and RMS with the buffer kernels after
+// each chain slot and on the final output, and publishes them as atomic
+// floats. The peak is the largest since the UI last took it, so no
+// overload between two frames is missed; the RMS is the last block's,
+// and the UI smooths it. Nothing here waits: the only other writer is
+// the UI taking the peak, so either compare-and-swap loop retries at
+// most once or twice.
+
+static void
+ariel_meter_raise_peak(gint *atomic, float peak)
+{
+    union { float f; gint i; } bits = { .f = peak };
+    gint old = g_atomic_int_get(atomic);
+
+    while (ariel_atomic_float_get(&old) < peak &&
+           !g_atomic_int_compare_and_exchange(atomic, old, bits.i)) {
+        old = g_atomic_int_get(atomic);
+    }
+}
+
+// Measure one block (audio thread)
+void
+ariel_meter_update(ArielMeter *meter, const float *L, const float *R, guint nframes)
+{
+    const float *channels[2] = { L, R };
+
+    for (guint c = 0; c < 2; c++) {
+        ariel_meter_raise_peak(&meter->peak[c], ariel_dsp_peak(channels[c], nframes));
+        ariel_atomic_float_set(&meter->rms[c], ariel_dsp_rms(channels[c], nframes));
+    }
+}
+
+// Read the levels and restart the peak (UI thread)
+void
+ariel_meter_take(ArielMeter *meter, float peak[2], float rms[2])
+{
+    for (guint c = 0; c < 2; c++) {
+        gint old = g_atomic_int_get(&meter->peak[c]);
+        while (!g_atomic_int_compare_and_exchange(&meter->peak[c], old, 0)) {
+            old = g_atomic_int_get(&meter->peak[c]);
+        }
+        peak[c] = ariel_atomic_float_get(&old);
+        rms[c] = ariel_atomic_float_get(&meter->rms[c]);
+    }
+}
@@ -0,0 +1,418 @@
+#include "ariel.h"
+#include <math.h>
+
+// MIDI learn and Control Change mapping.
+//
+// The main thread keeps the list of mappings (channel, CC -> plugin,
+// control input, range, curve) and compiles it into a table sorted by CC,
+// which reaches the audio thread through the engine command ring like a
+// chain snapshot. The audio thread evaluates the table for each incoming
+// Control Change and writes straight into the plugins' control buffers,
+// the same lock-free path set_parameter uses. It only raises atomic flags
+// for the main thread, which refreshes widgets on its regular reclaim pass,
+// so a burst of controller moves costs the UI one update.
+//
+// Learning works the same way: the main thread arms the engine, and the
+// audio thread reports the first Control Change it sees.
+
+struct _ArielMidiMapper {
+    ArielPluginManager *manager;
+    GPtrArray *mappings;                 // ArielMidiMapping
+    ArielActivePlugin *learn_plugin;     // Waiting for a controller, holds a reference
+    guint learn_port;
+    ArielMidiMapChangedFunc changed_func;
+    gpointer changed_data;
+};
+
+static void
+ariel_midi_mapping_free(gpointer data)
+{
+    ArielMidiMapping *mapping = data;
+
+    g_object_unref(mapping->plugin);
+    g_free(mapping);
+}
+
+ArielMidiMapper *
+ariel_midi_mapper_new(ArielPluginManager *manager)
+{
+    ArielMidiMapper *mapper = g_malloc0(sizeof(ArielMidiMapper));
+    mapper->manager = manager;
+    mapper->mappings = g_ptr_array_new_with_free_func(ariel_midi_mapping_free);
+    return mapper;
+}
+
+void
+ariel_midi_mapper_free(ArielMidiMapper *mapper)
+{
+    if (!mapper) return;
+
+    g_ptr_array_free(mapper->mappings, TRUE);
+    g_clear_object(&mapper->learn_plugin);
+    g_free(mapper);
+}
+
+// Called on the main thread after controllers moved mapped controls
+// (mappings_changed FALSE), or after a mapping was learned or dropped
+void
+ariel_midi_mapper_set_changed_func(ArielMidiMapper *mapper, ArielMidiMapChangedFunc func, gpointer user_data)
+{
+    g_return_if_fail(mapper != NULL);
+
+    mapper->changed_func = func;
+    mapper->changed_data = user_data;
+}
+
+static void
+ariel_midi_mapper_notify(ArielMidiMapper *mapper, gboolean mappings_changed)
+{
+    if (mapper->changed_func) {
+        mapper->changed_func(mappings_changed, mapper->changed_data);
+    }
+}
+
+const ArielMidiMapping *
+ariel_midi_mapper_lookup(ArielMidiMapper *mapper, ArielActivePlugin *plugin, guint port)
+{
+    for (guint i = 0; mapper && i < mapper->mappings->len; i++) {
+        ArielMidiMapping *mapping = g_ptr_array_index(mapper->mappings, i);
+        if (mapping->plugin == plugin && mapping->port == port) {
+            return mapping;
+        }
+    }
+    return NULL;
+}
+
+gboolean
+ariel_midi_mapper_is_learning(ArielMidiMapper *mapper, ArielActivePlugin *plugin, guint port)
+{
+    return mapper && mapper->learn_plugin == plugin && mapper->learn_port == port;
+}
+
+void
+ariel_midi_map_free(ArielMidiMap *map)
+{
+    if (!map) return;
+
+    for (guint i = 0; i < map->n_plugins; i++) {
+        g_object_unref(map->plugins[i]);
+    }
+    g_free(map->plugins);
+    g_free(map->entries);
+    g_free(map);
+}
+
+// Compile the mappings whose plugin is in the chain into a table sorted by
+// CC. Mappings for plugins that left the chain are dropped.
+static ArielMidiMap *
+ariel_midi_mapper_compile(ArielMidiMapper *mapper)
+{
+    GListStore *store = mapper->manager->active_plugin_store;
+
+    for (guint i = mapper->mappings->len; i > 0; i--) {
+        ArielMidiMapping *mapping = g_ptr_array_index(mapper->mappings, i - 1);
+        if (!g_list_store_find(store, mapping->plugin, NULL)) {
+            g_ptr_array_remove_index(mapper->mappings, i - 1);
+        }
+    }
+
+    guint n_entries = mapper->mappings->len;
+    ArielMidiMap *map = g_malloc0(sizeof(ArielMidiMap));
+    map->n_entries = n_entries;
+    map->entries = g_new0(ArielMidiMapEntry, MAX(n_entries, 1));
+    map->plugins = g_new0(ArielActivePlugin *, MAX(n_entries, 1));
+
+    // Counting sort by CC; first[] ends up as each CC's start
+    guint counts[128] = { 0 };
+    for (guint i = 0; i < n_entries; i++) {
+        ArielMidiMapping *mapping = g_ptr_array_index(mapper->mappings, i);
+        counts[mapping->cc & 0x7F]++;
+    }
+    map->first[0] = 0;
+    for (guint cc = 0; cc < 128; cc++) {
+        map->first[cc + 1] = (guint16)(map->first[cc] + counts[cc]);
+    }
+
+    guint cursor[128];
+    for (guint cc = 0; cc < 128; cc++) {
+        cursor[cc] = map->first[cc];
+    }
+
+    for (guint i = 0; i < n_entries; i++) {
+        ArielMidiMapping *mapping = g_ptr_array_index(mapper->mappings, i);
+        ArielMidiMapEntry *entry = &map->entries[cursor[mapping->cc & 0x7F]++];
+
+        entry->channel = mapping->channel;
+        entry->curve = mapping->curve;
+        entry->min = mapping->min;
+        entry->max = mapping->max;
+        entry->target = ariel_active_plugin_get_control_inputs(mapping->plugin) + mapping->port;
+
+        // A log curve needs a positive range
+        if (entry->curve == ARIEL_CONTROL_LOGARITHMIC && (entry->min <= 0.0f || entry->max <= 0.0f)) {
+            entry->curve = ARIEL_CONTROL_LINEAR;
+        }
+
+        // Keep each distinct plugin alive while the table may write to it
+        gboolean seen = FALSE;
+        for (guint j = 0; j < map->n_plugins && !seen; j++) {
+            seen = map->plugins[j] == mapping->plugin;
+        }
+        if (!seen) {
+            map->plugins[map->n_plugins++] = g_object_ref(mapping->plugin);
+        }
+    }
+
+    return map;
+}
+
+// Hand the current mappings to the audio thread
+void
+ariel_midi_mapper_publish(ArielMidiMapper *mapper, ArielAudioEngine *engine)
+{
+    if (!mapper || !engine || !engine->command_ring) return;
+
+    ArielEngineCommand command = {
+        .type = ARIEL_ENGINE_COMMAND_SET_MIDI_MAP,
+        .midi_map = ariel_midi_mapper_compile(mapper),
+    };
+    ariel_audio_engine_send_command(engine, &command);
+}
+
+// Map a controller to a control input, replacing the control's old mapping
+static void
+ariel_midi_mapper_put(ArielMidiMapper *mapper, guint8 channel, guint8 cc, ArielActivePlugin *plugin,
+                      guint port, float min, float max, ArielControlKind curve)
+{
+    ArielMidiMapping *mapping = (ArielMidiMapping *)ariel_midi_mapper_lookup(mapper, plugin, port);
+
+    if (!mapping) {
+        mapping = g_malloc0(sizeof(ArielMidiMapping));
+        mapping->plugin = g_object_ref(plugin);
+        mapping->port = port;
+        g_ptr_array_add(mapper->mappings, mapping);
+    }
+
+    mapping->channel = channel;
+    mapping->cc = cc & 0x7F;
+    mapping->min = min;
+    mapping->max = max;
+    mapping->curve = curve;
+}
+
+// Wait for the next Control Change and map it to this control input
+void
+ariel_midi_mapper_learn(ArielMidiMapper *mapper, ArielAudioEngine *engine, ArielActivePlugin *plugin, guint port)
+{
+    g_return_if_fail(mapper != NULL && engine != NULL && plugin != NULL);
+
+    g_set_object(&mapper->learn_plugin, plugin);
+    mapper->learn_port = port;
+
+    g_atomic_int_set(&engine->midi_learned, 0);
+    g_atomic_int_set(&engine->midi_learn, 1);
+    g_print("MIDI learn: move a controller for %s control %u\n", ariel_active_plugin_get_name(plugin), port);
+}
+
+void
+ariel_midi_mapper_cancel_learn(ArielMidiMapper *mapper, ArielAudioEngine *engine)
+{
+    if (!mapper) return;
+
+    if (engine) {
+        g_atomic_int_set(&engine->midi_learn, 0);
+        g_atomic_int_set(&engine->midi_learned, 0);
+    }
+    g_clear_object(&mapper->learn_plugin);
+}
+
+void
+ariel_midi_mapper_forget(ArielMidiMapper *mapper, ArielAudioEngine *engine, ArielActivePlugin *plugin, guint port)
+{
+    const ArielMidiMapping *mapping = ariel_midi_mapper_lookup(mapper, plugin, port);
+    if (!mapping) return;
+
+    g_ptr_array_remove(mapper->mappings, (gpointer)mapping);
+    ariel_midi_mapper_publish(mapper, engine);
+    ariel_midi_mapper_notify(mapper, TRUE);
+}
+
+// Move mappings to a plugin that takes another's place in the chain
+void
+ariel_midi_mapper_replace_plugin(ArielMidiMapper *mapper, ArielActivePlugin *old_plugin,
+                                 ArielActivePlugin *new_plugin)
+{
+    for (guint i = 0; mapper && i < mapper->mappings->len; i++) {
+        ArielMidiMapping *mapping = g_ptr_array_index(mapper->mappings, i);
+        if (mapping->plugin == old_plugin) {
+            g_set_object(&mapping->plugin, new_plugin);
+        }
+    }
+}
+
+// Pick up what the audio thread reported since the last pass (main thread)
+void
+ariel_midi_mapper_dispatch(ArielMidiMapper *mapper, ArielAudioEngine *engine)
+{
+    if (!mapper || !engine) return;
+
+    gint learned = g_atomic_int_get(&engine->midi_learned);
+    if (learned > 0 && g_atomic_int_compare_and_exchange(&engine->midi_learned, learned, 0) &&
+        mapper->learn_plugin) {
+        guint8 channel = (guint8)((learned - 1) >> 8);
+        guint8 cc = (guint8)((learned - 1) & 0x7F);
+        ArielActivePlugin *plugin = mapper->learn_plugin;
+        guint port = mapper->learn_port;
+        float min = 0.0f;
+        float max = 1.0f;
+
+        ariel_active_plugin_get_control_range(plugin, port, &min, &max);
+        ariel_midi_mapper_put(mapper, channel, cc, plugin, port, min, max,
+                              ariel_active_plugin_get_control_kind(plugin, port));
+        g_print("Mapped MIDI CC %u on channel %u to %s control %u\n", cc, channel + 1,
+                ariel_active_plugin_get_name(plugin), port);
+
+        g_clear_object(&mapper->learn_plugin);
+        ariel_midi_mapper_publish(mapper, engine);
+        ariel_midi_mapper_notify(mapper, TRUE);
+    }
+
+    if (g_atomic_int_get(&engine->midi_values_changed) &&
+        g_atomic_int_compare_and_exchange(&engine->midi_values_changed, 1, 0)) {
+        ariel_midi_mapper_notify(mapper, FALSE);
+    }
+}
+
+// Apply one Control Change through the table. Runs on the audio thread, so
+// it must not allocate, lock or print. Returns whether a control moved.
+gboolean
+ariel_midi_map_apply(const ArielMidiMap *map, guint8 channel, guint8 cc, guint8 value)
+{
+    float position = (float)(value & 0x7F) / 127.0f;
+    gboolean applied = FALSE;
+
+    cc &= 0x7F;
+    for (guint i = map->first[cc]; i < map->first[cc + 1]; i++) {
+        const ArielMidiMapEntry *entry = &map->entries[i];
+
+        if (entry->channel != ARIEL_MIDI_OMNI && entry->channel != channel) {
+            continue;
+        }
+
+        switch (entry->curve) {
+        case ARIEL_CONTROL_LOGARITHMIC:
+            *entry->target = entry->min * powf(entry->max / entry->min, position);
+            break;
+        case ARIEL_CONTROL_STEPPED:
+            *entry->target = roundf(entry->min + (entry->max - entry->min) * position);
+            break;
+        default:
+            *entry->target = entry->min + (entry->max - entry->min) * position;
+            break;
+        }
+        applied = TRUE;
+    }
+
+    return applied;
+}
+
+static const char *
+ariel_midi_curve_to_string(ArielControlKind curve)
+{
+    switch (curve) {
+    case ARIEL_CONTROL_LOGARITHMIC:
+        return "log";
+    case ARIEL_CONTROL_STEPPED:
+        return "stepped";
+    default:
+        return "linear";
+    }
+}
+
+static ArielControlKind
+ariel_midi_curve_from_string(const char *curve)
+{
+    if (g_strcmp0(curve, "log") == 0) {
+        return ARIEL_CONTROL_LOGARITHMIC;
+    }
+    if (g_strcmp0(curve, "stepped") == 0) {
+        return ARIEL_CONTROL_STEPPED;
+    }
+    return ARIEL_CONTROL_LINEAR;
+}
+
+// Store the mappings as [midi_N] groups of a chain preset, with plugins by
+// chain position. Channels are 1-16, or 0 for any.
+void
+ariel_midi_mapper_save_to_keyfile(ArielMidiMapper *mapper, GKeyFile *keyfile)
+{
+    if (!mapper) return;
+
+    GListStore *store = mapper->manager->active_plugin_store;
+    gint n_saved = 0;
+
+    for (guint i = 0; i < mapper->mappings->len; i++) {
+        ArielMidiMapping *mapping = g_ptr_array_index(mapper->mappings, i);
+        guint position = 0;
+
+        if (!g_list_store_find(store, mapping->plugin, &position)) {
+            continue;
+        }
+
+        char *group = g_strdup_printf("midi_%d", n_saved++);
+        g_key_file_set_integer(keyfile, group, "channel",
+                               mapping->channel == ARIEL_MIDI_OMNI ? 0 : mapping->channel + 1);
+        g_key_file_set_integer(keyfile, group, "cc", mapping->cc);
+        g_key_file_set_integer(keyfile, group, "plugin", (gint)position);
+        g_key_file_set_integer(keyfile, group, "port", (gint)mapping->port);
+        g_key_file_set_double(keyfile, group, "min", mapping->min);
+        g_key_file_set_double(keyfile, group, "max", mapping->max);
+        g_key_file_set_string(keyfile, group, "curve", ariel_midi_curve_to_string(mapping->curve));
+        g_free(group);
+    }
+
+    g_key_file_set_integer(keyfile, "chain", "midi_map_count", n_saved);
+}
+
+// Replace the mappings with those of a chain preset whose plugins are now
+// in the chain, and hand them to the audio thread
+void
+ariel_midi_mapper_load_from_keyfile(ArielMidiMapper *mapper, ArielAudioEngine *engine, GKeyFile *keyfile)
+{
+    if (!mapper) return;
+
+    GListModel *model = G_LIST_MODEL(mapper->manager->active_plugin_store);
+    guint n_plugins = g_list_model_get_n_items(model);
+    gint n_mappings = g_key_file_get_integer(keyfile, "chain", "midi_map_count", NULL);
+
+    g_ptr_array_set_size(mapper->mappings, 0);
+
+    for (gint i = 0; i < n_mappings; i++) {
+        char *group = g_strdup_printf("midi_%d", i);
+        gint channel = g_key_file_get_integer(keyfile, group, "channel", NULL);
+        gint cc = g_key_file_get_integer(keyfile, group, "cc", NULL);
+        gint position = g_key_file_get_integer(keyfile, group, "plugin", NULL);
+        gint port = g_key_file_get_integer(keyfile, group, "port", NULL);
+        char *curve = g_key_file_get_string(keyfile, group, "curve", NULL);
+
+        if (g_key_file_has_group(keyfile, group) && channel >= 0 && channel <= 16 &&
+            cc >= 0 && cc < 128 && position >= 0 && (guint)position < n_plugins && port >= 0) {
+            ArielActivePlugin *plugin = g_list_model_get_item(model, (guint)position);
+
+            if ((guint)port < ariel_active_plugin_get_num_parameters(plugin)) {
+                ariel_midi_mapper_put(mapper, channel == 0 ? ARIEL_MIDI_OMNI : (guint8)(channel - 1),
+                                      (guint8)cc, plugin, (guint)port,
+                                      (float)g_key_file_get_double(keyfile, group, "min", NULL),
+                                      (float)g_key_file_get_double(keyfile, group, "max", NULL),
+                                      ariel_midi_curve_from_string(curve));
+            }
+            g_object_unref(plugin);
+        }
+
+        g_free(curve);
+        g_free(group);
+    }
+
+    ariel_midi_mapper_publish(mapper, engine);
+    ariel_midi_mapper_notify(mapper, TRUE);
+}
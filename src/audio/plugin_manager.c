@@ -363,44 +363,7 @@ ariel_worker_process_responses(ArielWorkerSchedule *worker)
     g_mutex_unlock(&worker->response_mutex);
 }
 
-// LV2 State interface implementation
-static LV2_State_Status
-ariel_state_store(LV2_State_Handle handle,
-                 uint32_t key,
-                 const void* value,
-                 size_t size,
-                 uint32_t type,
-                 uint32_t flags)
-{
-    ArielPluginManager *manager = (ArielPluginManager *)handle;
-    if (!manager || !value) return LV2_STATE_ERR_UNKNOWN;
-    
-    // For now, just log state store requests
-    // In a full implementation, we'd store this in the plugin's state
-    g_print("Plugin state store: key=%u, size=%zu, type=%u, flags=%u\n", 
-            key, size, type, flags);
-    return LV2_STATE_SUCCESS;
-}
-
-static const void*
-ariel_state_retrieve(LV2_State_Handle handle,
-                    uint32_t key,
-                    size_t* size,
-                    uint32_t* type,
-                    uint32_t* flags)
-{
-    ArielPluginManager *manager = (ArielPluginManager *)handle;
-    if (!manager) return NULL;
-    
-    // For now, return NULL (no stored state)
-    // In a full implementation, we'd retrieve from plugin's stored state
-    g_print("Plugin state retrieve: key=%u\n", key);
-    if (size) *size = 0;
-    if (type) *type = 0;
-    if (flags) *flags = 0;
-    return NULL;
-}
-
+// LV2 State path features
 static char*
 ariel_state_make_path(LV2_State_Handle handle, const char* path)
 {
@@ -446,6 +409,7 @@ ariel_urid_map_new(void)
     }
     
     map->next_id = 1; // Start from 1, as 0 is reserved for "no value"
+    g_mutex_init(&map->lock);
     ARIEL_INFO("URID map created successfully");
     return map;
 }
@@ -457,6 +421,7 @@ ariel_urid_map_free(ArielURIDMap *map)
     
     g_hash_table_destroy(map->uri_to_id);
     g_hash_table_destroy(map->id_to_uri);
+    g_mutex_clear(&map->lock);
     g_free(map);
 }
 
@@ -466,9 +431,12 @@ ariel_urid_map(LV2_URID_Map_Handle handle, const char *uri)
     ArielURIDMap *map = (ArielURIDMap *)handle;
     if (!map || !uri) return 0;
     
+    g_mutex_lock(&map->lock);
+    
     // Check if URI already exists
     gpointer existing_id = g_hash_table_lookup(map->uri_to_id, uri);
     if (existing_id) {
+        g_mutex_unlock(&map->lock);
         return GPOINTER_TO_UINT(existing_id);
     }
     
@@ -480,6 +448,8 @@ ariel_urid_map(LV2_URID_Map_Handle handle, const char *uri)
     g_hash_table_insert(map->uri_to_id, uri_copy, GUINT_TO_POINTER(new_id));
     g_hash_table_insert(map->id_to_uri, GUINT_TO_POINTER(new_id), uri_copy2);
     
+    g_mutex_unlock(&map->lock);
+    
     g_print("URID Map: %s -> %u\n", uri, new_id);
     return new_id;
 }
@@ -490,7 +460,11 @@ ariel_urid_unmap(LV2_URID_Unmap_Handle handle, LV2_URID urid)
     ArielURIDMap *map = (ArielURIDMap *)handle;
     if (!map || urid == 0) return NULL;
     
-    return (const char *)g_hash_table_lookup(map->id_to_uri, GUINT_TO_POINTER(urid));
+    // Mapped strings are never freed before the map, so the pointer stays valid
+    g_mutex_lock(&map->lock);
+    const char *uri = g_hash_table_lookup(map->id_to_uri, GUINT_TO_POINTER(urid));
+    g_mutex_unlock(&map->lock);
+    return uri;
 }
 
 // LV2 Atom Path support functions
@@ -501,63 +475,55 @@ ariel_get_atom_path_urid(ArielPluginManager *manager)
     return ariel_urid_map(manager->urid_map, LV2_ATOM__Path);
 }
 
-// Map absolute path to plugin-accessible path
+// mapPath, abstract -> absolute: abstract paths are relative to plugin_state/
 char *
-ariel_map_absolute_path(LV2_State_Handle handle, const char *absolute_path)
+ariel_map_absolute_path(LV2_State_Handle handle, const char *abstract_path)
 {
     ArielPluginManager *manager = (ArielPluginManager *)handle;
-    if (!manager || !absolute_path) return NULL;
-    
-    // Create plugin-accessible path within state directory
-    ArielConfig *config = manager->config;
-    const char *config_dir = ariel_config_get_dir(config);
-    char *state_dir = g_build_filename(config_dir, "plugin_state", NULL);
-    
-    // Generate safe filename from absolute path
-    char *basename = g_path_get_basename(absolute_path);
-    char *safe_path = g_build_filename(state_dir, basename, NULL);
+    if (!manager || !abstract_path) return NULL;
     
-    // Copy file to state directory if it doesn't exist
-    if (!g_file_test(safe_path, G_FILE_TEST_EXISTS) && g_file_test(absolute_path, G_FILE_TEST_EXISTS)) {
-        GError *error = NULL;
-        GFile *source = g_file_new_for_path(absolute_path);
-        GFile *dest = g_file_new_for_path(safe_path);
-        
-        if (!g_file_copy(source, dest, G_FILE_COPY_NONE, NULL, NULL, NULL, &error)) {
-            g_warning("Failed to copy file %s to %s: %s", absolute_path, safe_path, error->message);
-            g_error_free(error);
-            g_free(safe_path);
-            safe_path = NULL;
-        } else {
-            g_print("Mapped absolute path: %s -> %s\n", absolute_path, safe_path);
-        }
-        
-        g_object_unref(source);
-        g_object_unref(dest);
+    // Files that could not be copied in were kept absolute
+    if (g_path_is_absolute(abstract_path)) {
+        return g_strdup(abstract_path);
     }
     
-    g_free(basename);
-    g_free(state_dir);
-    return safe_path;
+    const char *config_dir = ariel_config_get_dir(manager->config);
+    char *absolute_path = g_build_filename(config_dir, "plugin_state", abstract_path, NULL);
+    
+    g_print("Mapped abstract path: %s -> %s\n", abstract_path, absolute_path);
+    return absolute_path;
 }
 
-// Map abstract path to absolute path
+// mapPath, absolute -> abstract. Files outside plugin_state/ go into the
+// content-addressed store, so saved state keeps working when the original
+// file moves, without duplicating it for every preset.
 char *
-ariel_map_abstract_path(LV2_State_Handle handle, const char *abstract_path)
+ariel_map_abstract_path(LV2_State_Handle handle, const char *absolute_path)
 {
     ArielPluginManager *manager = (ArielPluginManager *)handle;
-    if (!manager || !abstract_path) return NULL;
+    if (!manager || !absolute_path) return NULL;
     
-    // Convert abstract path to absolute path within state directory
-    ArielConfig *config = manager->config;
-    const char *config_dir = ariel_config_get_dir(config);
+    const char *config_dir = ariel_config_get_dir(manager->config);
     char *state_dir = g_build_filename(config_dir, "plugin_state", NULL);
-    char *absolute_path = g_build_filename(state_dir, abstract_path, NULL);
+    char *state_prefix = g_strconcat(state_dir, G_DIR_SEPARATOR_S, NULL);
+    gboolean in_state_dir = g_str_has_prefix(absolute_path, state_prefix);
+    g_free(state_dir);
     
-    g_print("Mapped abstract path: %s -> %s\n", abstract_path, absolute_path);
+    if (in_state_dir) {
+        char *abstract_path = g_strdup(absolute_path + strlen(state_prefix));
+        g_free(state_prefix);
+        return abstract_path;
+    }
+    g_free(state_prefix);
     
-    g_free(state_dir);
-    return absolute_path;
+    char *abstract_path = ariel_state_store_add(config_dir, absolute_path);
+    if (!abstract_path) {
+        // Keep the absolute path rather than lose the reference
+        g_warning("Could not store %s; saving its absolute path", absolute_path);
+        abstract_path = g_strdup(absolute_path);
+    }
+    
+    return abstract_path;
 }
 
 // Create LV2 feature array
@@ -913,13 +879,34 @@ ariel_plugin_manager_new(void)
         // Continue anyway - this is not fatal
     }
     
+    // Index every discovered plugin by URI once, so lookups never build lilv nodes
+    manager->lilv_index = g_hash_table_new(g_str_hash, g_str_equal);
+    if (manager->plugins) {
+        LILV_FOREACH(plugins, iter, manager->plugins) {
+            const LilvPlugin *plugin = lilv_plugins_get(manager->plugins, iter);
+            const char *uri = lilv_node_as_uri(lilv_plugin_get_uri(plugin));
+            if (uri) {
+                g_hash_table_insert(manager->lilv_index, (gpointer)uri, (gpointer)plugin);
+            }
+        }
+    }
+    
     // Create list stores for UI
     manager->plugin_store = g_list_store_new(ARIEL_TYPE_PLUGIN_INFO);
     manager->active_plugin_store = g_list_store_new(ARIEL_TYPE_ACTIVE_PLUGIN);
+    manager->plugin_index = g_hash_table_new(g_str_hash, g_str_equal);
     
     // Initialize features as NULL - will be created when needed with engine reference
     manager->features = NULL;
     
+    // Recently removed instances, kept warm for quick re-insertion
+    manager->plugin_pool = ariel_plugin_pool_new(ARIEL_PLUGIN_POOL_BUDGET);
+    
+    // Usage history drives the startup prewarm
+    manager->usage = ariel_plugin_usage_new(ariel_config_get_dir(manager->config));
+    manager->scenes = ariel_scene_bank_new();
+    manager->midi_mapper = ariel_midi_mapper_new(manager);
+    
     // Try to load from cache first, otherwise refresh
     if (!ariel_plugin_manager_load_cache(manager)) {
         g_print("No valid cache found, scanning plugins...\n");
@@ -929,15 +916,41 @@ ariel_plugin_manager_new(void)
         g_print("Loaded plugins from cache\n");
     }
     
+    // Warm the page cache for the plugins used most
+    ariel_plugin_manager_prewarm(manager);
+    
     return manager;
 }
 
+// Keys and values are borrowed from the store, so add after appending
+static void
+ariel_plugin_manager_index_plugin(ArielPluginManager *manager, ArielPluginInfo *info)
+{
+    const char *uri = ariel_plugin_info_get_uri(info);
+    if (uri) {
+        g_hash_table_insert(manager->plugin_index, (gpointer)uri, info);
+    }
+}
+
+// Look up a discovered plugin by URI in O(1). The result is owned by the
+// plugin store; take a reference to keep it past a refresh.
+ArielPluginInfo *
+ariel_plugin_manager_find_plugin(ArielPluginManager *manager, const char *uri)
+{
+    if (!manager || !manager->plugin_index || !uri) {
+        return NULL;
+    }
+    
+    return g_hash_table_lookup(manager->plugin_index, uri);
+}
+
 void
 ariel_plugin_manager_refresh(ArielPluginManager *manager)
 {
     if (!manager || !manager->world) return;
     
-    // Clear existing store
+    // Clear existing store (the index borrows from it, so drop that first)
+    g_hash_table_remove_all(manager->plugin_index);
     g_list_store_remove_all(manager->plugin_store);
     
     // Iterate through all LV2 plugins
@@ -947,6 +960,7 @@ ariel_plugin_manager_refresh(ArielPluginManager *manager)
         // Create plugin info object and add to store
         ArielPluginInfo *info = ariel_plugin_info_new(plugin);
         g_list_store_append(manager->plugin_store, info);
+        ariel_plugin_manager_index_plugin(manager, info);
         
         g_print("Found LV2 plugin: %s by %s\n", 
                 ariel_plugin_info_get_name(info),
@@ -993,7 +1007,8 @@ ariel_plugin_manager_load_cache(ArielPluginManager *manager)
     gsize n_groups;
     gchar **groups = g_key_file_get_groups(keyfile, &n_groups);
     
-    // Clear existing store
+    // Clear existing store (the index borrows from it, so drop that first)
+    g_hash_table_remove_all(manager->plugin_index);
     g_list_store_remove_all(manager->plugin_store);
     
     guint loaded_count = 0;
@@ -1006,13 +1021,12 @@ ariel_plugin_manager_load_cache(ArielPluginManager *manager)
         if (!uri) continue;
         
         // Find the actual plugin in lilv world
-        LilvNode *uri_node = lilv_new_uri(manager->world, uri);
-        const LilvPlugin *plugin = lilv_plugins_get_by_uri(manager->plugins, uri_node);
-        lilv_node_free(uri_node);
+        const LilvPlugin *plugin = g_hash_table_lookup(manager->lilv_index, uri);
         
         if (plugin) {
             ArielPluginInfo *info = ariel_plugin_info_new(plugin);
             g_list_store_append(manager->plugin_store, info);
+            ariel_plugin_manager_index_plugin(manager, info);
             g_object_unref(info);
             loaded_count++;
         }
@@ -1079,6 +1093,63 @@ ariel_plugin_manager_save_cache(ArielPluginManager *manager)
     g_key_file_free(keyfile);
 }
 
+// A pooled instance of plugin_info, reset to default parameters, or NULL
+static ArielActivePlugin *
+ariel_plugin_manager_take_pooled(ArielPluginManager *manager, ArielPluginInfo *plugin_info)
+{
+    if (!manager->plugin_pool) return NULL;
+    
+    ArielActivePlugin *plugin = ariel_plugin_pool_acquire(manager->plugin_pool,
+                                                          ariel_plugin_info_get_uri(plugin_info), 0, FALSE);
+    if (plugin) {
+        ArielSlotMix unity = ARIEL_SLOT_MIX_UNITY;
+        ariel_active_plugin_reset_parameters(plugin);
+        ariel_active_plugin_set_bypass(plugin, FALSE);
+        ariel_active_plugin_set_slot_mix(plugin, &unity);
+    }
+    return plugin;
+}
+
+// Remove a plugin from the chain, keeping its instance warm in the pool
+void
+ariel_plugin_manager_remove_plugin(ArielPluginManager *manager, ArielActivePlugin *plugin)
+{
+    g_return_if_fail(manager != NULL);
+    
+    guint position;
+    if (!g_list_store_find(manager->active_plugin_store, plugin, &position)) {
+        return;
+    }
+    
+    g_object_ref(plugin);
+    g_list_store_remove(manager->active_plugin_store, position);
+    if (manager->plugin_pool) {
+        ariel_plugin_pool_release(manager->plugin_pool, plugin);
+    }
+    g_object_unref(plugin);
+}
+
+// Remove every plugin from the chain, keeping the instances warm in the pool
+void
+ariel_plugin_manager_clear_plugins(ArielPluginManager *manager)
+{
+    g_return_if_fail(manager != NULL);
+    
+    GListModel *model = G_LIST_MODEL(manager->active_plugin_store);
+    guint n_items = g_list_model_get_n_items(model);
+    GPtrArray *removed = g_ptr_array_new_full(n_items, g_object_unref);
+    
+    for (guint i = 0; i < n_items; i++) {
+        g_ptr_array_add(removed, g_list_model_get_item(model, i));
+    }
+    g_list_store_remove_all(manager->active_plugin_store);
+    
+    for (guint i = 0; manager->plugin_pool && i < removed->len; i++) {
+        ariel_plugin_pool_release(manager->plugin_pool, g_ptr_array_index(removed, i));
+    }
+    g_ptr_array_free(removed, TRUE);
+}
+
 ArielActivePlugin *
 ariel_plugin_manager_load_plugin(ArielPluginManager *manager, ArielPluginInfo *plugin_info, ArielAudioEngine *engine)
 {
@@ -1087,11 +1158,18 @@ ariel_plugin_manager_load_plugin(ArielPluginManager *manager, ArielPluginInfo *p
         return NULL;
     }
     
-    // Create active plugin instance
-    ArielActivePlugin *active_plugin = ariel_active_plugin_new(plugin_info, engine);
+    // Reuse a warm instance if one was removed recently
+    ArielActivePlugin *active_plugin = ariel_plugin_manager_take_pooled(manager, plugin_info);
     if (!active_plugin) {
-        g_warning("Failed to create active plugin for %s", ariel_plugin_info_get_name(plugin_info));
-        return NULL;
+        // Create active plugin instance
+        active_plugin = ariel_active_plugin_new(plugin_info, engine);
+        if (!active_plugin) {
+            g_warning("Failed to create active plugin for %s", ariel_plugin_info_get_name(plugin_info));
+            return NULL;
+        }
+        
+        ariel_active_plugin_activate(active_plugin);
+        ariel_active_plugin_warm_up(active_plugin, ARIEL_WARM_UP_BLOCKS);
     }
     
     // Set plugin reference in worker schedule for this plugin
@@ -1099,22 +1177,154 @@ ariel_plugin_manager_load_plugin(ArielPluginManager *manager, ArielPluginInfo *p
         manager->worker_schedule->plugin = active_plugin;
     }
     
-    // Add to active plugins list
-    g_list_store_append(manager->active_plugin_store, active_plugin);
-    
-    // Activate the plugin
+    // Activate before the audio thread can see it
     ariel_active_plugin_activate(active_plugin);
     
+    // Add to active plugins list; the engine picks it up at the next cycle
+    g_list_store_append(manager->active_plugin_store, active_plugin);
+    ariel_plugin_usage_record(manager->usage, ariel_plugin_info_get_uri(plugin_info));
+    
     g_print("Loaded and activated plugin: %s\n", ariel_active_plugin_get_name(active_plugin));
     
     return active_plugin;
 }
 
+// Asynchronous plugin loading
+typedef struct {
+    ArielPluginManager *manager;
+    ArielActivePlugin *plugin;
+    char *uri;
+    ArielPluginLoadedFunc callback;
+    gpointer user_data;
+} ArielPluginLoad;
+
+static void
+ariel_plugin_load_free(ArielPluginLoad *load)
+{
+    g_clear_object(&load->plugin);
+    g_free(load->uri);
+    g_free(load);
+}
+
+// Loader thread: the slow part of loading, kept away from the UI and audio threads
+static void
+ariel_plugin_load_thread(GTask *task, G_GNUC_UNUSED gpointer source_object,
+                         gpointer task_data, G_GNUC_UNUSED GCancellable *cancellable)
+{
+    ArielPluginLoad *load = task_data;
+    
+    if (!ariel_active_plugin_instantiate(load->plugin)) {
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                "Failed to instantiate %s", ariel_active_plugin_get_name(load->plugin));
+        return;
+    }
+    
+    ariel_active_plugin_activate(load->plugin);
+    ariel_active_plugin_warm_up(load->plugin, ARIEL_WARM_UP_BLOCKS);
+    g_task_return_boolean(task, TRUE);
+}
+
+// Main thread: hand the finished instance to the chain
+static void
+ariel_plugin_load_done(G_GNUC_UNUSED GObject *source_object, GAsyncResult *result, G_GNUC_UNUSED gpointer user_data)
+{
+    ArielPluginLoad *load = g_task_get_task_data(G_TASK(result));
+    GError *error = NULL;
+    ArielActivePlugin *active_plugin = NULL;
+    
+    if (g_task_propagate_boolean(G_TASK(result), &error)) {
+        active_plugin = load->plugin;
+        
+        if (load->manager->worker_schedule) {
+            load->manager->worker_schedule->plugin = active_plugin;
+        }
+        
+        // The engine inserts it into the running chain at a cycle boundary
+        g_list_store_append(load->manager->active_plugin_store, active_plugin);
+        ariel_plugin_usage_record(load->manager->usage, load->uri);
+        g_print("Loaded and activated plugin: %s\n", ariel_active_plugin_get_name(active_plugin));
+    } else {
+        g_warning("%s", error->message);
+        g_error_free(error);
+    }
+    
+    if (load->callback) {
+        load->callback(active_plugin, load->user_data);
+    }
+}
+
+// Instantiate and activate a plugin on a loader thread. callback runs on the
+// main thread once the plugin is in the chain, or with NULL on failure.
+void
+ariel_plugin_manager_load_plugin_async(ArielPluginManager *manager, ArielPluginInfo *plugin_info,
+                                       ArielAudioEngine *engine, ArielPluginLoadedFunc callback,
+                                       gpointer user_data)
+{
+    if (!manager || !plugin_info || !engine) {
+        g_warning("Invalid parameters for plugin loading");
+        if (callback) callback(NULL, user_data);
+        return;
+    }
+    
+    // A warm instance goes straight into the chain
+    ArielActivePlugin *pooled = ariel_plugin_manager_take_pooled(manager, plugin_info);
+    if (pooled) {
+        if (manager->worker_schedule) {
+            manager->worker_schedule->plugin = pooled;
+        }
+        g_list_store_append(manager->active_plugin_store, pooled);
+        ariel_plugin_usage_record(manager->usage, ariel_plugin_info_get_uri(plugin_info));
+        if (callback) callback(pooled, user_data);
+        g_object_unref(pooled);
+        return;
+    }
+    
+    // Port introspection needs the lilv world, so it stays on this thread
+    ArielActivePlugin *plugin = ariel_active_plugin_prepare(plugin_info, engine);
+    if (!plugin) {
+        g_warning("Failed to create active plugin for %s", ariel_plugin_info_get_name(plugin_info));
+        if (callback) callback(NULL, user_data);
+        return;
+    }
+    
+    ArielPluginLoad *load = g_malloc0(sizeof(ArielPluginLoad));
+    load->manager = manager;
+    load->plugin = plugin;
+    load->uri = g_strdup(ariel_plugin_info_get_uri(plugin_info));
+    load->callback = callback;
+    load->user_data = user_data;
+    
+    GTask *task = g_task_new(NULL, NULL, ariel_plugin_load_done, NULL);
+    g_task_set_task_data(task, load, (GDestroyNotify)ariel_plugin_load_free);
+    g_task_run_in_thread(task, ariel_plugin_load_thread);
+    g_object_unref(task);
+}
+
 void
 ariel_plugin_manager_free(ArielPluginManager *manager)
 {
     if (!manager) return;
     
+    // Pooled instances need the features and the world, so they go first
+    ariel_plugin_pool_free(manager->plugin_pool);
+    manager->plugin_pool = NULL;
+    ariel_plugin_usage_free(manager->usage);
+    manager->usage = NULL;
+    ariel_preset_index_free(manager->preset_index);
+    manager->preset_index = NULL;
+    ariel_scene_bank_free(manager->scenes);
+    manager->scenes = NULL;
+    ariel_midi_mapper_free(manager->midi_mapper);
+    manager->midi_mapper = NULL;
+    
+    // The indexes borrow from the store and the world, so they go first
+    if (manager->plugin_index) {
+        g_hash_table_destroy(manager->plugin_index);
+    }
+    if (manager->lilv_index) {
+        g_hash_table_destroy(manager->lilv_index);
+    }
+    
     // Defensive cleanup - check validity before clearing to prevent g_object_unref errors
     if (manager->plugin_store && G_IS_OBJECT(manager->plugin_store)) {
         g_clear_object(&manager->plugin_store);
@@ -1189,6 +1399,11 @@ ariel_save_plugin_chain_preset(ArielPluginManager *manager, const char *preset_n
         g_key_file_set_string(preset_file, plugin_section, "name", ariel_active_plugin_get_name(plugin));
         g_key_file_set_boolean(preset_file, plugin_section, "bypass", ariel_active_plugin_get_bypass(plugin));
         
+        // Save the slot's gain, mix and pan
+        ArielSlotMix slot_mix;
+        ariel_active_plugin_get_slot_mix(plugin, &slot_mix);
+        ariel_slot_mix_save_to_keyfile(&slot_mix, preset_file, plugin_section);
+        
         // Save parameters
         guint n_params = ariel_active_plugin_get_num_parameters(plugin);
         g_key_file_set_integer(preset_file, plugin_section, "param_count", n_params);
@@ -1200,10 +1415,17 @@ ariel_save_plugin_chain_preset(ArielPluginManager *manager, const char *preset_n
             g_free(param_key);
         }
         
+        // Embed internal state, so recall needs nothing beyond this file
+        ariel_state_save_to_keyfile(plugin, preset_file, plugin_section);
+        
         g_free(plugin_section);
         g_object_unref(plugin);
     }
     
+    // Scenes travel with the chain they were captured from
+    ariel_scene_bank_save_to_keyfile(manager->scenes, preset_file);
+    ariel_midi_mapper_save_to_keyfile(manager->midi_mapper, preset_file);
+    
     // Save preset file
     gsize length;
     char *preset_data = g_key_file_to_data(preset_file, &length, NULL);
@@ -1221,11 +1443,110 @@ ariel_save_plugin_chain_preset(ArielPluginManager *manager, const char *preset_n
     return success;
 }
 
-gboolean
-ariel_load_plugin_chain_preset(ArielPluginManager *manager, ArielAudioEngine *engine, const char *preset_path)
+// One loader job: plugins sharing a binary, instantiated in chain order.
+// LV2 forbids calling instantiation-class functions of the same plugin
+// concurrently, and a library's globals are shared by all of its plugins,
+// so only distinct libraries are loaded in parallel.
+typedef struct {
+    GPtrArray *plugins;   // ArielActivePlugin*, borrowed
+    gboolean *loaded;     // Indexed like the chain; each job writes its own slots
+    GBytes **states;      // Indexed like the chain, NULL where there is no state
+    GArray *slots;        // guint chain positions for plugins
+} ArielChainLoadJob;
+
+static void
+ariel_chain_load_job_free(ArielChainLoadJob *job)
+{
+    g_ptr_array_free(job->plugins, TRUE);
+    g_array_free(job->slots, TRUE);
+    g_free(job);
+}
+
+static void
+ariel_chain_load_job_run(gpointer data, G_GNUC_UNUSED gpointer user_data)
+{
+    ArielChainLoadJob *job = data;
+    
+    for (guint i = 0; i < job->plugins->len; i++) {
+        ArielActivePlugin *plugin = g_ptr_array_index(job->plugins, i);
+        guint slot = g_array_index(job->slots, guint, i);
+        
+        if (ariel_active_plugin_instantiate(plugin)) {
+            // Not in any chain yet, so restore cannot race with run()
+            if (job->states[slot]) {
+                ariel_active_plugin_restore_state(plugin, job->states[slot]);
+            }
+            ariel_active_plugin_activate(plugin);
+            ariel_active_plugin_warm_up(plugin, ARIEL_WARM_UP_BLOCKS);
+            job->loaded[slot] = TRUE;
+        }
+    }
+}
+
+// A chain preset being built off-line, away from the live chain
+typedef struct {
+    ArielPluginManager *manager;
+    ArielAudioEngine *engine;
+    char *preset_path;
+    GKeyFile *preset_file;
+    gint plugin_count;
+    ArielActivePlugin **plugins;   // Indexed by preset slot, NULL if unavailable
+    gboolean *loaded;
+    GBytes **states;
+    GPtrArray *jobs;
+    ArielChainLoadedFunc callback;
+    gpointer user_data;
+} ArielChainLoad;
+
+static void
+ariel_chain_load_free(ArielChainLoad *load)
+{
+    for (gint i = 0; i < load->plugin_count; i++) {
+        g_clear_object(&load->plugins[i]);
+        g_clear_pointer(&load->states[i], g_bytes_unref);
+    }
+    g_free(load->plugins);
+    g_free(load->states);
+    g_free(load->loaded);
+    g_ptr_array_free(load->jobs, TRUE);
+    g_key_file_free(load->preset_file);
+    g_free(load->preset_path);
+    g_free(load);
+}
+
+// Bypass and control values from a preset section. Applied before the
+// loader activates and warms up the instance, so it never runs with its
+// defaults.
+static void
+ariel_chain_load_apply_params(ArielActivePlugin *plugin, GKeyFile *preset_file, const char *plugin_section)
+{
+    if (g_key_file_has_key(preset_file, plugin_section, "bypass", NULL)) {
+        gboolean bypass = g_key_file_get_boolean(preset_file, plugin_section, "bypass", NULL);
+        ariel_active_plugin_set_bypass(plugin, bypass);
+    }
+    
+    gint param_count = g_key_file_get_integer(preset_file, plugin_section, "param_count", NULL);
+    guint num_parameters = ariel_active_plugin_get_num_parameters(plugin);
+    
+    for (gint j = 0; j < param_count && j < (gint)num_parameters; j++) {
+        char *param_key = g_strdup_printf("param_%d", j);
+        
+        if (g_key_file_has_key(preset_file, plugin_section, param_key, NULL)) {
+            gdouble value = g_key_file_get_double(preset_file, plugin_section, param_key, NULL);
+            ariel_active_plugin_set_parameter(plugin, j, (float)value);
+        }
+        
+        g_free(param_key);
+    }
+}
+
+// Read the preset and prepare every plugin. Port introspection uses the
+// lilv world, so this runs on the main thread.
+static ArielChainLoad *
+ariel_chain_load_begin(ArielPluginManager *manager, ArielAudioEngine *engine, const char *preset_path)
 {
     if (!manager || !engine || !preset_path || !g_file_test(preset_path, G_FILE_TEST_EXISTS)) {
-        return FALSE;
+        return NULL;
     }
     
     GKeyFile *preset_file = g_key_file_new();
@@ -1236,95 +1557,269 @@ ariel_load_plugin_chain_preset(ArielPluginManager *manager, ArielAudioEngine *en
         g_warning("Failed to load chain preset file %s: %s", preset_path, error->message);
         g_error_free(error);
         g_key_file_free(preset_file);
-        return FALSE;
+        return NULL;
     }
     
-    // Clear current active plugins
-    g_list_store_remove_all(manager->active_plugin_store);
+    ArielChainLoad *load = g_malloc0(sizeof(ArielChainLoad));
+    load->manager = manager;
+    load->engine = engine;
+    load->preset_path = g_strdup(preset_path);
+    load->preset_file = preset_file;
     
     // Load chain metadata
-    gint plugin_count = g_key_file_get_integer(preset_file, "chain", "plugin_count", NULL);
+    load->plugin_count = MAX(g_key_file_get_integer(preset_file, "chain", "plugin_count", NULL), 0);
+    load->plugins = g_new0(ArielActivePlugin *, MAX(load->plugin_count, 1));
+    load->loaded = g_new0(gboolean, MAX(load->plugin_count, 1));
+    load->states = g_new0(GBytes *, MAX(load->plugin_count, 1));
+    load->jobs = g_ptr_array_new_with_free_func((GDestroyNotify)ariel_chain_load_job_free);
+    
+    GHashTable *jobs_by_library = g_hash_table_new(g_str_hash, g_str_equal);
     
-    // Load each plugin in the chain
-    for (gint i = 0; i < plugin_count; i++) {
+    for (gint i = 0; i < load->plugin_count; i++) {
         char *plugin_section = g_strdup_printf("plugin_%d", i);
         
         // Get plugin URI
         char *plugin_uri = g_key_file_get_string(preset_file, plugin_section, "uri", NULL);
+        g_free(plugin_section);
         if (!plugin_uri) {
-            g_free(plugin_section);
             continue;
         }
         
         // Find plugin info by URI
-        ArielPluginInfo *plugin_info = NULL;
-        guint n_plugins = g_list_model_get_n_items(G_LIST_MODEL(manager->plugin_store));
-        
-        for (guint j = 0; j < n_plugins; j++) {
-            ArielPluginInfo *info = g_list_model_get_item(G_LIST_MODEL(manager->plugin_store), j);
-            if (info && strcmp(ariel_plugin_info_get_uri(info), plugin_uri) == 0) {
-                plugin_info = info;
-                break;
-            }
-            if (info) g_object_unref(info);
-        }
-        
+        ArielPluginInfo *plugin_info = ariel_plugin_manager_find_plugin(manager, plugin_uri);
         if (!plugin_info) {
             g_warning("Plugin not found for URI: %s", plugin_uri);
             g_free(plugin_uri);
-            g_free(plugin_section);
             continue;
         }
         
-        // Load the plugin
-        ArielActivePlugin *active_plugin = ariel_plugin_manager_load_plugin(manager, plugin_info, engine);
-        if (!active_plugin) {
+        char *state_section = g_strdup_printf("plugin_%d", i);
+        load->states[i] = ariel_state_load_from_keyfile(preset_file, state_section);
+        g_free(state_section);
+        
+        // A warm instance with the same parameters and state needs no loading at all
+        if (manager->plugin_pool) {
+            char *section = g_strdup_printf("plugin_%d", i);
+            gint param_count = MAX(g_key_file_get_integer(preset_file, section, "param_count", NULL), 0);
+            float *params = g_new0(float, MAX(param_count, 1));
+            
+            for (gint j = 0; j < param_count; j++) {
+                char *param_key = g_strdup_printf("param_%d", j);
+                params[j] = (float)g_key_file_get_double(preset_file, section, param_key, NULL);
+                g_free(param_key);
+            }
+            
+            guint state_hash = ariel_plugin_state_hash(params, (guint)param_count);
+            if (load->states[i]) {
+                state_hash ^= g_bytes_hash(load->states[i]);
+            }
+            
+            // With internal state, only an exact match will do
+            load->plugins[i] = ariel_plugin_pool_acquire(manager->plugin_pool, plugin_uri, state_hash,
+                                                         load->states[i] != NULL);
+            g_free(params);
+            g_free(section);
+            
+            if (load->plugins[i]) {
+                // Not in any chain, so nothing reads the values yet
+                char *params_section = g_strdup_printf("plugin_%d", i);
+                ariel_chain_load_apply_params(load->plugins[i], preset_file, params_section);
+                g_free(params_section);
+                load->loaded[i] = TRUE;
+                g_free(plugin_uri);
+                continue;
+            }
+        }
+        
+        load->plugins[i] = ariel_active_plugin_prepare(plugin_info, engine);
+        if (!load->plugins[i]) {
             g_warning("Failed to load plugin: %s", plugin_uri);
-            g_object_unref(plugin_info);
             g_free(plugin_uri);
-            g_free(plugin_section);
             continue;
         }
         
-        // Load bypass state
-        if (g_key_file_has_key(preset_file, plugin_section, "bypass", NULL)) {
-            gboolean bypass = g_key_file_get_boolean(preset_file, plugin_section, "bypass", NULL);
-            ariel_active_plugin_set_bypass(active_plugin, bypass);
+        char *params_section = g_strdup_printf("plugin_%d", i);
+        ariel_chain_load_apply_params(load->plugins[i], preset_file, params_section);
+        g_free(params_section);
+        
+        // Group by binary; plugins without one get a job of their own
+        const char *library_path = ariel_active_plugin_get_library_path(load->plugins[i]);
+        ArielChainLoadJob *job = library_path ? g_hash_table_lookup(jobs_by_library, library_path) : NULL;
+        if (!job) {
+            job = g_malloc0(sizeof(ArielChainLoadJob));
+            job->plugins = g_ptr_array_new();
+            job->slots = g_array_new(FALSE, FALSE, sizeof(guint));
+            job->loaded = load->loaded;
+            job->states = load->states;
+            g_ptr_array_add(load->jobs, job);
+            if (library_path) {
+                // Keyed by the plugin's own string, which outlives the table
+                g_hash_table_insert(jobs_by_library, (gpointer)library_path, job);
+            }
         }
+        guint slot = (guint)i;
+        g_ptr_array_add(job->plugins, load->plugins[i]);
+        g_array_append_val(job->slots, slot);
         
-        // Load parameters
-        gint param_count = g_key_file_get_integer(preset_file, plugin_section, "param_count", NULL);
-        guint num_parameters = ariel_active_plugin_get_num_parameters(active_plugin);
+        g_free(plugin_uri);
+    }
+    
+    g_hash_table_destroy(jobs_by_library);
+    return load;
+}
+
+// Instantiate and activate every prepared plugin, fanned out across a
+// thread pool. Blocks until all jobs are done; safe on any thread.
+static void
+ariel_chain_load_build(ArielChainLoad *load)
+{
+    if (load->jobs->len == 0) {
+        return;
+    }
+    
+    gint64 start_time = g_get_monotonic_time();
+    GThreadPool *pool = g_thread_pool_new(ariel_chain_load_job_run, NULL,
+                                          (gint)MIN(load->jobs->len, g_get_num_processors()),
+                                          FALSE, NULL);
+    for (guint i = 0; i < load->jobs->len; i++) {
+        g_thread_pool_push(pool, g_ptr_array_index(load->jobs, i), NULL);
+    }
+    
+    // Freeing the pool waits for every job
+    g_thread_pool_free(pool, FALSE, TRUE);
+    
+    g_print("Instantiated chain in %u parallel jobs in %.1f ms\n", load->jobs->len,
+            (g_get_monotonic_time() - start_time) / 1000.0);
+}
+
+// Hand the finished chain to the engine in one step (main thread). The engine crossfades from the old chain to the new one.
+static gboolean
+ariel_chain_load_publish(ArielChainLoad *load)
+{
+    ArielPluginManager *manager = load->manager;
+    GPtrArray *chain = g_ptr_array_new_with_free_func(g_object_unref);
+    
+    // Assemble the chain in preset order
+    for (gint i = 0; i < load->plugin_count; i++) {
+        ArielActivePlugin *active_plugin = load->plugins[i];
+        if (!active_plugin) {
+            continue;
+        }
         
-        for (gint j = 0; j < param_count && j < (gint)num_parameters; j++) {
-            char *param_key = g_strdup_printf("param_%d", j);
-            
-            if (g_key_file_has_key(preset_file, plugin_section, param_key, NULL)) {
-                gdouble value = g_key_file_get_double(preset_file, plugin_section, param_key, NULL);
-                ariel_active_plugin_set_parameter(active_plugin, j, (float)value);
-            }
-            
-            g_free(param_key);
+        if (!load->loaded[i]) {
+            g_warning("Failed to load plugin: %s", ariel_active_plugin_get_name(active_plugin));
+            continue;
         }
         
-        g_object_unref(plugin_info);
-        g_object_unref(active_plugin);
+        char *plugin_section = g_strdup_printf("plugin_%d", i);
+        
+        // Load the slot's gain, mix and pan
+        ArielSlotMix slot_mix;
+        ariel_slot_mix_load_from_keyfile(&slot_mix, load->preset_file, plugin_section);
+        ariel_active_plugin_set_slot_mix(active_plugin, &slot_mix);
+        
+        char *plugin_uri = g_key_file_get_string(load->preset_file, plugin_section, "uri", NULL);
+        ariel_plugin_usage_record(manager->usage, plugin_uri);
         g_free(plugin_uri);
+        
+        g_ptr_array_add(chain, g_object_ref(active_plugin));
         g_free(plugin_section);
     }
     
-    g_key_file_free(preset_file);
+    if (chain->len > 0 && manager->worker_schedule) {
+        manager->worker_schedule->plugin = g_ptr_array_index(chain, chain->len - 1);
+    }
+    
+    // Remember the outgoing plugins, so the ones not reused can be pooled
+    GListModel *model = G_LIST_MODEL(manager->active_plugin_store);
+    guint n_old = g_list_model_get_n_items(model);
+    GPtrArray *removed = g_ptr_array_new_full(n_old, g_object_unref);
+    for (guint i = 0; i < n_old; i++) {
+        g_ptr_array_add(removed, g_list_model_get_item(model, i));
+    }
     
-    char *preset_name = g_path_get_basename(preset_path);
+    // Replace the running chain in one step, so the engine swaps it whole
+    ariel_audio_engine_crossfade_next_chain(load->engine);
+    g_list_store_splice(manager->active_plugin_store, 0, n_old, chain->pdata, chain->len);
+    
+    for (guint i = 0; manager->plugin_pool && i < removed->len; i++) {
+        ArielActivePlugin *old_plugin = g_ptr_array_index(removed, i);
+        if (!g_ptr_array_find(chain, old_plugin, NULL)) {
+            ariel_plugin_pool_release(manager->plugin_pool, old_plugin);
+        }
+    }
+    g_ptr_array_free(removed, TRUE);
+    g_ptr_array_free(chain, TRUE);
+    
+    ariel_scene_bank_load_from_keyfile(manager->scenes, load->preset_file);
+    ariel_midi_mapper_load_from_keyfile(manager->midi_mapper, load->engine, load->preset_file);
+    
+    char *preset_name = g_path_get_basename(load->preset_path);
     if (g_str_has_suffix(preset_name, ".chain")) {
         preset_name[strlen(preset_name) - 6] = '\0'; // Remove .chain extension
     }
-    g_print("Loaded plugin chain preset '%s' with %d plugins\n", preset_name, plugin_count);
+    g_print("Loaded plugin chain preset '%s' with %d plugins\n", preset_name, load->plugin_count);
     g_free(preset_name);
     
     return TRUE;
 }
 
+gboolean
+ariel_load_plugin_chain_preset(ArielPluginManager *manager, ArielAudioEngine *engine, const char *preset_path)
+{
+    ArielChainLoad *load = ariel_chain_load_begin(manager, engine, preset_path);
+    if (!load) {
+        return FALSE;
+    }
+    
+    ariel_chain_load_build(load);
+    gboolean success = ariel_chain_load_publish(load);
+    ariel_chain_load_free(load);
+    
+    return success;
+}
+
+static void
+ariel_chain_load_thread(GTask *task, G_GNUC_UNUSED gpointer source_object,
+                        gpointer task_data, G_GNUC_UNUSED GCancellable *cancellable)
+{
+    ariel_chain_load_build(task_data);
+    g_task_return_boolean(task, TRUE);
+}
+
+static void
+ariel_chain_load_done(G_GNUC_UNUSED GObject *source_object, GAsyncResult *result, G_GNUC_UNUSED gpointer user_data)
+{
+    ArielChainLoad *load = g_task_get_task_data(G_TASK(result));
+    gboolean success = g_task_propagate_boolean(G_TASK(result), NULL) && ariel_chain_load_publish(load);
+    
+    if (load->callback) {
+        load->callback(success, load->user_data);
+    }
+}
+
+// Build a chain preset in the background while the current chain keeps
+// playing, then crossfade to it. callback runs on the main thread.
+void
+ariel_load_plugin_chain_preset_async(ArielPluginManager *manager, ArielAudioEngine *engine,
+                                     const char *preset_path, ArielChainLoadedFunc callback,
+                                     gpointer user_data)
+{
+    ArielChainLoad *load = ariel_chain_load_begin(manager, engine, preset_path);
+    if (!load) {
+        if (callback) callback(FALSE, user_data);
+        return;
+    }
+    
+    load->callback = callback;
+    load->user_data = user_data;
+    
+    GTask *task = g_task_new(NULL, NULL, ariel_chain_load_done, NULL);
+    g_task_set_task_data(task, load, (GDestroyNotify)ariel_chain_load_free);
+    g_task_run_in_thread(task, ariel_chain_load_thread);
+    g_object_unref(task);
+}
+
 char **
 ariel_list_plugin_chain_presets(const char *preset_dir)
 {
@@ -0,0 +1,145 @@
+#include "ariel.h"
+
+// Warm instance pool.
+//
+// Plugins removed from the chain are parked here, still instantiated and
+// activated, instead of being destroyed. Adding the same plugin again, or
+// loading a chain preset that uses it, takes an instance from the pool and
+// skips dlopen, instantiate and activation. Entries are kept most recently
+// used first and evicted from the tail once their estimated memory exceeds
+// the pool's budget.
+
+#define ARIEL_POOL_MIN_COST (1024 * 1024)  // Assumed for instances we could not measure
+
+typedef struct {
+    ArielActivePlugin *plugin;
+    char *uri;
+    guint state_hash;
+    gsize cost;
+} ArielPoolEntry;
+
+struct _ArielPluginPool {
+    GQueue entries;        // ArielPoolEntry*, most recently released first
+    gsize memory_used;
+    gsize memory_budget;
+};
+
+static void
+ariel_pool_entry_free(ArielPoolEntry *entry)
+{
+    g_object_unref(entry->plugin);
+    g_free(entry->uri);
+    g_free(entry);
+}
+
+ArielPluginPool *
+ariel_plugin_pool_new(gsize memory_budget)
+{
+    ArielPluginPool *pool = g_malloc0(sizeof(ArielPluginPool));
+    g_queue_init(&pool->entries);
+    pool->memory_budget = memory_budget;
+    return pool;
+}
+
+void
+ariel_plugin_pool_free(ArielPluginPool *pool)
+{
+    if (!pool) return;
+
+    g_queue_clear_full(&pool->entries, (GDestroyNotify)ariel_pool_entry_free);
+    g_free(pool);
+}
+
+// Evict least recently used instances until the pool fits its budget
+static void
+ariel_plugin_pool_trim(ArielPluginPool *pool)
+{
+    while (pool->memory_used > pool->memory_budget && !g_queue_is_empty(&pool->entries)) {
+        ArielPoolEntry *entry = g_queue_pop_tail(&pool->entries);
+        pool->memory_used -= entry->cost;
+        ARIEL_INFO("Evicting %s from the warm pool", ariel_active_plugin_get_name(entry->plugin));
+        ariel_pool_entry_free(entry);
+    }
+}
+
+void
+ariel_plugin_pool_set_budget(ArielPluginPool *pool, gsize memory_budget)
+{
+    g_return_if_fail(pool != NULL);
+
+    pool->memory_budget = memory_budget;
+    ariel_plugin_pool_trim(pool);
+}
+
+// Park a plugin that has just left the active plugin store. The pool takes
+// its own reference.
+void
+ariel_plugin_pool_release(ArielPluginPool *pool, ArielActivePlugin *plugin)
+{
+    g_return_if_fail(pool != NULL);
+    g_return_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin));
+
+    if (!ariel_active_plugin_get_instance(plugin) || pool->memory_budget == 0) {
+        return;
+    }
+
+    ArielPluginInfo *info = ariel_active_plugin_get_plugin_info(plugin);
+    if (!info) return;
+
+    ArielPoolEntry *entry = g_malloc0(sizeof(ArielPoolEntry));
+    entry->plugin = g_object_ref(plugin);
+    entry->uri = g_strdup(ariel_plugin_info_get_uri(info));
+    entry->state_hash = ariel_active_plugin_get_state_hash(plugin);
+    entry->cost = MAX(ariel_active_plugin_get_memory_cost(plugin), ARIEL_POOL_MIN_COST);
+    g_object_unref(info);
+
+    g_queue_push_head(&pool->entries, entry);
+    pool->memory_used += entry->cost;
+    ariel_plugin_pool_trim(pool);
+}
+
+// Take a warm instance of uri, preferring one whose state hashes to
+// state_hash, then (unless exact) the most recently used. Returns a new
+// reference, or NULL if none is pooled. The instance keeps its previous
+// parameters but is reactivated, so no tails or internal state survive.
+// Entries a retired chain still references cannot be reset yet and are
+// skipped until the reclaim pass has let go of them.
+ArielActivePlugin *
+ariel_plugin_pool_acquire(ArielPluginPool *pool, const char *uri, guint state_hash, gboolean exact)
+{
+    g_return_val_if_fail(pool != NULL, NULL);
+    g_return_val_if_fail(uri != NULL, NULL);
+
+    GList *match = NULL;
+    for (GList *l = pool->entries.head; l != NULL; l = l->next) {
+        ArielPoolEntry *entry = l->data;
+        if (g_strcmp0(entry->uri, uri) != 0 ||
+            ariel_active_plugin_is_in_chain(entry->plugin)) {
+            continue;
+        }
+        if (entry->state_hash == state_hash) {
+            match = l;
+            break;
+        }
+        if (!match && !exact) {
+            match = l;
+        }
+    }
+
+    if (!match) {
+        return NULL;
+    }
+
+    ArielPoolEntry *entry = match->data;
+    ArielActivePlugin *plugin = g_object_ref(entry->plugin);
+    g_queue_delete_link(&pool->entries, match);
+    pool->memory_used -= entry->cost;
+    ariel_pool_entry_free(entry);
+
+    // Reactivating clears tails and other internal state
+    ariel_active_plugin_deactivate(plugin);
+    ariel_active_plugin_activate(plugin);
+
+    ARIEL_INFO("Reusing warm instance of %s", ariel_active_plugin_get_name(plugin));
+    return plugin;
+}
@@ -0,0 +1,283 @@
+#define _GNU_SOURCE
+#include "ariel.h"
+#include <math.h>
+#include <gmodule.h>
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#endif
+
+// Plugin usage statistics and startup prewarm.
+//
+// Every load bumps a per-URI counter and last-used timestamp, stored in
+// plugin_usage.ini in the config dir. At startup the most used plugins'
+// binaries and data files are read into the page cache on a low-priority
+// thread, so their first instantiation after a reboot does not stall on
+// cold disk I/O. The [prewarm] group holds the settings:
+//
+//   [prewarm]
+//   count=10        ; how many plugins to prefetch, 0 disables
+//   dlopen=false    ; also load the binaries, running their constructors
+
+#define ARIEL_USAGE_FILE          "plugin_usage.ini"
+#define ARIEL_USAGE_SAVE_DELAY    2     // Seconds; coalesces bursts of loads
+#define ARIEL_PREWARM_COUNT       10
+#define ARIEL_USAGE_HALF_LIFE     30.0  // Days for a use to count half as much
+
+struct _ArielPluginUsage {
+    GKeyFile *keyfile;
+    char *path;
+    guint save_source;
+};
+
+typedef struct {
+    char *uri;
+    double score;
+} ArielUsageRank;
+
+typedef struct {
+    GPtrArray *files;      // Data files and binaries to read ahead
+    GPtrArray *libraries;  // Binaries to dlopen, if enabled
+} ArielPrewarmJob;
+
+ArielPluginUsage *
+ariel_plugin_usage_new(const char *config_dir)
+{
+    ArielPluginUsage *usage = g_malloc0(sizeof(ArielPluginUsage));
+    usage->keyfile = g_key_file_new();
+    usage->path = g_build_filename(config_dir ? config_dir : g_get_user_config_dir(),
+                                   ARIEL_USAGE_FILE, NULL);
+
+    // A missing file just means no history yet
+    g_key_file_load_from_file(usage->keyfile, usage->path, G_KEY_FILE_KEEP_COMMENTS, NULL);
+    return usage;
+}
+
+void
+ariel_plugin_usage_save(ArielPluginUsage *usage)
+{
+    GError *error = NULL;
+
+    if (!usage) return;
+
+    if (!g_key_file_save_to_file(usage->keyfile, usage->path, &error)) {
+        ARIEL_WARN("Failed to save plugin usage to %s: %s", usage->path, error->message);
+        g_error_free(error);
+    }
+}
+
+void
+ariel_plugin_usage_free(ArielPluginUsage *usage)
+{
+    if (!usage) return;
+
+    // Flush a pending save
+    if (usage->save_source) {
+        g_source_remove(usage->save_source);
+        ariel_plugin_usage_save(usage);
+    }
+
+    g_key_file_free(usage->keyfile);
+    g_free(usage->path);
+    g_free(usage);
+}
+
+static gboolean
+ariel_plugin_usage_save_cb(gpointer user_data)
+{
+    ArielPluginUsage *usage = user_data;
+    usage->save_source = 0;
+    ariel_plugin_usage_save(usage);
+    return G_SOURCE_REMOVE;
+}
+
+// Count one use of a plugin (main thread)
+void
+ariel_plugin_usage_record(ArielPluginUsage *usage, const char *uri)
+{
+    if (!usage || !uri) return;
+
+    gint count = g_key_file_get_integer(usage->keyfile, uri, "count", NULL);
+    g_key_file_set_integer(usage->keyfile, uri, "count", count + 1);
+    g_key_file_set_int64(usage->keyfile, uri, "last_used", g_get_real_time() / G_USEC_PER_SEC);
+
+    if (!usage->save_source) {
+        usage->save_source = g_timeout_add_seconds(ARIEL_USAGE_SAVE_DELAY,
+                                                   ariel_plugin_usage_save_cb, usage);
+    }
+}
+
+static gint
+ariel_usage_rank_compare(gconstpointer a, gconstpointer b)
+{
+    const ArielUsageRank *ra = a;
+    const ArielUsageRank *rb = b;
+
+    if (ra->score > rb->score) return -1;
+    if (ra->score < rb->score) return 1;
+    return 0;
+}
+
+// URIs ordered by use count, with older uses decaying; free with g_strfreev
+char **
+ariel_plugin_usage_get_top(ArielPluginUsage *usage, guint max_count)
+{
+    GArray *ranks = g_array_new(FALSE, FALSE, sizeof(ArielUsageRank));
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    char **groups = g_key_file_get_groups(usage->keyfile, NULL);
+
+    for (guint i = 0; groups && groups[i]; i++) {
+        if (g_str_equal(groups[i], "prewarm")) continue;
+
+        gint count = g_key_file_get_integer(usage->keyfile, groups[i], "count", NULL);
+        gint64 last_used = g_key_file_get_int64(usage->keyfile, groups[i], "last_used", NULL);
+        double age_days = MAX(now - last_used, 0) / 86400.0;
+
+        ArielUsageRank rank = {
+            .uri = groups[i],
+            .score = count * pow(0.5, age_days / ARIEL_USAGE_HALF_LIFE),
+        };
+        if (count > 0) {
+            g_array_append_val(ranks, rank);
+        }
+    }
+
+    g_array_sort(ranks, ariel_usage_rank_compare);
+
+    guint n = MIN(ranks->len, max_count);
+    char **top = g_new0(char *, n + 1);
+    for (guint i = 0; i < n; i++) {
+        top[i] = g_strdup(g_array_index(ranks, ArielUsageRank, i).uri);
+    }
+
+    g_array_free(ranks, TRUE);
+    g_strfreev(groups);
+    return top;
+}
+
+// Pull a file into the page cache without keeping anything in our heap
+static void
+ariel_prewarm_file(const char *path)
+{
+#ifdef G_OS_UNIX
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+
+#ifdef __linux__
+    // Synchronous readahead, so the thread paces itself through the list
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        readahead(fd, 0, (size_t)st.st_size);
+    }
+#else
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+    close(fd);
+#else
+    // No readahead hint here; reading the file through has the same effect
+    char *contents = NULL;
+    gsize length = 0;
+    if (g_file_get_contents(path, &contents, &length, NULL)) {
+        g_free(contents);
+    }
+#endif
+}
+
+static gpointer
+ariel_prewarm_thread(gpointer data)
+{
+    ArielPrewarmJob *job = data;
+    gint64 start_time = g_get_monotonic_time();
+
+#ifdef G_OS_UNIX
+    // Lowest CPU priority; on Linux this applies to this thread only
+    if (setpriority(PRIO_PROCESS, 0, 19) != 0) {
+        ARIEL_WARN("Could not lower prewarm thread priority");
+    }
+#endif
+
+    for (guint i = 0; i < job->files->len; i++) {
+        ariel_prewarm_file(g_ptr_array_index(job->files, i));
+    }
+
+    // Loaded binaries stay resident, so lilv's own dlopen later is only a
+    // reference count bump
+    for (guint i = 0; i < job->libraries->len; i++) {
+        GModule *module = g_module_open(g_ptr_array_index(job->libraries, i), G_MODULE_BIND_LOCAL);
+        if (module) {
+            g_module_make_resident(module);
+            g_module_close(module);
+        }
+    }
+
+    ARIEL_INFO("Prewarmed %u files (%u binaries loaded) in %.1f ms", job->files->len,
+               job->libraries->len, (g_get_monotonic_time() - start_time) / 1000.0);
+
+    g_ptr_array_free(job->files, TRUE);
+    g_ptr_array_free(job->libraries, TRUE);
+    g_free(job);
+    return NULL;
+}
+
+static void
+ariel_prewarm_add_uri(GPtrArray *files, const LilvNode *node)
+{
+    if (!node || !lilv_node_is_uri(node)) return;
+
+    char *path = lilv_file_uri_parse(lilv_node_as_uri(node), NULL);
+    if (path) {
+        g_ptr_array_add(files, g_strdup(path));
+        lilv_free(path);
+    }
+}
+
+// Start prefetching the most used plugins in the background. File paths are
+// resolved here, since that queries the lilv world; the thread only does I/O.
+void
+ariel_plugin_manager_prewarm(ArielPluginManager *manager)
+{
+    if (!manager || !manager->usage || !manager->lilv_index) return;
+
+    GKeyFile *keyfile = manager->usage->keyfile;
+    guint count = ARIEL_PREWARM_COUNT;
+    if (g_key_file_has_key(keyfile, "prewarm", "count", NULL)) {
+        count = (guint)MAX(g_key_file_get_integer(keyfile, "prewarm", "count", NULL), 0);
+    }
+    gboolean load_binaries = g_key_file_get_boolean(keyfile, "prewarm", "dlopen", NULL);
+
+    if (count == 0) return;
+
+    char **top = ariel_plugin_usage_get_top(manager->usage, count);
+    ArielPrewarmJob *job = g_malloc0(sizeof(ArielPrewarmJob));
+    job->files = g_ptr_array_new_with_free_func(g_free);
+    job->libraries = g_ptr_array_new_with_free_func(g_free);
+
+    for (guint i = 0; top[i]; i++) {
+        const LilvPlugin *plugin = g_hash_table_lookup(manager->lilv_index, top[i]);
+        if (!plugin) continue;
+
+        // Data files first: instantiation reads the bundle before the binary
+        const LilvNodes *data_uris = lilv_plugin_get_data_uris(plugin);
+        LILV_FOREACH(nodes, iter, data_uris) {
+            ariel_prewarm_add_uri(job->files, lilv_nodes_get(data_uris, iter));
+        }
+
+        const LilvNode *library_uri = lilv_plugin_get_library_uri(plugin);
+        ariel_prewarm_add_uri(job->files, library_uri);
+        if (load_binaries) {
+            ariel_prewarm_add_uri(job->libraries, library_uri);
+        }
+    }
+    g_strfreev(top);
+
+    if (job->files->len == 0) {
+        g_ptr_array_free(job->files, TRUE);
+        g_ptr_array_free(job->libraries, TRUE);
+        g_free(job);
+        return;
+    }
+
+    g_thread_unref(g_thread_new("ariel-prewarm", ariel_prewarm_thread, job));
+}
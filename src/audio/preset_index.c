@@ -0,0 +1,431 @@
+#include "ariel.h"
+#include <string.h>
+#include <glib/gstdio.h>
+#include <lv2/presets/presets.h>
+
+// Preset index.
+//
+// Maps plugin URIs to their presets, so listing one plugin's presets does
+// not parse every .preset file in the directory. User presets are cached in
+// .preset_index inside the preset directory, keyed by file name together
+// with the file's mtime and size; a file is parsed again only when those
+// change. A GFileMonitor marks the index stale when the directory changes;
+// where monitoring is unavailable the directory's own mtime is checked.
+// LV2 presets (pset:Preset) are looked up through lilv per plugin, the
+// first time that plugin's presets are listed.
+
+#define ARIEL_PRESET_INDEX_FILE ".preset_index"
+#define ARIEL_PRESET_SUFFIX     ".preset"
+
+typedef struct {
+    char *uri;
+    gint64 mtime;
+    gint64 size;
+} ArielPresetFile;
+
+struct _ArielPresetIndex {
+    char *dir;
+    char *index_path;
+    GHashTable *files;        // File name -> ArielPresetFile
+    GHashTable *by_uri;       // Plugin URI -> GPtrArray of preset names
+    GHashTable *lv2_presets;  // Plugin URI -> GPtrArray of ArielPresetEntry
+    GFileMonitor *monitor;
+    gboolean stale;
+    gint64 dir_mtime;
+};
+
+static void
+ariel_preset_file_free(gpointer data)
+{
+    ArielPresetFile *file = data;
+    g_free(file->uri);
+    g_free(file);
+}
+
+static void
+ariel_preset_entry_free(gpointer data)
+{
+    ArielPresetEntry *entry = data;
+    g_free(entry->name);
+    g_free(entry->path);
+    g_free(entry);
+}
+
+static ArielPresetEntry *
+ariel_preset_entry_new(const char *name, const char *path)
+{
+    ArielPresetEntry *entry = g_malloc0(sizeof(ArielPresetEntry));
+    entry->name = g_strdup(name);
+    entry->path = g_strdup(path);
+    return entry;
+}
+
+ArielPresetIndex *
+ariel_preset_index_new(void)
+{
+    ArielPresetIndex *index = g_malloc0(sizeof(ArielPresetIndex));
+    index->files = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, ariel_preset_file_free);
+    index->by_uri = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                          (GDestroyNotify)g_ptr_array_unref);
+    index->lv2_presets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                               (GDestroyNotify)g_ptr_array_unref);
+    index->stale = TRUE;
+    return index;
+}
+
+static void
+ariel_preset_index_clear_monitor(ArielPresetIndex *index)
+{
+    if (index->monitor) {
+        g_signal_handlers_disconnect_by_data(index->monitor, index);
+        g_file_monitor_cancel(index->monitor);
+        g_clear_object(&index->monitor);
+    }
+}
+
+void
+ariel_preset_index_free(ArielPresetIndex *index)
+{
+    if (!index) return;
+
+    ariel_preset_index_clear_monitor(index);
+    g_hash_table_destroy(index->files);
+    g_hash_table_destroy(index->by_uri);
+    g_hash_table_destroy(index->lv2_presets);
+    g_free(index->dir);
+    g_free(index->index_path);
+    g_free(index);
+}
+
+static gboolean
+ariel_preset_index_stat(const char *path, gint64 *mtime, gint64 *size)
+{
+    GStatBuf st;
+    if (g_stat(path, &st) != 0) return FALSE;
+
+    *mtime = (gint64)st.st_mtime;
+    if (size) *size = (gint64)st.st_size;
+    return TRUE;
+}
+
+static gboolean
+ariel_preset_is_preset_file(GFile *file)
+{
+    if (!file) return FALSE;
+
+    char *name = g_file_get_basename(file);
+    gboolean is_preset = name && g_str_has_suffix(name, ARIEL_PRESET_SUFFIX);
+    g_free(name);
+    return is_preset;
+}
+
+// Only .preset files matter; this also skips our own writes to the index
+static void
+ariel_preset_index_changed(G_GNUC_UNUSED GFileMonitor *monitor, GFile *file, GFile *other_file,
+                           G_GNUC_UNUSED GFileMonitorEvent event, gpointer user_data)
+{
+    ArielPresetIndex *index = user_data;
+
+    if (ariel_preset_is_preset_file(file) || ariel_preset_is_preset_file(other_file)) {
+        index->stale = TRUE;
+    }
+}
+
+static void
+ariel_preset_index_load(ArielPresetIndex *index)
+{
+    GKeyFile *keyfile = g_key_file_new();
+
+    // A missing index just means every file gets parsed once
+    if (g_key_file_load_from_file(keyfile, index->index_path, G_KEY_FILE_NONE, NULL)) {
+        char **groups = g_key_file_get_groups(keyfile, NULL);
+
+        for (guint i = 0; groups[i]; i++) {
+            if (!g_str_has_suffix(groups[i], ARIEL_PRESET_SUFFIX)) continue;
+
+            char *uri = g_key_file_get_string(keyfile, groups[i], "uri", NULL);
+            if (!uri) continue;
+
+            ArielPresetFile *file = g_malloc0(sizeof(ArielPresetFile));
+            file->uri = uri;
+            file->mtime = g_key_file_get_int64(keyfile, groups[i], "mtime", NULL);
+            file->size = g_key_file_get_int64(keyfile, groups[i], "size", NULL);
+            g_hash_table_replace(index->files, g_strdup(groups[i]), file);
+        }
+        g_strfreev(groups);
+    }
+
+    g_key_file_free(keyfile);
+}
+
+static void
+ariel_preset_index_save(ArielPresetIndex *index)
+{
+    GKeyFile *keyfile = g_key_file_new();
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_hash_table_iter_init(&iter, index->files);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        ArielPresetFile *file = value;
+
+        // Group names cannot hold brackets; such files are just parsed each time
+        if (strpbrk(key, "[]")) continue;
+
+        g_key_file_set_string(keyfile, key, "uri", file->uri);
+        g_key_file_set_int64(keyfile, key, "mtime", file->mtime);
+        g_key_file_set_int64(keyfile, key, "size", file->size);
+    }
+
+    GError *error = NULL;
+    if (!g_key_file_save_to_file(keyfile, index->index_path, &error)) {
+        ARIEL_WARN("Failed to save preset index %s: %s", index->index_path, error->message);
+        g_error_free(error);
+    }
+    g_key_file_free(keyfile);
+}
+
+static gint
+ariel_preset_name_compare(gconstpointer a, gconstpointer b)
+{
+    return g_utf8_collate(*(const char *const *)a, *(const char *const *)b);
+}
+
+// Regroup the cached files by plugin URI; no I/O
+static void
+ariel_preset_index_rebuild(ArielPresetIndex *index)
+{
+    GHashTableIter iter;
+    gpointer key, value;
+
+    g_hash_table_remove_all(index->by_uri);
+
+    g_hash_table_iter_init(&iter, index->files);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        ArielPresetFile *file = value;
+        GPtrArray *names = g_hash_table_lookup(index->by_uri, file->uri);
+        if (!names) {
+            names = g_ptr_array_new_with_free_func(g_free);
+            g_hash_table_insert(index->by_uri, g_strdup(file->uri), names);
+        }
+        g_ptr_array_add(names, g_strndup(key, strlen(key) - strlen(ARIEL_PRESET_SUFFIX)));
+    }
+
+    g_hash_table_iter_init(&iter, index->by_uri);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        g_ptr_array_sort(value, ariel_preset_name_compare);
+    }
+}
+
+static char *
+ariel_preset_index_parse(const char *path)
+{
+    GKeyFile *preset_file = g_key_file_new();
+    char *uri = NULL;
+
+    if (g_key_file_load_from_file(preset_file, path, G_KEY_FILE_NONE, NULL)) {
+        uri = g_key_file_get_string(preset_file, "plugin", "uri", NULL);
+    }
+
+    g_key_file_free(preset_file);
+    return uri;
+}
+
+// Bring the cache in line with the directory, parsing only files that
+// are new or whose mtime or size changed
+static void
+ariel_preset_index_rescan(ArielPresetIndex *index)
+{
+    GHashTable *seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    gboolean modified = FALSE;
+    guint n_parsed = 0;
+
+    index->stale = FALSE;
+    ariel_preset_index_stat(index->dir, &index->dir_mtime, NULL);
+
+    GDir *dir = g_dir_open(index->dir, 0, NULL);
+    const char *filename;
+
+    while (dir && (filename = g_dir_read_name(dir)) != NULL) {
+        if (!g_str_has_suffix(filename, ARIEL_PRESET_SUFFIX)) continue;
+
+        char *path = g_build_filename(index->dir, filename, NULL);
+        gint64 mtime, size;
+
+        if (ariel_preset_index_stat(path, &mtime, &size)) {
+            ArielPresetFile *file = g_hash_table_lookup(index->files, filename);
+
+            if (!file || file->mtime != mtime || file->size != size) {
+                char *uri = ariel_preset_index_parse(path);
+                n_parsed++;
+
+                if (uri) {
+                    file = g_malloc0(sizeof(ArielPresetFile));
+                    file->uri = uri;
+                    file->mtime = mtime;
+                    file->size = size;
+                    g_hash_table_replace(index->files, g_strdup(filename), file);
+                    modified = TRUE;
+                } else if (file) {
+                    g_hash_table_remove(index->files, filename);
+                    modified = TRUE;
+                }
+            }
+
+            g_hash_table_add(seen, g_strdup(filename));
+        }
+        g_free(path);
+    }
+    if (dir) {
+        g_dir_close(dir);
+    }
+
+    // Drop files that went away or no longer parse
+    GHashTableIter iter;
+    gpointer key, value;
+    g_hash_table_iter_init(&iter, index->files);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        if (!g_hash_table_contains(seen, key)) {
+            g_hash_table_iter_remove(&iter);
+            modified = TRUE;
+        }
+    }
+    g_hash_table_destroy(seen);
+
+    if (modified) {
+        ariel_preset_index_rebuild(index);
+        ariel_preset_index_save(index);
+        ARIEL_INFO("Preset index: %u presets, %u files parsed",
+                   g_hash_table_size(index->files), n_parsed);
+    }
+}
+
+// Point the index at preset_dir, loading its cache and watching it
+static void
+ariel_preset_index_set_dir(ArielPresetIndex *index, const char *preset_dir)
+{
+    if (index->dir && g_str_equal(index->dir, preset_dir)) return;
+
+    ariel_preset_index_clear_monitor(index);
+    g_hash_table_remove_all(index->files);
+    g_free(index->dir);
+    g_free(index->index_path);
+    index->dir = g_strdup(preset_dir);
+    index->index_path = g_build_filename(preset_dir, ARIEL_PRESET_INDEX_FILE, NULL);
+    index->stale = TRUE;
+    index->dir_mtime = 0;
+
+    GFile *dir_file = g_file_new_for_path(preset_dir);
+    index->monitor = g_file_monitor_directory(dir_file, G_FILE_MONITOR_WATCH_MOVES, NULL, NULL);
+    g_object_unref(dir_file);
+    if (index->monitor) {
+        g_signal_connect(index->monitor, "changed", G_CALLBACK(ariel_preset_index_changed), index);
+    }
+
+    ariel_preset_index_load(index);
+    ariel_preset_index_rebuild(index);
+}
+
+static gboolean
+ariel_preset_index_needs_rescan(ArielPresetIndex *index)
+{
+    if (index->stale) return TRUE;
+    if (index->monitor) return FALSE;
+
+    // Adding, removing or atomically rewriting a file touches the directory
+    gint64 dir_mtime = 0;
+    ariel_preset_index_stat(index->dir, &dir_mtime, NULL);
+    return dir_mtime != index->dir_mtime;
+}
+
+// pset:Preset resources of a plugin, from the lilv world
+static GPtrArray *
+ariel_preset_index_find_lv2(ArielPluginManager *manager, const char *uri)
+{
+    GPtrArray *presets = g_ptr_array_new_with_free_func(ariel_preset_entry_free);
+    const LilvPlugin *plugin = manager && manager->lilv_index ?
+                               g_hash_table_lookup(manager->lilv_index, uri) : NULL;
+    if (!plugin) return presets;
+
+    LilvNode *preset_class = lilv_new_uri(manager->world, LV2_PRESETS__Preset);
+    LilvNode *label_predicate = lilv_new_uri(manager->world, LILV_NS_RDFS "label");
+    LilvNodes *related = lilv_plugin_get_related(plugin, preset_class);
+
+    LILV_FOREACH(nodes, iter, related) {
+        const LilvNode *preset = lilv_nodes_get(related, iter);
+        lilv_world_load_resource(manager->world, preset);
+
+        LilvNode *label = lilv_world_get(manager->world, preset, label_predicate, NULL);
+        g_ptr_array_add(presets, ariel_preset_entry_new(label ? lilv_node_as_string(label)
+                                                              : lilv_node_as_uri(preset),
+                                                        lilv_node_as_uri(preset)));
+        lilv_node_free(label);
+    }
+
+    lilv_nodes_free(related);
+    lilv_node_free(label_predicate);
+    lilv_node_free(preset_class);
+    return presets;
+}
+
+// Presets for the plugin with this URI: user presets in preset_dir, sorted
+// by name, then the plugin's LV2 presets. Returns ArielPresetEntry items.
+GPtrArray *
+ariel_preset_index_list(ArielPresetIndex *index, ArielPluginManager *manager,
+                        const char *preset_dir, const char *uri)
+{
+    GPtrArray *result = g_ptr_array_new_with_free_func(ariel_preset_entry_free);
+    g_return_val_if_fail(index != NULL && uri != NULL, result);
+
+    if (preset_dir) {
+        ariel_preset_index_set_dir(index, preset_dir);
+        if (ariel_preset_index_needs_rescan(index)) {
+            ariel_preset_index_rescan(index);
+        }
+
+        GPtrArray *names = g_hash_table_lookup(index->by_uri, uri);
+        for (guint i = 0; names && i < names->len; i++) {
+            const char *name = g_ptr_array_index(names, i);
+            char *filename = g_strconcat(name, ARIEL_PRESET_SUFFIX, NULL);
+            char *path = g_build_filename(index->dir, filename, NULL);
+            g_ptr_array_add(result, ariel_preset_entry_new(name, path));
+            g_free(path);
+            g_free(filename);
+        }
+    }
+
+    GPtrArray *lv2_presets = g_hash_table_lookup(index->lv2_presets, uri);
+    if (!lv2_presets) {
+        lv2_presets = ariel_preset_index_find_lv2(manager, uri);
+        g_hash_table_insert(index->lv2_presets, g_strdup(uri), lv2_presets);
+    }
+    for (guint i = 0; i < lv2_presets->len; i++) {
+        ArielPresetEntry *entry = g_ptr_array_index(lv2_presets, i);
+        g_ptr_array_add(result, ariel_preset_entry_new(entry->name, entry->path));
+    }
+
+    return result;
+}
+
+// Record a preset file just written, so the next listing need not rescan
+void
+ariel_preset_index_add(ArielPresetIndex *index, const char *preset_path, const char *uri)
+{
+    if (!index || !index->dir || !preset_path || !uri) return;
+
+    char *dir = g_path_get_dirname(preset_path);
+    gboolean indexed_dir = g_str_equal(dir, index->dir);
+    g_free(dir);
+    if (!indexed_dir) return;
+
+    ArielPresetFile *file = g_malloc0(sizeof(ArielPresetFile));
+    if (!ariel_preset_index_stat(preset_path, &file->mtime, &file->size)) {
+        g_free(file);
+        return;
+    }
+    file->uri = g_strdup(uri);
+    g_hash_table_replace(index->files, g_path_get_basename(preset_path), file);
+
+    ariel_preset_index_rebuild(index);
+    ariel_preset_index_save(index);
+}
@@ -0,0 +1,806 @@
+#define _GNU_SOURCE
+#include "ariel.h"
+#include <string.h>
+
+// Recorder.
+//
+// Captures the engine's input (the dry DI signal, for reamping) and its
+// processed output to two files side by side. The audio thread only copies
+// each cycle's frames into a preallocated, locked ring buffer; a writer
+// thread drains the ring in large blocks and does all the file work. When
+// the ring is full the audio thread drops the whole cycle from both files
+// at once, so they stay sample-aligned, and counts it as an overrun.
+//
+// Samples are 32-bit float. Audio starts at a fixed 4096-byte offset, so
+// every block lands on an aligned offset, and the header is written when
+// recording stops: a WAV file, or a Sony Wave64 file (renamed to .w64) if
+// the take outgrew the 4 GiB a WAV header can describe.
+//
+// Next to it runs the retrospective capture: a fixed ring holding the last
+// few minutes of input and output in memory, allocated and faulted in
+// before the engine starts and optionally locked. The audio thread copies
+// each cycle into it with one copy per channel. Saving it to disk runs
+// on its own thread while the ring keeps filling.
+
+#ifdef G_OS_UNIX
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <sys/mman.h>
+
+#define ARIEL_RECORDER_CHANNELS       4              // DI left, DI right, output left, output right
+#define ARIEL_RECORDER_FRAME_SIZE     (ARIEL_RECORDER_CHANNELS * sizeof(float))
+#define ARIEL_RECORDER_RING_SECONDS   4              // Writer stall the ring absorbs
+#define ARIEL_RECORDER_BLOCK_FRAMES   16384          // Frames per file write
+#define ARIEL_RECORDER_DATA_OFFSET    4096           // Where audio starts in both formats
+#define ARIEL_RECORDER_PREALLOCATE    (64 << 20)     // Bytes reserved ahead of the writes
+#define ARIEL_RECORDER_POLL_US        20000
+
+typedef struct {
+    char *path;
+    int fd;
+    guint64 data_bytes;
+    guint64 allocated;
+    float *block;                        // Aligned staging buffer
+} ArielRecorderFile;
+
+struct _ArielRecorder {
+    jack_ringbuffer_t *ring;
+    guint sample_rate;
+    ArielRecorderFile files[2];          // DI, output
+    GThread *writer;
+    gint running;                        // Cleared to make the writer drain and stop; atomic
+    gint overruns;                       // Cycles dropped by the audio thread; atomic
+    gint reported_overruns;              // Writer thread only
+    gboolean failed;                     // Writer thread only
+};
+
+static gboolean
+ariel_recorder_file_open(ArielRecorderFile *file, const char *path)
+{
+    file->path = g_strdup(path);
+    file->fd = g_open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file->fd < 0) {
+        g_warning("Could not create recording %s: %s", path, g_strerror(errno));
+        return FALSE;
+    }
+
+    if (posix_memalign((void **)&file->block, ARIEL_RECORDER_DATA_OFFSET,
+                       ARIEL_RECORDER_BLOCK_FRAMES * 2 * sizeof(float)) != 0) {
+        file->block = NULL;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+// Reserve disk space ahead of the writes, so the file does not fragment
+// and a full disk shows up here rather than as a short write
+static void
+ariel_recorder_file_reserve(ArielRecorderFile *file, guint64 end)
+{
+    if (end <= file->allocated) {
+        return;
+    }
+
+    guint64 target = end + ARIEL_RECORDER_PREALLOCATE;
+#ifdef __linux__
+    if (fallocate(file->fd, FALLOC_FL_KEEP_SIZE, (off_t)file->allocated,
+                  (off_t)(target - file->allocated)) != 0) {
+        // Not every filesystem can; the writes still work without it
+        target = G_MAXUINT64;
+    }
+#else
+    target = G_MAXUINT64;
+#endif
+    file->allocated = target;
+}
+
+static gboolean
+ariel_recorder_file_write(ArielRecorderFile *file, guint n_frames)
+{
+    gsize size = (gsize)n_frames * 2 * sizeof(float);
+    guint64 offset = ARIEL_RECORDER_DATA_OFFSET + file->data_bytes;
+    const char *data = (const char *)file->block;
+
+    ariel_recorder_file_reserve(file, offset + size);
+
+    while (size > 0) {
+        ssize_t written = pwrite(file->fd, data, size, (off_t)offset);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            g_warning("Could not write recording %s: %s", file->path, g_strerror(errno));
+            return FALSE;
+        }
+        data += written;
+        offset += (guint64)written;
+        size -= (gsize)written;
+        file->data_bytes += (guint64)written;
+    }
+    return TRUE;
+}
+
+static void
+put_u16(guint8 **p, guint16 value)
+{
+    value = GUINT16_TO_LE(value);
+    memcpy(*p, &value, 2);
+    *p += 2;
+}
+
+static void
+put_u32(guint8 **p, guint32 value)
+{
+    value = GUINT32_TO_LE(value);
+    memcpy(*p, &value, 4);
+    *p += 4;
+}
+
+static void
+put_u64(guint8 **p, guint64 value)
+{
+    value = GUINT64_TO_LE(value);
+    memcpy(*p, &value, 8);
+    *p += 8;
+}
+
+static void
+put_bytes(guint8 **p, const void *bytes, gsize size)
+{
+    memcpy(*p, bytes, size);
+    *p += size;
+}
+
+// WAVE_FORMAT_IEEE_FLOAT, stereo
+static void
+put_format(guint8 **p, guint sample_rate)
+{
+    put_u16(p, 3);
+    put_u16(p, 2);
+    put_u32(p, sample_rate);
+    put_u32(p, sample_rate * 2 * sizeof(float));
+    put_u16(p, 2 * sizeof(float));
+    put_u16(p, 32);
+    put_u16(p, 0);
+}
+
+// RIFF/WAVE header padded with a JUNK chunk so data starts at the offset
+static void
+ariel_recorder_build_wav_header(guint8 *header, guint sample_rate, guint64 data_bytes)
+{
+    guint8 *p = header;
+
+    put_bytes(&p, "RIFF", 4);
+    put_u32(&p, (guint32)(ARIEL_RECORDER_DATA_OFFSET - 8 + data_bytes));
+    put_bytes(&p, "WAVE", 4);
+
+    put_bytes(&p, "fmt ", 4);
+    put_u32(&p, 18);
+    put_format(&p, sample_rate);
+
+    put_bytes(&p, "fact", 4);
+    put_u32(&p, 4);
+    put_u32(&p, (guint32)(data_bytes / (2 * sizeof(float))));
+
+    guint8 *data_chunk = header + ARIEL_RECORDER_DATA_OFFSET - 8;
+    put_bytes(&p, "JUNK", 4);
+    put_u32(&p, (guint32)(data_chunk - p - 4));
+
+    p = data_chunk;
+    put_bytes(&p, "data", 4);
+    put_u32(&p, (guint32)data_bytes);
+}
+
+static const guint8 w64_riff[16] = { 'r', 'i', 'f', 'f', 0x2E, 0x91, 0xCF, 0x11,
+                                     0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00 };
+static const guint8 w64_wave[16] = { 'w', 'a', 'v', 'e', 0xF3, 0xAC, 0xD3, 0x11,
+                                     0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+static const guint8 w64_fmt[16]  = { 'f', 'm', 't', ' ', 0xF3, 0xAC, 0xD3, 0x11,
+                                     0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+static const guint8 w64_junk[16] = { 'j', 'u', 'n', 'k', 0xF3, 0xAC, 0xD3, 0x11,
+                                     0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+static const guint8 w64_data[16] = { 'd', 'a', 't', 'a', 0xF3, 0xAC, 0xD3, 0x11,
+                                     0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A };
+
+// Wave64 header; chunk sizes include their 24-byte headers and chunks are
+// 8-byte aligned
+static void
+ariel_recorder_build_w64_header(guint8 *header, guint sample_rate, guint64 data_bytes)
+{
+    guint8 *p = header;
+
+    put_bytes(&p, w64_riff, 16);
+    put_u64(&p, ARIEL_RECORDER_DATA_OFFSET + data_bytes);
+    put_bytes(&p, w64_wave, 16);
+
+    put_bytes(&p, w64_fmt, 16);
+    put_u64(&p, 24 + 18);
+    put_format(&p, sample_rate);
+    p += 6;
+
+    guint8 *data_chunk = header + ARIEL_RECORDER_DATA_OFFSET - 24;
+    guint64 junk_size = (guint64)(data_chunk - p);
+    put_bytes(&p, w64_junk, 16);
+    put_u64(&p, junk_size);
+
+    p = data_chunk;
+    put_bytes(&p, w64_data, 16);
+    put_u64(&p, 24 + data_bytes);
+}
+
+// Write the header, trim the reservation and close (writer thread)
+static void
+ariel_recorder_file_finish(ArielRecorderFile *file, guint sample_rate)
+{
+    if (file->fd < 0) {
+        return;
+    }
+
+    gboolean w64 = file->data_bytes > G_MAXUINT32 - ARIEL_RECORDER_DATA_OFFSET;
+    guint8 *header = g_malloc0(ARIEL_RECORDER_DATA_OFFSET);
+
+    if (w64) {
+        ariel_recorder_build_w64_header(header, sample_rate, file->data_bytes);
+    } else {
+        ariel_recorder_build_wav_header(header, sample_rate, file->data_bytes);
+    }
+
+    if (pwrite(file->fd, header, ARIEL_RECORDER_DATA_OFFSET, 0) != ARIEL_RECORDER_DATA_OFFSET) {
+        g_warning("Could not write the header of %s: %s", file->path, g_strerror(errno));
+    }
+    g_free(header);
+
+    if (ftruncate(file->fd, (off_t)(ARIEL_RECORDER_DATA_OFFSET + file->data_bytes)) != 0) {
+        g_warning("Could not trim %s: %s", file->path, g_strerror(errno));
+    }
+    close(file->fd);
+    file->fd = -1;
+
+    if (w64 && g_str_has_suffix(file->path, ".wav")) {
+        char *w64_path = g_strdup(file->path);
+        strcpy(w64_path + strlen(w64_path) - 4, ".w64");
+        if (g_rename(file->path, w64_path) == 0) {
+            g_free(file->path);
+            file->path = w64_path;
+        } else {
+            g_free(w64_path);
+        }
+    }
+
+    g_print("Recorded %.1f s to %s\n",
+            file->data_bytes / (2.0 * sizeof(float) * sample_rate), file->path);
+}
+
+// Move up to one block from the ring to the files; returns frames moved
+static guint
+ariel_recorder_drain_block(ArielRecorder *recorder)
+{
+    guint n_frames = (guint)(jack_ringbuffer_read_space(recorder->ring) / ARIEL_RECORDER_FRAME_SIZE);
+    n_frames = MIN(n_frames, ARIEL_RECORDER_BLOCK_FRAMES);
+    if (n_frames == 0) {
+        return 0;
+    }
+
+    // Frames never straddle the wrap: the ring size is a multiple of a frame
+    jack_ringbuffer_data_t vector[2];
+    jack_ringbuffer_get_read_vector(recorder->ring, vector);
+
+    float *di = recorder->files[0].block;
+    float *out = recorder->files[1].block;
+    guint frame = 0;
+
+    for (guint v = 0; v < 2 && frame < n_frames; v++) {
+        const float *src = (const float *)vector[v].buf;
+        guint available = (guint)(vector[v].len / ARIEL_RECORDER_FRAME_SIZE);
+
+        for (guint i = 0; i < available && frame < n_frames; i++, frame++) {
+            di[2 * frame] = src[4 * i];
+            di[2 * frame + 1] = src[4 * i + 1];
+            out[2 * frame] = src[4 * i + 2];
+            out[2 * frame + 1] = src[4 * i + 3];
+        }
+    }
+    jack_ringbuffer_read_advance(recorder->ring, (size_t)n_frames * ARIEL_RECORDER_FRAME_SIZE);
+
+    if (!recorder->failed) {
+        recorder->failed = !ariel_recorder_file_write(&recorder->files[0], n_frames) ||
+                           !ariel_recorder_file_write(&recorder->files[1], n_frames);
+    }
+    return n_frames;
+}
+
+static gpointer
+ariel_recorder_writer_thread(gpointer data)
+{
+    ArielRecorder *recorder = data;
+
+    while (g_atomic_int_get(&recorder->running)) {
+        // Write full blocks only, so writes stay large and aligned
+        while (jack_ringbuffer_read_space(recorder->ring) >=
+               ARIEL_RECORDER_BLOCK_FRAMES * ARIEL_RECORDER_FRAME_SIZE) {
+            ariel_recorder_drain_block(recorder);
+        }
+
+        gint overruns = g_atomic_int_get(&recorder->overruns);
+        if (overruns != recorder->reported_overruns) {
+            g_warning("Recorder overrun: %d cycles dropped, the disk is not keeping up",
+                      overruns - recorder->reported_overruns);
+            recorder->reported_overruns = overruns;
+        }
+
+        g_usleep(ARIEL_RECORDER_POLL_US);
+    }
+
+    // The audio thread has let go of the recorder; write out the rest
+    while (ariel_recorder_drain_block(recorder) > 0) {
+    }
+
+    ariel_recorder_file_finish(&recorder->files[0], recorder->sample_rate);
+    ariel_recorder_file_finish(&recorder->files[1], recorder->sample_rate);
+    return NULL;
+}
+
+// Create the files <prefix>-di.wav and <prefix>-out.wav and start the
+// writer thread. The recorder does nothing until the engine runs it.
+ArielRecorder *
+ariel_recorder_new(const char *prefix, guint sample_rate)
+{
+    g_return_val_if_fail(prefix != NULL && sample_rate > 0, NULL);
+
+    ArielRecorder *recorder = g_new0(ArielRecorder, 1);
+    recorder->sample_rate = sample_rate;
+    recorder->files[0].fd = -1;
+    recorder->files[1].fd = -1;
+
+    char *di_path = g_strdup_printf("%s-di.wav", prefix);
+    char *out_path = g_strdup_printf("%s-out.wav", prefix);
+    gboolean opened = ariel_recorder_file_open(&recorder->files[0], di_path) &&
+                      ariel_recorder_file_open(&recorder->files[1], out_path);
+    g_free(di_path);
+    g_free(out_path);
+
+    if (!opened) {
+        for (guint i = 0; i < 2; i++) {
+            if (recorder->files[i].fd >= 0) {
+                close(recorder->files[i].fd);
+                g_unlink(recorder->files[i].path);
+            }
+            g_free(recorder->files[i].path);
+            free(recorder->files[i].block);
+        }
+        g_free(recorder);
+        return NULL;
+    }
+
+    recorder->ring = jack_ringbuffer_create((size_t)sample_rate * ARIEL_RECORDER_RING_SECONDS *
+                                            ARIEL_RECORDER_FRAME_SIZE);
+    jack_ringbuffer_mlock(recorder->ring);
+
+    recorder->running = 1;
+    recorder->writer = g_thread_new("ariel-recorder", ariel_recorder_writer_thread, recorder);
+
+    g_print("Recording to %s and %s\n", recorder->files[0].path, recorder->files[1].path);
+    return recorder;
+}
+
+// Stop the writer once it has written everything, finish the files and
+// free the recorder. The audio thread must no longer be using it.
+void
+ariel_recorder_free(ArielRecorder *recorder)
+{
+    if (!recorder) return;
+
+    g_atomic_int_set(&recorder->running, 0);
+    g_thread_join(recorder->writer);
+
+    gint overruns = g_atomic_int_get(&recorder->overruns);
+    if (overruns > 0) {
+        g_warning("Recording lost %d cycles to overruns", overruns);
+    }
+
+    for (guint i = 0; i < 2; i++) {
+        g_free(recorder->files[i].path);
+        free(recorder->files[i].block);
+    }
+    jack_ringbuffer_free(recorder->ring);
+    g_free(recorder);
+}
+
+// Queue one cycle of input and output (audio thread). Missing inputs are
+// recorded as silence. Never blocks: a full ring drops the cycle.
+void
+ariel_recorder_write(ArielRecorder *recorder, const float *in_L, const float *in_R,
+                     const float *out_L, const float *out_R, jack_nframes_t nframes)
+{
+    size_t size = (size_t)nframes * ARIEL_RECORDER_FRAME_SIZE;
+    if (jack_ringbuffer_write_space(recorder->ring) < size) {
+        g_atomic_int_inc(&recorder->overruns);
+        return;
+    }
+
+    jack_ringbuffer_data_t vector[2];
+    jack_ringbuffer_get_write_vector(recorder->ring, vector);
+
+    jack_nframes_t frame = 0;
+    for (guint v = 0; v < 2 && frame < nframes; v++) {
+        float *dst = (float *)vector[v].buf;
+        jack_nframes_t available = (jack_nframes_t)(vector[v].len / ARIEL_RECORDER_FRAME_SIZE);
+
+        for (jack_nframes_t i = 0; i < available && frame < nframes; i++, frame++) {
+            dst[4 * i] = in_L ? in_L[frame] : 0.0f;
+            dst[4 * i + 1] = in_R ? in_R[frame] : 0.0f;
+            dst[4 * i + 2] = out_L[frame];
+            dst[4 * i + 3] = out_R[frame];
+        }
+    }
+    jack_ringbuffer_write_advance(recorder->ring, size);
+}
+
+// Retrospective capture
+
+#define ARIEL_CAPTURE_SLACK_SECONDS   5              // Kept out of a save, so it can outrun the audio thread
+#define ARIEL_CAPTURE_MAX_CYCLE       8192           // Largest cycle, for the overwrite check
+
+struct _ArielCapture {
+    gint ref_count;                      // Atomic; a save in progress holds one
+    guint sample_rate;
+    guint capacity;                      // Frames per channel
+    float *data;
+    float *channels[ARIEL_RECORDER_CHANNELS];
+    gboolean locked;
+    guint write_index;                   // Next frame written; atomic
+    guint frames_written;                // Wraps; atomic
+    guint filled;                        // Frames held, up to capacity; atomic
+    gint saving;                         // One save at a time; atomic
+};
+
+typedef struct {
+    ArielCapture *capture;
+    guint n_frames;
+    guint start_index;
+    guint start_written;
+    ArielRecorderFile files[2];
+} ArielCaptureSave;
+
+// Allocate a ring for the given length. The memory is touched (and locked,
+// if asked and allowed) here, so the audio thread never faults on it.
+ArielCapture *
+ariel_capture_new(guint sample_rate, guint seconds, gboolean lock_memory)
+{
+    g_return_val_if_fail(sample_rate > 0 && seconds > 0, NULL);
+
+    ArielCapture *capture = g_new0(ArielCapture, 1);
+    capture->ref_count = 1;
+    capture->sample_rate = sample_rate;
+    capture->capacity = sample_rate * (seconds + ARIEL_CAPTURE_SLACK_SECONDS);
+
+    gsize size = (gsize)capture->capacity * ARIEL_RECORDER_CHANNELS * sizeof(float);
+    capture->data = g_try_malloc(size);
+    if (!capture->data) {
+        g_warning("Could not allocate %" G_GSIZE_FORMAT " MiB for the capture buffer", size >> 20);
+        g_free(capture);
+        return NULL;
+    }
+    memset(capture->data, 0, size);
+
+    for (guint c = 0; c < ARIEL_RECORDER_CHANNELS; c++) {
+        capture->channels[c] = capture->data + (gsize)c * capture->capacity;
+    }
+
+    if (lock_memory) {
+        capture->locked = mlock(capture->data, size) == 0;
+        if (!capture->locked) {
+            g_warning("Could not lock the capture buffer in memory: %s", g_strerror(errno));
+        }
+    }
+
+    g_print("Capture buffer: last %u s of input and output, %" G_GSIZE_FORMAT " MiB%s\n",
+            seconds, size >> 20, capture->locked ? ", locked" : "");
+    return capture;
+}
+
+ArielCapture *
+ariel_capture_ref(ArielCapture *capture)
+{
+    g_atomic_int_inc(&capture->ref_count);
+    return capture;
+}
+
+void
+ariel_capture_unref(ArielCapture *capture)
+{
+    if (!capture || !g_atomic_int_dec_and_test(&capture->ref_count)) return;
+
+    gsize size = (gsize)capture->capacity * ARIEL_RECORDER_CHANNELS * sizeof(float);
+    if (capture->locked) {
+        munlock(capture->data, size);
+    }
+    g_free(capture->data);
+    g_free(capture);
+}
+
+// Copy one cycle of input and output into the ring (audio thread). Missing
+// inputs are captured as silence.
+void
+ariel_capture_write(ArielCapture *capture, const float *in_L, const float *in_R,
+                    const float *out_L, const float *out_R, jack_nframes_t nframes)
+{
+    const float *sources[ARIEL_RECORDER_CHANNELS] = { in_L, in_R, out_L, out_R };
+    guint index = (guint)g_atomic_int_get(&capture->write_index);
+    guint first = MIN(nframes, capture->capacity - index);
+    guint rest = nframes - first;
+
+    for (guint c = 0; c < ARIEL_RECORDER_CHANNELS; c++) {
+        float *dst = capture->channels[c];
+        if (sources[c]) {
+            ariel_dsp_copy(dst + index, sources[c], first);
+            ariel_dsp_copy(dst, sources[c] + first, rest);
+        } else {
+            ariel_dsp_fill(dst + index, 0.0f, first);
+            ariel_dsp_fill(dst, 0.0f, rest);
+        }
+    }
+
+    guint next = rest > 0 ? rest : index + first;
+    guint filled = (guint)g_atomic_int_get(&capture->filled);
+    g_atomic_int_set(&capture->write_index, (gint)(next == capture->capacity ? 0 : next));
+    g_atomic_int_set(&capture->filled, (gint)MIN(filled + nframes, capture->capacity));
+    g_atomic_int_add(&capture->frames_written, (gint)nframes);
+}
+
+static gpointer
+ariel_capture_save_thread(gpointer data)
+{
+    ArielCaptureSave *save = data;
+    ArielCapture *capture = save->capture;
+    guint saved = 0;
+
+    while (saved < save->n_frames) {
+        guint n_frames = MIN(save->n_frames - saved, ARIEL_RECORDER_BLOCK_FRAMES);
+        float *di = save->files[0].block;
+        float *out = save->files[1].block;
+
+        for (guint i = 0; i < n_frames; i++) {
+            guint index = (save->start_index + saved + i) % capture->capacity;
+            di[2 * i] = capture->channels[0][index];
+            di[2 * i + 1] = capture->channels[1][index];
+            out[2 * i] = capture->channels[2][index];
+            out[2 * i + 1] = capture->channels[3][index];
+        }
+
+        // The audio thread eats into the take from its start once it has
+        // used up the slack; stop if it reached frames just copied
+        guint advanced = (guint)g_atomic_int_get(&capture->frames_written) - save->start_written;
+        if (advanced + ARIEL_CAPTURE_MAX_CYCLE > capture->capacity - save->n_frames + saved) {
+            g_warning("Capture save fell behind the audio thread; the take is cut short");
+            break;
+        }
+
+        if (!ariel_recorder_file_write(&save->files[0], n_frames) ||
+            !ariel_recorder_file_write(&save->files[1], n_frames)) {
+            break;
+        }
+        saved += n_frames;
+    }
+
+    ariel_recorder_file_finish(&save->files[0], capture->sample_rate);
+    ariel_recorder_file_finish(&save->files[1], capture->sample_rate);
+
+    for (guint i = 0; i < 2; i++) {
+        g_free(save->files[i].path);
+        free(save->files[i].block);
+    }
+    g_atomic_int_set(&capture->saving, 0);
+    ariel_capture_unref(capture);
+    g_free(save);
+    return NULL;
+}
+
+static gboolean
+ariel_capture_fits(ArielCapture *capture, guint sample_rate, guint seconds)
+{
+    return capture && capture->sample_rate == sample_rate &&
+           capture->capacity == sample_rate * (seconds + ARIEL_CAPTURE_SLACK_SECONDS);
+}
+
+// Write the last seconds held in the ring (all of it for 0) to
+// <prefix>-di.wav and <prefix>-out.wav on a background thread
+gboolean
+ariel_capture_save(ArielCapture *capture, const char *prefix, guint seconds)
+{
+    g_return_val_if_fail(capture != NULL && prefix != NULL, FALSE);
+
+    if (!g_atomic_int_compare_and_exchange(&capture->saving, 0, 1)) {
+        g_warning("The capture buffer is already being saved");
+        return FALSE;
+    }
+
+    // The write position first: if the audio thread moves in between, the
+    // counter read after it only makes the overwrite check stricter
+    guint end_index = (guint)g_atomic_int_get(&capture->write_index);
+    guint start_written = (guint)g_atomic_int_get(&capture->frames_written);
+    guint n_frames = (guint)g_atomic_int_get(&capture->filled);
+
+    n_frames = MIN(n_frames, capture->capacity - ARIEL_CAPTURE_SLACK_SECONDS * capture->sample_rate);
+    if (seconds > 0) {
+        n_frames = MIN(n_frames, seconds * capture->sample_rate);
+    }
+    if (n_frames == 0) {
+        g_warning("Nothing captured yet");
+        g_atomic_int_set(&capture->saving, 0);
+        return FALSE;
+    }
+
+    ArielCaptureSave *save = g_new0(ArielCaptureSave, 1);
+    save->n_frames = n_frames;
+    save->start_index = (end_index + capture->capacity - n_frames) % capture->capacity;
+    save->start_written = start_written;
+    save->files[0].fd = -1;
+    save->files[1].fd = -1;
+
+    char *di_path = g_strdup_printf("%s-di.wav", prefix);
+    char *out_path = g_strdup_printf("%s-out.wav", prefix);
+    gboolean opened = ariel_recorder_file_open(&save->files[0], di_path) &&
+                      ariel_recorder_file_open(&save->files[1], out_path);
+    g_free(di_path);
+    g_free(out_path);
+
+    if (!opened) {
+        for (guint i = 0; i < 2; i++) {
+            if (save->files[i].fd >= 0) {
+                close(save->files[i].fd);
+                g_unlink(save->files[i].path);
+            }
+            g_free(save->files[i].path);
+            free(save->files[i].block);
+        }
+        g_free(save);
+        g_atomic_int_set(&capture->saving, 0);
+        return FALSE;
+    }
+
+    g_print("Saving the last %.1f s of capture\n", (double)n_frames / capture->sample_rate);
+    save->capture = ariel_capture_ref(capture);
+    g_thread_unref(g_thread_new("ariel-capture-save", ariel_capture_save_thread, save));
+    return TRUE;
+}
+
+#else
+
+// No POSIX file I/O here; recording and capture are not available
+
+ArielRecorder *
+ariel_recorder_new(G_GNUC_UNUSED const char *prefix, G_GNUC_UNUSED guint sample_rate)
+{
+    g_warning("Recording is not supported on this platform");
+    return NULL;
+}
+
+void
+ariel_recorder_free(G_GNUC_UNUSED ArielRecorder *recorder)
+{
+}
+
+void
+ariel_recorder_write(G_GNUC_UNUSED ArielRecorder *recorder, G_GNUC_UNUSED const float *in_L,
+                     G_GNUC_UNUSED const float *in_R, G_GNUC_UNUSED const float *out_L,
+                     G_GNUC_UNUSED const float *out_R, G_GNUC_UNUSED jack_nframes_t nframes)
+{
+}
+
+ArielCapture *
+ariel_capture_new(G_GNUC_UNUSED guint sample_rate, G_GNUC_UNUSED guint seconds,
+                  G_GNUC_UNUSED gboolean lock_memory)
+{
+    return NULL;
+}
+
+ArielCapture *
+ariel_capture_ref(ArielCapture *capture)
+{
+    return capture;
+}
+
+void
+ariel_capture_unref(G_GNUC_UNUSED ArielCapture *capture)
+{
+}
+
+void
+ariel_capture_write(G_GNUC_UNUSED ArielCapture *capture, G_GNUC_UNUSED const float *in_L,
+                    G_GNUC_UNUSED const float *in_R, G_GNUC_UNUSED const float *out_L,
+                    G_GNUC_UNUSED const float *out_R, G_GNUC_UNUSED jack_nframes_t nframes)
+{
+}
+
+gboolean
+ariel_capture_save(G_GNUC_UNUSED ArielCapture *capture, G_GNUC_UNUSED const char *prefix,
+                   G_GNUC_UNUSED guint seconds)
+{
+    return FALSE;
+}
+
+static gboolean
+ariel_capture_fits(G_GNUC_UNUSED ArielCapture *capture, G_GNUC_UNUSED guint sample_rate,
+                   G_GNUC_UNUSED guint seconds)
+{
+    return FALSE;
+}
+
+#endif
+
+// Start recording the engine's input and output to <prefix>-di.wav and
+// <prefix>-out.wav, from the next cycle on
+gboolean
+ariel_audio_engine_start_recording(ArielAudioEngine *engine, const char *prefix)
+{
+    g_return_val_if_fail(engine != NULL && prefix != NULL, FALSE);
+
+    if (!engine->active || engine->sample_rate <= 0) {
+        g_warning("Cannot record - audio engine not running");
+        return FALSE;
+    }
+
+    ArielRecorder *recorder = ariel_recorder_new(prefix, (guint)engine->sample_rate);
+    if (!recorder) {
+        return FALSE;
+    }
+
+    ArielEngineCommand command = {
+        .type = ARIEL_ENGINE_COMMAND_SET_RECORDER,
+        .recorder = recorder,
+    };
+    if (!ariel_audio_engine_send_command(engine, &command)) {
+        return FALSE;
+    }
+    engine->recording = TRUE;
+    return TRUE;
+}
+
+// The files are finished once the audio thread hands the recorder back
+void
+ariel_audio_engine_stop_recording(ArielAudioEngine *engine)
+{
+    if (!engine || !engine->recording) return;
+
+    ArielEngineCommand command = {
+        .type = ARIEL_ENGINE_COMMAND_SET_RECORDER,
+        .recorder = NULL,
+    };
+    ariel_audio_engine_send_command(engine, &command);
+    engine->recording = FALSE;
+}
+
+// Size the capture ring for the engine's sample rate before the audio
+// thread starts; the ring survives engine restarts when nothing changed
+void
+ariel_audio_engine_prepare_capture(ArielAudioEngine *engine)
+{
+    g_return_if_fail(!engine->active);
+
+    guint sample_rate = (guint)engine->sample_rate;
+    guint seconds = engine->capture_minutes * 60;
+
+    if (seconds > 0 && ariel_capture_fits(engine->capture, sample_rate, seconds)) {
+        return;
+    }
+
+    ariel_capture_unref(engine->capture);
+    engine->capture = seconds > 0 && sample_rate > 0 ?
+        ariel_capture_new(sample_rate, seconds, engine->capture_lock_memory) : NULL;
+}
+
+// Save what the capture ring holds, the last capture_minutes of input and
+// output, as a take
+gboolean
+ariel_audio_engine_save_capture(ArielAudioEngine *engine, const char *prefix)
+{
+    g_return_val_if_fail(engine != NULL && prefix != NULL, FALSE);
+
+    if (!engine->capture) {
+        g_warning("The capture buffer is off");
+        return FALSE;
+    }
+    return ariel_capture_save(engine->capture, prefix, 0);
+}
@@ -0,0 +1,587 @@
+#include "ariel.h"
+#include <math.h>
+#include <string.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+// Scenes.
+//
+// A scene is a named snapshot of every control input and bypass state in
+// the chain, kept as one flat float array with per-plugin offsets. Recall
+// pairs that array with the plugins now in the chain and hands the result
+// to the audio thread as a single engine command, which applies all of it
+// at one cycle boundary: no cycle ever runs with half a scene applied.
+// Scenes belong to the chain and are stored in chain presets as
+// [scene_N] groups.
+//
+// Two scenes can also be morphed: both are compiled into parallel value
+// vectors sorted by how each control moves, and the audio thread
+// interpolates the whole set once per cycle whenever the morph position
+// (an atomic in the engine, written by the UI or a controller) changes.
+// A morph is compiled against the chain as it is when armed.
+
+typedef struct {
+    char *name;
+    guint n_plugins;
+    char **uris;          // Plugin URI per chain position, NULL-terminated
+    guint *offsets;       // Into values
+    guint *counts;
+    gboolean *bypass;
+    guint n_values;
+    float *values;
+} ArielScene;
+
+struct _ArielSceneBank {
+    GPtrArray *scenes;    // ArielScene
+    ArielSceneRecalledFunc recalled_func;
+    gpointer recalled_data;
+};
+
+static void
+ariel_scene_free(gpointer data)
+{
+    ArielScene *scene = data;
+
+    g_free(scene->name);
+    g_strfreev(scene->uris);
+    g_free(scene->offsets);
+    g_free(scene->counts);
+    g_free(scene->bypass);
+    g_free(scene->values);
+    g_free(scene);
+}
+
+static ArielScene *
+ariel_scene_new(const char *name, guint n_plugins)
+{
+    ArielScene *scene = g_malloc0(sizeof(ArielScene));
+
+    scene->name = g_strdup(name);
+    scene->n_plugins = n_plugins;
+    scene->uris = g_new0(char *, n_plugins + 1);
+    scene->offsets = g_new0(guint, MAX(n_plugins, 1));
+    scene->counts = g_new0(guint, MAX(n_plugins, 1));
+    scene->bypass = g_new0(gboolean, MAX(n_plugins, 1));
+    return scene;
+}
+
+ArielSceneBank *
+ariel_scene_bank_new(void)
+{
+    ArielSceneBank *bank = g_malloc0(sizeof(ArielSceneBank));
+    bank->scenes = g_ptr_array_new_with_free_func(ariel_scene_free);
+    return bank;
+}
+
+void
+ariel_scene_bank_free(ArielSceneBank *bank)
+{
+    if (!bank) return;
+
+    g_ptr_array_free(bank->scenes, TRUE);
+    g_free(bank);
+}
+
+// Called on the main thread after every recall, e.g. to refresh controls
+void
+ariel_scene_bank_set_recalled_func(ArielSceneBank *bank, ArielSceneRecalledFunc func, gpointer user_data)
+{
+    g_return_if_fail(bank != NULL);
+
+    bank->recalled_func = func;
+    bank->recalled_data = user_data;
+}
+
+guint
+ariel_scene_bank_get_n_scenes(ArielSceneBank *bank)
+{
+    return bank ? bank->scenes->len : 0;
+}
+
+const char *
+ariel_scene_bank_get_name(ArielSceneBank *bank, guint index)
+{
+    g_return_val_if_fail(bank != NULL && index < bank->scenes->len, NULL);
+
+    ArielScene *scene = g_ptr_array_index(bank->scenes, index);
+    return scene->name;
+}
+
+// Index of the scene with this name, or -1
+gint
+ariel_scene_bank_find(ArielSceneBank *bank, const char *name)
+{
+    for (guint i = 0; bank && name && i < bank->scenes->len; i++) {
+        ArielScene *scene = g_ptr_array_index(bank->scenes, i);
+        if (g_str_equal(scene->name, name)) {
+            return (gint)i;
+        }
+    }
+    return -1;
+}
+
+// Keep a scene in the bank, replacing one of the same name in place
+static gint
+ariel_scene_bank_put(ArielSceneBank *bank, ArielScene *scene)
+{
+    gint index = ariel_scene_bank_find(bank, scene->name);
+
+    if (index >= 0) {
+        ariel_scene_free(bank->scenes->pdata[index]);
+        bank->scenes->pdata[index] = scene;
+        return index;
+    }
+
+    g_ptr_array_add(bank->scenes, scene);
+    return (gint)bank->scenes->len - 1;
+}
+
+// Snapshot the chain's controls and bypass states as a scene. Returns the
+// scene's index.
+gint
+ariel_scene_bank_capture(ArielSceneBank *bank, ArielPluginManager *manager, const char *name)
+{
+    g_return_val_if_fail(bank != NULL && manager != NULL && name != NULL, -1);
+
+    GListModel *model = G_LIST_MODEL(manager->active_plugin_store);
+    guint n_plugins = g_list_model_get_n_items(model);
+    if (n_plugins == 0) {
+        return -1;
+    }
+
+    ArielScene *scene = ariel_scene_new(name, n_plugins);
+
+    for (guint i = 0; i < n_plugins; i++) {
+        ArielActivePlugin *plugin = g_list_model_get_item(model, i);
+        ArielPluginInfo *info = ariel_active_plugin_get_plugin_info(plugin);
+
+        scene->uris[i] = g_strdup(ariel_plugin_info_get_uri(info));
+        scene->offsets[i] = scene->n_values;
+        scene->counts[i] = ariel_active_plugin_get_num_parameters(plugin);
+        scene->bypass[i] = ariel_active_plugin_get_bypass(plugin);
+        scene->n_values += scene->counts[i];
+
+        g_object_unref(info);
+        g_object_unref(plugin);
+    }
+
+    scene->values = g_new0(float, MAX(scene->n_values, 1));
+    for (guint i = 0; i < n_plugins; i++) {
+        ArielActivePlugin *plugin = g_list_model_get_item(model, i);
+        for (guint j = 0; j < scene->counts[i]; j++) {
+            scene->values[scene->offsets[i] + j] = ariel_active_plugin_get_parameter(plugin, j);
+        }
+        g_object_unref(plugin);
+    }
+
+    g_print("Captured scene '%s' (%u plugins, %u controls)\n", name, n_plugins, scene->n_values);
+    return ariel_scene_bank_put(bank, scene);
+}
+
+void
+ariel_scene_bank_remove(ArielSceneBank *bank, guint index)
+{
+    g_return_if_fail(bank != NULL && index < bank->scenes->len);
+    g_ptr_array_remove_index(bank->scenes, index);
+}
+
+void
+ariel_scene_recall_free(ArielSceneRecall *recall)
+{
+    if (!recall) return;
+
+    for (guint i = 0; i < recall->n_plugins; i++) {
+        g_object_unref(recall->plugins[i]);
+    }
+    g_free(recall->plugins);
+    g_free(recall->offsets);
+    g_free(recall->counts);
+    g_free(recall->bypass);
+    g_free(recall->values);
+    g_free(recall);
+}
+
+// Pair a scene with the plugins now in the chain. Positions whose plugin
+// changed since the scene was captured are left alone.
+static ArielSceneRecall *
+ariel_scene_compile(ArielScene *scene, ArielPluginManager *manager)
+{
+    GListModel *model = G_LIST_MODEL(manager->active_plugin_store);
+    guint n_plugins = MIN(scene->n_plugins, g_list_model_get_n_items(model));
+    ArielSceneRecall *recall = g_malloc0(sizeof(ArielSceneRecall));
+
+    recall->plugins = g_new0(ArielActivePlugin *, MAX(n_plugins, 1));
+    recall->offsets = g_new0(guint, MAX(n_plugins, 1));
+    recall->counts = g_new0(guint, MAX(n_plugins, 1));
+    recall->bypass = g_new0(gboolean, MAX(n_plugins, 1));
+    recall->values = g_new(float, MAX(scene->n_values, 1));
+    memcpy(recall->values, scene->values, sizeof(float) * scene->n_values);
+
+    for (guint i = 0; i < n_plugins; i++) {
+        ArielActivePlugin *plugin = g_list_model_get_item(model, i);
+        ArielPluginInfo *info = ariel_active_plugin_get_plugin_info(plugin);
+        gboolean same_plugin = g_strcmp0(ariel_plugin_info_get_uri(info), scene->uris[i]) == 0;
+        g_object_unref(info);
+
+        if (!same_plugin) {
+            g_object_unref(plugin);
+            continue;
+        }
+
+        // The recall keeps the reference taken by get_item
+        guint slot = recall->n_plugins++;
+        recall->plugins[slot] = plugin;
+        recall->offsets[slot] = scene->offsets[i];
+        recall->counts[slot] = MIN(scene->counts[i], ariel_active_plugin_get_num_parameters(plugin));
+        recall->bypass[slot] = scene->bypass[i];
+    }
+
+    return recall;
+}
+
+// Apply a scene to the running chain in a single audio cycle
+gboolean
+ariel_scene_bank_recall(ArielSceneBank *bank, ArielPluginManager *manager, ArielAudioEngine *engine, guint index)
+{
+    g_return_val_if_fail(bank != NULL && manager != NULL && engine != NULL, FALSE);
+
+    if (index >= bank->scenes->len) {
+        g_warning("No scene %u", index + 1);
+        return FALSE;
+    }
+
+    ArielScene *scene = g_ptr_array_index(bank->scenes, index);
+    ArielSceneRecall *recall = ariel_scene_compile(scene, manager);
+
+    if (recall->n_plugins == 0) {
+        g_warning("Scene '%s' does not match the current chain", scene->name);
+        ariel_scene_recall_free(recall);
+        return FALSE;
+    }
+
+    ArielEngineCommand command = {
+        .type = ARIEL_ENGINE_COMMAND_RECALL_SCENE,
+        .scene = recall,
+    };
+    if (!ariel_audio_engine_send_command(engine, &command)) {
+        return FALSE;
+    }
+
+    g_print("Recalled scene '%s'\n", scene->name);
+    if (bank->recalled_func) {
+        bank->recalled_func(index, bank->recalled_data);
+    }
+    return TRUE;
+}
+
+// Recall by name, or by 1-based number if no scene has that name
+gboolean
+ariel_scene_bank_recall_by_name(ArielSceneBank *bank, ArielPluginManager *manager, ArielAudioEngine *engine,
+                                const char *name)
+{
+    g_return_val_if_fail(name != NULL, FALSE);
+
+    gint index = ariel_scene_bank_find(bank, name);
+    if (index < 0) {
+        char *end = NULL;
+        guint64 number = g_ascii_strtoull(name, &end, 10);
+        if (end == name || *end != '\0' || number == 0) {
+            g_warning("No scene named '%s'", name);
+            return FALSE;
+        }
+        index = (gint)(number - 1);
+    }
+
+    return ariel_scene_bank_recall(bank, manager, engine, (guint)index);
+}
+
+// Store every scene as a [scene_N] group of a chain preset
+void
+ariel_scene_bank_save_to_keyfile(ArielSceneBank *bank, GKeyFile *keyfile)
+{
+    if (!bank) return;
+
+    g_key_file_set_integer(keyfile, "chain", "scene_count", (gint)bank->scenes->len);
+
+    for (guint i = 0; i < bank->scenes->len; i++) {
+        ArielScene *scene = g_ptr_array_index(bank->scenes, i);
+        char *group = g_strdup_printf("scene_%u", i);
+
+        g_key_file_set_string(keyfile, group, "name", scene->name);
+        g_key_file_set_integer(keyfile, group, "plugin_count", (gint)scene->n_plugins);
+
+        for (guint j = 0; j < scene->n_plugins; j++) {
+            char *uri_key = g_strdup_printf("uri_%u", j);
+            char *bypass_key = g_strdup_printf("bypass_%u", j);
+            char *values_key = g_strdup_printf("values_%u", j);
+            gdouble *values = g_new(gdouble, MAX(scene->counts[j], 1));
+
+            for (guint k = 0; k < scene->counts[j]; k++) {
+                values[k] = scene->values[scene->offsets[j] + k];
+            }
+
+            g_key_file_set_string(keyfile, group, uri_key, scene->uris[j]);
+            g_key_file_set_boolean(keyfile, group, bypass_key, scene->bypass[j]);
+            g_key_file_set_double_list(keyfile, group, values_key, values, scene->counts[j]);
+
+            g_free(values);
+            g_free(values_key);
+            g_free(bypass_key);
+            g_free(uri_key);
+        }
+        g_free(group);
+    }
+}
+
+// Replace the bank with the scenes stored in a chain preset
+void
+ariel_scene_bank_load_from_keyfile(ArielSceneBank *bank, GKeyFile *keyfile)
+{
+    if (!bank) return;
+
+    g_ptr_array_set_size(bank->scenes, 0);
+    gint n_scenes = g_key_file_get_integer(keyfile, "chain", "scene_count", NULL);
+
+    for (gint i = 0; i < n_scenes; i++) {
+        char *group = g_strdup_printf("scene_%d", i);
+        char *name = g_key_file_get_string(keyfile, group, "name", NULL);
+        gint n_plugins = g_key_file_get_integer(keyfile, group, "plugin_count", NULL);
+
+        if (!name || n_plugins < 0) {
+            g_free(name);
+            g_free(group);
+            continue;
+        }
+
+        ArielScene *scene = ariel_scene_new(name, (guint)n_plugins);
+        GPtrArray *plugin_values = g_ptr_array_new_with_free_func(g_free);
+
+        for (guint j = 0; j < scene->n_plugins; j++) {
+            char *uri_key = g_strdup_printf("uri_%u", j);
+            char *bypass_key = g_strdup_printf("bypass_%u", j);
+            char *values_key = g_strdup_printf("values_%u", j);
+            gsize count = 0;
+
+            scene->uris[j] = g_key_file_get_string(keyfile, group, uri_key, NULL);
+            if (!scene->uris[j]) {
+                scene->uris[j] = g_strdup("");
+            }
+            scene->bypass[j] = g_key_file_get_boolean(keyfile, group, bypass_key, NULL);
+            g_ptr_array_add(plugin_values, g_key_file_get_double_list(keyfile, group, values_key, &count, NULL));
+            scene->offsets[j] = scene->n_values;
+            scene->counts[j] = (guint)count;
+            scene->n_values += (guint)count;
+
+            g_free(values_key);
+            g_free(bypass_key);
+            g_free(uri_key);
+        }
+
+        // Flatten, so recall is one copy
+        scene->values = g_new0(float, MAX(scene->n_values, 1));
+        for (guint j = 0; j < scene->n_plugins; j++) {
+            const gdouble *values = g_ptr_array_index(plugin_values, j);
+            for (guint k = 0; k < scene->counts[j]; k++) {
+                scene->values[scene->offsets[j] + k] = (float)values[k];
+            }
+        }
+
+        g_ptr_array_free(plugin_values, TRUE);
+        ariel_scene_bank_put(bank, scene);
+        g_free(name);
+        g_free(group);
+    }
+}
+
+// Morph kind of one value: log interpolation needs both ends positive
+static ArielControlKind
+ariel_scene_morph_kind(ArielActivePlugin *plugin, guint index, float from, float to)
+{
+    ArielControlKind kind = ariel_active_plugin_get_control_kind(plugin, index);
+
+    if (kind == ARIEL_CONTROL_LOGARITHMIC && (from <= 0.0f || to <= 0.0f)) {
+        return ARIEL_CONTROL_LINEAR;
+    }
+    return kind;
+}
+
+void
+ariel_scene_morph_free(ArielSceneMorph *morph)
+{
+    if (!morph) return;
+
+    for (guint i = 0; i < morph->n_plugins; i++) {
+        g_object_unref(morph->plugins[i]);
+    }
+    g_free(morph->plugins);
+    g_free(morph->bypass_from);
+    g_free(morph->bypass_to);
+    g_free(morph->from);
+    g_free(morph->to);
+    g_free(morph->scratch);
+    g_free(morph->targets);
+    g_free(morph);
+}
+
+// Pair two scenes with the plugins now in the chain. Only positions where
+// both scenes and the chain hold the same plugin take part.
+static ArielSceneMorph *
+ariel_scene_morph_compile(ArielScene *from, ArielScene *to, ArielPluginManager *manager)
+{
+    GListModel *model = G_LIST_MODEL(manager->active_plugin_store);
+    guint n_plugins = MIN(MIN(from->n_plugins, to->n_plugins), g_list_model_get_n_items(model));
+    ArielSceneMorph *morph = g_malloc0(sizeof(ArielSceneMorph));
+    guint *positions = g_new0(guint, MAX(n_plugins, 1));
+    guint *counts = g_new0(guint, MAX(n_plugins, 1));
+
+    morph->plugins = g_new0(ArielActivePlugin *, MAX(n_plugins, 1));
+    morph->bypass_from = g_new0(gboolean, MAX(n_plugins, 1));
+    morph->bypass_to = g_new0(gboolean, MAX(n_plugins, 1));
+    morph->position = -1.0f;
+
+    for (guint i = 0; i < n_plugins; i++) {
+        ArielActivePlugin *plugin = g_list_model_get_item(model, i);
+        ArielPluginInfo *info = ariel_active_plugin_get_plugin_info(plugin);
+        const char *uri = ariel_plugin_info_get_uri(info);
+        gboolean same_plugin = g_strcmp0(uri, from->uris[i]) == 0 && g_strcmp0(uri, to->uris[i]) == 0;
+        g_object_unref(info);
+
+        if (!same_plugin) {
+            g_object_unref(plugin);
+            continue;
+        }
+
+        guint slot = morph->n_plugins++;
+        morph->plugins[slot] = plugin;
+        morph->bypass_from[slot] = from->bypass[i];
+        morph->bypass_to[slot] = to->bypass[i];
+        positions[slot] = i;
+        counts[slot] = MIN(MIN(from->counts[i], to->counts[i]), ariel_active_plugin_get_num_parameters(plugin));
+        morph->n_values += counts[slot];
+    }
+
+    morph->from = g_new(float, MAX(morph->n_values, 1));
+    morph->to = g_new(float, MAX(morph->n_values, 1));
+    morph->scratch = g_new(float, MAX(morph->n_values, 1));
+    morph->targets = g_new(float *, MAX(morph->n_values, 1));
+
+    // One pass per kind, so each kind ends up contiguous
+    static const ArielControlKind kinds[] = {
+        ARIEL_CONTROL_LINEAR, ARIEL_CONTROL_LOGARITHMIC, ARIEL_CONTROL_STEPPED
+    };
+    guint cursor = 0;
+
+    for (guint k = 0; k < G_N_ELEMENTS(kinds); k++) {
+        guint start = cursor;
+
+        for (guint slot = 0; slot < morph->n_plugins; slot++) {
+            ArielActivePlugin *plugin = morph->plugins[slot];
+            float *controls = ariel_active_plugin_get_control_inputs(plugin);
+            const float *from_values = from->values + from->offsets[positions[slot]];
+            const float *to_values = to->values + to->offsets[positions[slot]];
+
+            for (guint j = 0; j < counts[slot]; j++) {
+                if (ariel_scene_morph_kind(plugin, j, from_values[j], to_values[j]) != kinds[k]) {
+                    continue;
+                }
+
+                gboolean logarithmic = kinds[k] == ARIEL_CONTROL_LOGARITHMIC;
+                morph->from[cursor] = logarithmic ? logf(from_values[j]) : from_values[j];
+                morph->to[cursor] = logarithmic ? logf(to_values[j]) : to_values[j];
+                morph->targets[cursor] = controls + j;
+                cursor++;
+            }
+        }
+
+        if (kinds[k] == ARIEL_CONTROL_LINEAR) {
+            morph->n_linear = cursor - start;
+        } else if (kinds[k] == ARIEL_CONTROL_LOGARITHMIC) {
+            morph->n_log = cursor - start;
+        }
+    }
+
+    g_free(counts);
+    g_free(positions);
+    return morph;
+}
+
+// out = from + (to - from) * t, four lanes at a time where SSE is available
+static void
+ariel_scene_morph_lerp(float *out, const float *from, const float *to, float t, guint n)
+{
+    guint i = 0;
+
+#ifdef __SSE__
+    const __m128 vt = _mm_set1_ps(t);
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_loadu_ps(from + i);
+        __m128 b = _mm_loadu_ps(to + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), vt)));
+    }
+#endif
+
+    for (; i < n; i++) {
+        out[i] = from[i] + (to[i] - from[i]) * t;
+    }
+}
+
+// Move every morphed control to a position between 0 (the first scene)
+// and 1 (the second). Runs on the audio thread, so it must not allocate,
+// lock or print.
+void
+ariel_scene_morph_apply(ArielSceneMorph *morph, float position)
+{
+    guint n_interpolated = morph->n_linear + morph->n_log;
+    gboolean second_half = position >= 0.5f;
+
+    ariel_scene_morph_lerp(morph->scratch, morph->from, morph->to, position, n_interpolated);
+    for (guint i = morph->n_linear; i < n_interpolated; i++) {
+        morph->scratch[i] = expf(morph->scratch[i]);
+    }
+    for (guint i = n_interpolated; i < morph->n_values; i++) {
+        morph->scratch[i] = second_half ? morph->to[i] : morph->from[i];
+    }
+
+    for (guint i = 0; i < morph->n_values; i++) {
+        *morph->targets[i] = morph->scratch[i];
+    }
+    for (guint i = 0; i < morph->n_plugins; i++) {
+        ariel_active_plugin_apply_controls(morph->plugins[i], NULL, 0,
+                                           second_half ? morph->bypass_to[i] : morph->bypass_from[i]);
+    }
+
+    morph->position = position;
+}
+
+// Arm a morph between two scenes; the engine's morph position then moves
+// the chain between them
+gboolean
+ariel_scene_bank_morph(ArielSceneBank *bank, ArielPluginManager *manager, ArielAudioEngine *engine,
+                       guint from, guint to)
+{
+    g_return_val_if_fail(bank != NULL && manager != NULL && engine != NULL, FALSE);
+
+    if (from >= bank->scenes->len || to >= bank->scenes->len) {
+        g_warning("No scene %u", MAX(from, to) + 1);
+        return FALSE;
+    }
+
+    ArielScene *scene_from = g_ptr_array_index(bank->scenes, from);
+    ArielScene *scene_to = g_ptr_array_index(bank->scenes, to);
+    ArielSceneMorph *morph = ariel_scene_morph_compile(scene_from, scene_to, manager);
+
+    if (morph->n_plugins == 0) {
+        g_warning("Scenes '%s' and '%s' do not match the current chain", scene_from->name, scene_to->name);
+        ariel_scene_morph_free(morph);
+        return FALSE;
+    }
+
+    guint n_values = morph->n_values;
+    if (!ariel_audio_engine_set_morph(engine, morph)) {
+        return FALSE;
+    }
+
+    g_print("Morphing between scenes '%s' and '%s' (%u controls)\n", scene_from->name, scene_to->name, n_values);
+    return TRUE;
+}
@@ -0,0 +1,191 @@
+#include "ariel.h"
+#include <math.h>
+
+// Slot mix stage.
+//
+// Every slot of the chain has a host-side stage around its plugin: input
+// gain before it, then a dry/wet blend, output gain and pan after it, so
+// parallel compression or an ambient blend needs no extra mixing plugins.
+// The main thread writes the settings as atomics; at the start of each
+// block the audio thread turns them into per-channel gains and ramps from
+// last block's gains to the new ones across the block, so moving a
+// control never clicks. The dry copy and the input gain share one pass
+// over the buffer, as do the blend, output gain and pan. A stage at unity
+// with nothing left to ramp does not touch the buffers at all. Both
+// passes are ariel_dsp kernels.
+
+struct _ArielSlotStage {
+    // Settings, as float bits; written by the main thread
+    gint input_gain;
+    gint output_gain;
+    gint mix;
+    gint pan;
+    gint mute;
+
+    // Gains applied at the end of the last block (audio thread)
+    float in_gain;
+    float wet_gain[2];
+    float dry_gain[2];
+
+    // Targets of the block in progress, from begin to end
+    float next_wet_gain[2];
+    float next_dry_gain[2];
+    gboolean has_dry;
+};
+
+ArielSlotStage *
+ariel_slot_stage_new(void)
+{
+    ArielSlotStage *stage = g_new0(ArielSlotStage, 1);
+    ArielSlotMix unity = ARIEL_SLOT_MIX_UNITY;
+    ariel_slot_stage_set(stage, &unity);
+
+    stage->in_gain = 1.0f;
+    stage->wet_gain[0] = stage->wet_gain[1] = 1.0f;
+    return stage;
+}
+
+void
+ariel_slot_stage_free(ArielSlotStage *stage)
+{
+    g_free(stage);
+}
+
+// Change the settings (any thread); the audio thread ramps to them over
+// its next block
+void
+ariel_slot_stage_set(ArielSlotStage *stage, const ArielSlotMix *mix)
+{
+    ariel_atomic_float_set(&stage->input_gain, MAX(mix->input_gain, 0.0f));
+    ariel_atomic_float_set(&stage->output_gain, MAX(mix->output_gain, 0.0f));
+    ariel_atomic_float_set(&stage->mix, CLAMP(mix->mix, 0.0f, 1.0f));
+    ariel_atomic_float_set(&stage->pan, CLAMP(mix->pan, -1.0f, 1.0f));
+    g_atomic_int_set(&stage->mute, mix->mute ? 1 : 0);
+}
+
+void
+ariel_slot_stage_get(ArielSlotStage *stage, ArielSlotMix *mix)
+{
+    mix->input_gain = ariel_atomic_float_get(&stage->input_gain);
+    mix->output_gain = ariel_atomic_float_get(&stage->output_gain);
+    mix->mix = ariel_atomic_float_get(&stage->mix);
+    mix->pan = ariel_atomic_float_get(&stage->pan);
+    mix->mute = g_atomic_int_get(&stage->mute);
+}
+
+// Work out this block's gains and apply the input gain, keeping a copy of
+// the input in dry_L/dry_R when the blend needs it. dry_L and dry_R may be
+// NULL if no scratch space is available; the slot is then fully wet.
+// Audio thread.
+void
+ariel_slot_stage_begin(ArielSlotStage *stage, float *buffer_L, float *buffer_R,
+                       float *dry_L, float *dry_R, jack_nframes_t nframes)
+{
+    float input_gain = ariel_atomic_float_get(&stage->input_gain);
+    float output_gain = g_atomic_int_get(&stage->mute) ? 0.0f : ariel_atomic_float_get(&stage->output_gain);
+    float mix = ariel_atomic_float_get(&stage->mix);
+    float pan = ariel_atomic_float_get(&stage->pan);
+
+    // Balance: the far side is turned down, the centre is unity
+    float balance[2] = { pan > 0.0f ? 1.0f - pan : 1.0f, pan < 0.0f ? 1.0f + pan : 1.0f };
+
+    if (!dry_L || !dry_R) {
+        mix = 1.0f;
+    }
+
+    for (guint c = 0; c < 2; c++) {
+        stage->next_wet_gain[c] = mix * output_gain * balance[c];
+        stage->next_dry_gain[c] = (1.0f - mix) * output_gain * balance[c];
+    }
+    stage->has_dry = dry_L && dry_R &&
+        (stage->next_dry_gain[0] != 0.0f || stage->next_dry_gain[1] != 0.0f ||
+         stage->dry_gain[0] != 0.0f || stage->dry_gain[1] != 0.0f);
+
+    if (stage->in_gain == 1.0f && input_gain == 1.0f && !stage->has_dry) {
+        return;
+    }
+
+    float step = nframes > 0 ? (input_gain - stage->in_gain) / (float)nframes : 0.0f;
+    ariel_dsp_gain_ramp(buffer_L, stage->has_dry ? dry_L : NULL, stage->in_gain, step, nframes);
+    ariel_dsp_gain_ramp(buffer_R, stage->has_dry ? dry_R : NULL, stage->in_gain, step, nframes);
+    stage->in_gain = input_gain;
+}
+
+// Blend the plugin's output with the dry copy, then apply output gain and
+// pan, all in one pass per channel (audio thread)
+void
+ariel_slot_stage_end(ArielSlotStage *stage, float *buffer_L, float *buffer_R,
+                     const float *dry_L, const float *dry_R, jack_nframes_t nframes)
+{
+    float *buffers[2] = { buffer_L, buffer_R };
+    const float *dry[2] = { stage->has_dry ? dry_L : NULL, stage->has_dry ? dry_R : NULL };
+
+    for (guint c = 0; c < 2; c++) {
+        float wet = stage->wet_gain[c];
+        float next_wet = stage->next_wet_gain[c];
+        float dry_gain = stage->dry_gain[c];
+        float next_dry = stage->next_dry_gain[c];
+
+        if (wet == 1.0f && next_wet == 1.0f && !dry[c]) {
+            continue;
+        }
+
+        float wet_step = nframes > 0 ? (next_wet - wet) / (float)nframes : 0.0f;
+        float dry_step = nframes > 0 ? (next_dry - dry_gain) / (float)nframes : 0.0f;
+        ariel_dsp_blend(buffers[c], dry[c], wet, wet_step, dry_gain, dry_step, nframes);
+    }
+
+    for (guint c = 0; c < 2; c++) {
+        stage->wet_gain[c] = stage->next_wet_gain[c];
+        stage->dry_gain[c] = stage->has_dry ? stage->next_dry_gain[c] : 0.0f;
+    }
+}
+
+// Chain presets keep the settings next to the slot's plugin; gains are
+// stored in dB, and settings at their defaults are not written
+void
+ariel_slot_mix_save_to_keyfile(const ArielSlotMix *mix, GKeyFile *keyfile, const char *group)
+{
+    if (mix->input_gain != 1.0f) {
+        g_key_file_set_double(keyfile, group, "input_gain_db", 20.0 * log10(MAX(mix->input_gain, 1e-6f)));
+    }
+    if (mix->output_gain != 1.0f) {
+        g_key_file_set_double(keyfile, group, "output_gain_db", 20.0 * log10(MAX(mix->output_gain, 1e-6f)));
+    }
+    if (mix->mix != 1.0f) {
+        g_key_file_set_double(keyfile, group, "mix", mix->mix);
+    }
+    if (mix->pan != 0.0f) {
+        g_key_file_set_double(keyfile, group, "pan", mix->pan);
+    }
+    if (mix->mute) {
+        g_key_file_set_boolean(keyfile, group, "mute", TRUE);
+    }
+}
+
+void
+ariel_slot_mix_load_from_keyfile(ArielSlotMix *mix, GKeyFile *keyfile, const char *group)
+{
+    *mix = (ArielSlotMix)ARIEL_SLOT_MIX_UNITY;
+
+    if (g_key_file_has_key(keyfile, group, "input_gain_db", NULL)) {
+        mix->input_gain = ariel_db_to_gain(g_key_file_get_double(keyfile, group, "input_gain_db", NULL));
+    }
+    if (g_key_file_has_key(keyfile, group, "output_gain_db", NULL)) {
+        mix->output_gain = ariel_db_to_gain(g_key_file_get_double(keyfile, group, "output_gain_db", NULL));
+    }
+    if (g_key_file_has_key(keyfile, group, "mix", NULL)) {
+        mix->mix = (float)CLAMP(g_key_file_get_double(keyfile, group, "mix", NULL), 0.0, 1.0);
+    }
+    if (g_key_file_has_key(keyfile, group, "pan", NULL)) {
+        mix->pan = (float)CLAMP(g_key_file_get_double(keyfile, group, "pan", NULL), -1.0, 1.0);
+    }
+    mix->mute = g_key_file_get_boolean(keyfile, group, "mute", NULL);
+}
+
+// dB to linear gain; ARIEL_SLOT_GAIN_MIN_DB and below is silence
+float
+ariel_db_to_gain(double db)
+{
+    return db <= ARIEL_SLOT_GAIN_MIN_DB ? 0.0f : (float)pow(10.0, db / 20.0);
+}
@@ -0,0 +1,468 @@
+#include "ariel.h"
+#include <string.h>
+
+// LV2 state snapshots.
+//
+// A plugin's LV2_State_Interface is saved into a compact binary blob that
+// presets and chain presets embed as base64. Keys and types are written as
+// URIs rather than URIDs, since URIDs are only valid within one session,
+// and are mapped again on restore. File paths never appear as absolute
+// paths: plugins convert them with the mapPath feature, which keeps the
+// files under plugin_state/ in the config dir.
+//
+// Layout, in host byte order:
+//
+//   "ARST"  u32 version  u32 n_properties
+//   n_properties x { u32 key_len  key  u32 type_len  type  u32 flags  u32 size  value }
+
+#define ARIEL_STATE_MAGIC    "ARST"
+#define ARIEL_STATE_VERSION  1
+
+#ifndef LV2_STATE__threadSafeRestore
+#define LV2_STATE__threadSafeRestore LV2_STATE_PREFIX "threadSafeRestore"
+#endif
+
+// save() and restore() of one plugin may not overlap, and restores may now
+// run on worker threads
+static GMutex state_mutex;
+
+typedef struct {
+    GByteArray *data;
+    guint32 n_properties;
+    ArielURIDMap *urid_map;
+} ArielStateWriter;
+
+typedef struct {
+    LV2_URID key;
+    LV2_URID type;
+    guint32 flags;
+    guint32 size;
+    void *value;          // Own allocation, so plugins get aligned memory
+} ArielStateProperty;
+
+typedef struct {
+    GArray *properties;   // ArielStateProperty
+} ArielStateReader;
+
+static void
+ariel_state_append_u32(GByteArray *data, guint32 value)
+{
+    g_byte_array_append(data, (const guint8 *)&value, sizeof(value));
+}
+
+static void
+ariel_state_append_string(GByteArray *data, const char *string)
+{
+    guint32 length = (guint32)strlen(string);
+    ariel_state_append_u32(data, length);
+    g_byte_array_append(data, (const guint8 *)string, length);
+}
+
+static LV2_State_Status
+ariel_state_store(LV2_State_Handle handle, uint32_t key, const void *value,
+                  size_t size, uint32_t type, uint32_t flags)
+{
+    ArielStateWriter *writer = handle;
+
+    // Values that are not plain data cannot outlive this call
+    if (!(flags & LV2_STATE_IS_POD)) {
+        return LV2_STATE_ERR_BAD_FLAGS;
+    }
+
+    const char *key_uri = ariel_urid_unmap(writer->urid_map, key);
+    const char *type_uri = ariel_urid_unmap(writer->urid_map, type);
+    if (!key_uri || !type_uri || size > G_MAXUINT32) {
+        return LV2_STATE_ERR_BAD_TYPE;
+    }
+
+    ariel_state_append_string(writer->data, key_uri);
+    ariel_state_append_string(writer->data, type_uri);
+    ariel_state_append_u32(writer->data, flags);
+    ariel_state_append_u32(writer->data, (guint32)size);
+    g_byte_array_append(writer->data, value, (guint)size);
+    writer->n_properties++;
+
+    return LV2_STATE_SUCCESS;
+}
+
+static const void *
+ariel_state_retrieve(LV2_State_Handle handle, uint32_t key, size_t *size,
+                     uint32_t *type, uint32_t *flags)
+{
+    ArielStateReader *reader = handle;
+
+    for (guint i = 0; i < reader->properties->len; i++) {
+        ArielStateProperty *property = &g_array_index(reader->properties, ArielStateProperty, i);
+        if (property->key == key) {
+            if (size) *size = property->size;
+            if (type) *type = property->type;
+            if (flags) *flags = property->flags;
+            return property->value;
+        }
+    }
+
+    return NULL;
+}
+
+static const LV2_State_Interface *
+ariel_state_get_interface(ArielActivePlugin *plugin)
+{
+    LilvInstance *instance = ariel_active_plugin_get_instance(plugin);
+    if (!instance) return NULL;
+
+    return lilv_instance_get_extension_data(instance, LV2_STATE__interface);
+}
+
+gboolean
+ariel_active_plugin_has_state(ArielActivePlugin *plugin)
+{
+    return ariel_state_get_interface(plugin) != NULL;
+}
+
+// Snapshot a plugin's internal state, or NULL if it has none. May run while
+// the plugin is processing.
+GBytes *
+ariel_active_plugin_save_state(ArielActivePlugin *plugin)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), NULL);
+
+    const LV2_State_Interface *state = ariel_state_get_interface(plugin);
+    ArielPluginManager *manager = ariel_active_plugin_get_manager(plugin);
+    if (!state || !state->save || !manager) {
+        return NULL;
+    }
+
+    g_mutex_lock(&state_mutex);
+
+    ArielStateWriter writer = {
+        .data = g_byte_array_new(),
+        .n_properties = 0,
+        .urid_map = manager->urid_map,
+    };
+
+    // Header, with the property count patched in afterwards
+    g_byte_array_append(writer.data, (const guint8 *)ARIEL_STATE_MAGIC, 4);
+    ariel_state_append_u32(writer.data, ARIEL_STATE_VERSION);
+    ariel_state_append_u32(writer.data, 0);
+
+    LV2_State_Status status = state->save(lilv_instance_get_handle(ariel_active_plugin_get_instance(plugin)),
+                                          ariel_state_store, &writer,
+                                          LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE,
+                                          (const LV2_Feature *const *)manager->features);
+    g_mutex_unlock(&state_mutex);
+
+    if (status != LV2_STATE_SUCCESS) {
+        g_warning("Failed to save state of %s (status %d)", ariel_active_plugin_get_name(plugin), status);
+        g_byte_array_free(writer.data, TRUE);
+        return NULL;
+    }
+
+    memcpy(writer.data->data + 8, &writer.n_properties, sizeof(guint32));
+    GBytes *snapshot = g_byte_array_free_to_bytes(writer.data);
+    ariel_active_plugin_set_state_snapshot(plugin, snapshot);
+    return snapshot;
+}
+
+static gboolean
+ariel_state_read_u32(const guint8 **cursor, const guint8 *end, guint32 *value)
+{
+    if ((gsize)(end - *cursor) < sizeof(guint32)) return FALSE;
+    memcpy(value, *cursor, sizeof(guint32));
+    *cursor += sizeof(guint32);
+    return TRUE;
+}
+
+// Read a length-prefixed URI and map it for this session
+static gboolean
+ariel_state_read_urid(const guint8 **cursor, const guint8 *end, ArielURIDMap *urid_map, LV2_URID *urid)
+{
+    guint32 length;
+    if (!ariel_state_read_u32(cursor, end, &length) || (gsize)(end - *cursor) < length) {
+        return FALSE;
+    }
+
+    char *uri = g_strndup((const char *)*cursor, length);
+    *urid = ariel_urid_map(urid_map, uri);
+    g_free(uri);
+    *cursor += length;
+    return TRUE;
+}
+
+static void
+ariel_state_property_clear(gpointer data)
+{
+    ArielStateProperty *property = data;
+    g_free(property->value);
+}
+
+// Restore a snapshot taken by ariel_active_plugin_save_state. Restore is an
+// instantiation-class call: the plugin must not be running concurrently.
+gboolean
+ariel_active_plugin_restore_state(ArielActivePlugin *plugin, GBytes *snapshot)
+{
+    g_return_val_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin), FALSE);
+
+    const LV2_State_Interface *state = ariel_state_get_interface(plugin);
+    ArielPluginManager *manager = ariel_active_plugin_get_manager(plugin);
+    if (!snapshot || !state || !state->restore || !manager) {
+        return FALSE;
+    }
+
+    gsize length;
+    const guint8 *data = g_bytes_get_data(snapshot, &length);
+    const guint8 *end = data + length;
+    const guint8 *cursor = data + 4;
+    guint32 version, n_properties;
+
+    if (length < 12 || memcmp(data, ARIEL_STATE_MAGIC, 4) != 0 ||
+        !ariel_state_read_u32(&cursor, end, &version) || version != ARIEL_STATE_VERSION ||
+        !ariel_state_read_u32(&cursor, end, &n_properties)) {
+        g_warning("Invalid state snapshot for %s", ariel_active_plugin_get_name(plugin));
+        return FALSE;
+    }
+
+    ArielStateReader reader = {
+        .properties = g_array_sized_new(FALSE, TRUE, sizeof(ArielStateProperty), n_properties),
+    };
+    g_array_set_clear_func(reader.properties, ariel_state_property_clear);
+
+    for (guint32 i = 0; i < n_properties; i++) {
+        ArielStateProperty property = { 0 };
+
+        if (!ariel_state_read_urid(&cursor, end, manager->urid_map, &property.key) ||
+            !ariel_state_read_urid(&cursor, end, manager->urid_map, &property.type) ||
+            !ariel_state_read_u32(&cursor, end, &property.flags) ||
+            !ariel_state_read_u32(&cursor, end, &property.size) ||
+            (gsize)(end - cursor) < property.size) {
+            g_warning("Truncated state snapshot for %s", ariel_active_plugin_get_name(plugin));
+            g_array_free(reader.properties, TRUE);
+            return FALSE;
+        }
+
+        property.value = g_malloc(MAX(property.size, 1));
+        memcpy(property.value, cursor, property.size);
+        cursor += property.size;
+        g_array_append_val(reader.properties, property);
+    }
+
+    g_mutex_lock(&state_mutex);
+    LV2_State_Status status = state->restore(lilv_instance_get_handle(ariel_active_plugin_get_instance(plugin)),
+                                             ariel_state_retrieve, &reader, 0,
+                                             (const LV2_Feature *const *)manager->features);
+    g_mutex_unlock(&state_mutex);
+    g_array_free(reader.properties, TRUE);
+
+    if (status != LV2_STATE_SUCCESS) {
+        g_warning("Failed to restore state of %s (status %d)", ariel_active_plugin_get_name(plugin), status);
+        return FALSE;
+    }
+
+    ariel_active_plugin_set_state_snapshot(plugin, snapshot);
+    g_print("Restored %u state properties for %s\n", n_properties, ariel_active_plugin_get_name(plugin));
+    return TRUE;
+}
+
+// Store a plugin's state snapshot under "state" in a preset group
+void
+ariel_state_save_to_keyfile(ArielActivePlugin *plugin, GKeyFile *keyfile, const char *group)
+{
+    GBytes *snapshot = ariel_active_plugin_save_state(plugin);
+    if (!snapshot) return;
+
+    gsize length;
+    const guint8 *data = g_bytes_get_data(snapshot, &length);
+    char *encoded = g_base64_encode(data, length);
+    g_key_file_set_string(keyfile, group, "state", encoded);
+
+    g_free(encoded);
+    g_bytes_unref(snapshot);
+}
+
+// The state snapshot stored in a preset group, or NULL if there is none
+GBytes *
+ariel_state_load_from_keyfile(GKeyFile *keyfile, const char *group)
+{
+    char *encoded = g_key_file_get_string(keyfile, group, "state", NULL);
+    if (!encoded) return NULL;
+
+    gsize length = 0;
+    guchar *data = g_base64_decode(encoded, &length);
+    g_free(encoded);
+
+    return g_bytes_new_take(data, length);
+}
+
+// Whether the plugin declares state:threadSafeRestore, allowing restore()
+// to run concurrently with run() (main thread, queries the lilv world)
+gboolean
+ariel_active_plugin_has_thread_safe_restore(ArielActivePlugin *plugin)
+{
+    ArielPluginManager *manager = ariel_active_plugin_get_manager(plugin);
+    const LilvPlugin *lilv_plugin = ariel_active_plugin_get_lilv_plugin(plugin);
+    if (!manager || !lilv_plugin) return FALSE;
+
+    LilvNode *feature = lilv_new_uri(manager->world, LV2_STATE__threadSafeRestore);
+    gboolean supported = lilv_plugin_has_feature(lilv_plugin, feature);
+    lilv_node_free(feature);
+    return supported;
+}
+
+// Live restore of a running plugin
+typedef struct {
+    ArielActivePlugin *plugin;        // The instance in the chain
+    ArielActivePlugin *replacement;   // Built aside if restore is not thread-safe
+    GBytes *snapshot;
+    ArielPluginLoadedFunc callback;
+    gpointer user_data;
+} ArielStateRestore;
+
+static void
+ariel_state_restore_free(ArielStateRestore *restore)
+{
+    g_clear_object(&restore->plugin);
+    g_clear_object(&restore->replacement);
+    g_bytes_unref(restore->snapshot);
+    g_free(restore);
+}
+
+static void
+ariel_state_copy_controls(ArielActivePlugin *dest, ArielActivePlugin *src)
+{
+    uint32_t n = MIN(ariel_active_plugin_get_num_parameters(dest),
+                     ariel_active_plugin_get_num_parameters(src));
+
+    for (uint32_t i = 0; i < n; i++) {
+        ariel_active_plugin_set_parameter(dest, i, ariel_active_plugin_get_parameter(src, i));
+    }
+    ariel_active_plugin_set_bypass(dest, ariel_active_plugin_get_bypass(src));
+
+    ArielSlotMix slot_mix;
+    ariel_active_plugin_get_slot_mix(src, &slot_mix);
+    ariel_active_plugin_set_slot_mix(dest, &slot_mix);
+}
+
+static void
+ariel_state_restore_thread(GTask *task, G_GNUC_UNUSED gpointer source_object,
+                           gpointer task_data, G_GNUC_UNUSED GCancellable *cancellable)
+{
+    ArielStateRestore *restore = task_data;
+
+    // Thread-safe plugins take the new state while they keep running
+    if (!restore->replacement) {
+        ariel_active_plugin_restore_state(restore->plugin, restore->snapshot);
+        g_task_return_boolean(task, TRUE);
+        return;
+    }
+
+    if (!ariel_active_plugin_instantiate(restore->replacement)) {
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to instantiate %s",
+                                ariel_active_plugin_get_name(restore->replacement));
+        return;
+    }
+
+    ariel_active_plugin_restore_state(restore->replacement, restore->snapshot);
+    ariel_active_plugin_activate(restore->replacement);
+    ariel_active_plugin_warm_up(restore->replacement, ARIEL_WARM_UP_BLOCKS);
+    g_task_return_boolean(task, TRUE);
+}
+
+// Put the replacement where the original sits in the chain. The engine
+// crossfades that slot from one instance to the other while the rest of
+// the chain runs on. Returns FALSE if the original was removed meanwhile.
+static gboolean
+ariel_state_restore_swap(ArielStateRestore *restore)
+{
+    ArielPluginManager *manager = ariel_active_plugin_get_manager(restore->plugin);
+    guint position;
+
+    if (!g_list_store_find(manager->active_plugin_store, restore->plugin, &position)) {
+        return FALSE;
+    }
+
+    // Pick up any control changes made while the replacement was built
+    ariel_state_copy_controls(restore->replacement, restore->plugin);
+
+    if (manager->worker_schedule && manager->worker_schedule->plugin == restore->plugin) {
+        manager->worker_schedule->plugin = restore->replacement;
+    }
+    ariel_midi_mapper_replace_plugin(manager->midi_mapper, restore->plugin, restore->replacement);
+
+    ariel_audio_engine_crossfade_next_chain(ariel_active_plugin_get_engine(restore->plugin));
+    g_list_store_splice(manager->active_plugin_store, position, 1, (gpointer *)&restore->replacement, 1);
+
+    if (manager->plugin_pool) {
+        ariel_plugin_pool_release(manager->plugin_pool, restore->plugin);
+    }
+    return TRUE;
+}
+
+static void
+ariel_state_restore_done(G_GNUC_UNUSED GObject *source_object, GAsyncResult *result,
+                         G_GNUC_UNUSED gpointer user_data)
+{
+    ArielStateRestore *restore = g_task_get_task_data(G_TASK(result));
+    ArielActivePlugin *plugin = NULL;
+    GError *error = NULL;
+
+    if (!g_task_propagate_boolean(G_TASK(result), &error)) {
+        g_warning("%s", error->message);
+        g_error_free(error);
+    } else if (!restore->replacement) {
+        plugin = restore->plugin;
+    } else if (ariel_state_restore_swap(restore)) {
+        plugin = restore->replacement;
+        g_print("Swapped in restored instance of %s\n", ariel_active_plugin_get_name(plugin));
+    }
+
+    if (restore->callback) {
+        restore->callback(plugin, restore->user_data);
+    }
+}
+
+// Restore a snapshot into a plugin that may be in the running chain,
+// without interrupting audio. Plugins with state:threadSafeRestore are
+// restored in place on a worker thread; others get a replacement instance
+// built and restored aside, then swapped in with a crossfade. callback runs
+// on the main thread with the plugin now holding the state (the replacement,
+// if there is one), or NULL on failure.
+void
+ariel_active_plugin_restore_state_async(ArielActivePlugin *plugin, GBytes *snapshot,
+                                        ArielPluginLoadedFunc callback, gpointer user_data)
+{
+    g_return_if_fail(ARIEL_IS_ACTIVE_PLUGIN(plugin));
+    g_return_if_fail(snapshot != NULL);
+
+    // Nothing is running it, so restore right here
+    if (!ariel_active_plugin_is_in_chain(plugin)) {
+        ariel_active_plugin_restore_state(plugin, snapshot);
+        if (callback) callback(plugin, user_data);
+        return;
+    }
+
+    ArielStateRestore *restore = g_malloc0(sizeof(ArielStateRestore));
+    restore->plugin = g_object_ref(plugin);
+    restore->snapshot = g_bytes_ref(snapshot);
+    restore->callback = callback;
+    restore->user_data = user_data;
+
+    if (!ariel_active_plugin_has_thread_safe_restore(plugin)) {
+        ArielPluginInfo *plugin_info = ariel_active_plugin_get_plugin_info(plugin);
+        restore->replacement = ariel_active_plugin_prepare(plugin_info, ariel_active_plugin_get_engine(plugin));
+        g_object_unref(plugin_info);
+
+        if (!restore->replacement) {
+            g_warning("Failed to create replacement instance of %s", ariel_active_plugin_get_name(plugin));
+            ariel_state_restore_free(restore);
+            if (callback) callback(NULL, user_data);
+            return;
+        }
+
+        // Warm up with the live controls
+        ariel_state_copy_controls(restore->replacement, plugin);
+    }
+
+    GTask *task = g_task_new(NULL, NULL, ariel_state_restore_done, NULL);
+    g_task_set_task_data(task, restore, (GDestroyNotify)ariel_state_restore_free);
+    g_task_run_in_thread(task, ariel_state_restore_thread);
+    g_object_unref(task);
+}
@@ -0,0 +1,388 @@
+#define _GNU_SOURCE
+#include "ariel.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <glib/gstdio.h>
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#endif
+#ifdef __linux__
+#include <linux/fs.h>
+#endif
+
+// Content-addressed store for files referenced by plugin state.
+//
+// Files a plugin saves by path (NAM models, IRs, ...) are kept once under
+// plugin_state/objects/ab/<sha256>.<ext>, named by their content, and saved
+// state refers to them by that relative path. Identical files share one
+// object, and different files with the same name can no longer collide.
+// Objects are reflinked where the filesystem supports it, else hardlinked,
+// else copied once. A hardlinked object shares the source's inode, so the
+// source must not be edited in place afterwards.
+//
+// objects/index.ini remembers which source file (path, mtime and size)
+// hashed to which object, so unchanged files are not read again on every
+// save. `ariel --gc-state` deletes objects no preset refers to.
+
+#define ARIEL_STATE_OBJECTS_DIR  "objects"
+#define ARIEL_STATE_INDEX_FILE   "index.ini"
+#define ARIEL_STATE_HASH_LENGTH  64      // Hex digits of a SHA-256
+#define ARIEL_STATE_READ_BLOCK   (1024 * 1024)
+#define ARIEL_STATE_TEMP_MAX_AGE (60 * 60)  // Seconds before a .tmp copy counts as abandoned
+
+// mapPath can be called from any thread a plugin saves on
+static GMutex store_mutex;
+static GKeyFile *store_index;
+static char *store_index_path;
+
+static char *
+ariel_state_store_dir(const char *config_dir)
+{
+    return g_build_filename(config_dir, "plugin_state", ARIEL_STATE_OBJECTS_DIR, NULL);
+}
+
+// The cached dedup index for config_dir (store_mutex held)
+static GKeyFile *
+ariel_state_store_open_index(const char *config_dir)
+{
+    char *objects_dir = ariel_state_store_dir(config_dir);
+    char *index_path = g_build_filename(objects_dir, ARIEL_STATE_INDEX_FILE, NULL);
+    g_free(objects_dir);
+
+    if (store_index && g_str_equal(store_index_path, index_path)) {
+        g_free(index_path);
+        return store_index;
+    }
+
+    g_clear_pointer(&store_index, g_key_file_free);
+    g_free(store_index_path);
+    store_index_path = index_path;
+    store_index = g_key_file_new();
+    g_key_file_load_from_file(store_index, store_index_path, G_KEY_FILE_NONE, NULL);
+    return store_index;
+}
+
+static void
+ariel_state_store_save_index(void)
+{
+    GError *error = NULL;
+
+    if (!g_key_file_save_to_file(store_index, store_index_path, &error)) {
+        ARIEL_WARN("Failed to save state store index %s: %s", store_index_path, error->message);
+        g_error_free(error);
+    }
+}
+
+static char *
+ariel_state_store_hash_file(const char *path)
+{
+    FILE *file = g_fopen(path, "rb");
+    if (!file) return NULL;
+
+    GChecksum *checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    guchar *buffer = g_malloc(ARIEL_STATE_READ_BLOCK);
+    size_t n;
+
+    while ((n = fread(buffer, 1, ARIEL_STATE_READ_BLOCK, file)) > 0) {
+        g_checksum_update(checksum, buffer, (gssize)n);
+    }
+
+    char *hash = ferror(file) ? NULL : g_strdup(g_checksum_get_string(checksum));
+    fclose(file);
+    g_free(buffer);
+    g_checksum_free(checksum);
+    return hash;
+}
+
+// Make dest hold the contents of source: reflink, then hardlink, then copy
+static gboolean
+ariel_state_store_link(const char *source, const char *dest)
+{
+    char *temp_path = g_strconcat(dest, ".tmp", NULL);
+    gboolean stored = FALSE;
+
+#ifdef FICLONE
+    int source_fd = open(source, O_RDONLY | O_CLOEXEC);
+    if (source_fd >= 0) {
+        int dest_fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (dest_fd >= 0) {
+            stored = ioctl(dest_fd, FICLONE, source_fd) == 0;
+            close(dest_fd);
+        }
+        close(source_fd);
+
+        if (stored && g_rename(temp_path, dest) == 0) {
+            g_free(temp_path);
+            return TRUE;
+        }
+        stored = FALSE;
+        g_unlink(temp_path);
+    }
+#endif
+
+#ifdef G_OS_UNIX
+    if (link(source, dest) == 0 || errno == EEXIST) {
+        g_free(temp_path);
+        return TRUE;
+    }
+#endif
+
+    // Different filesystems, or no link support: one real copy
+    GFile *source_file = g_file_new_for_path(source);
+    GFile *temp_file = g_file_new_for_path(temp_path);
+    GError *error = NULL;
+
+    if (g_file_copy(source_file, temp_file, G_FILE_COPY_OVERWRITE, NULL, NULL, NULL, &error)) {
+        stored = g_rename(temp_path, dest) == 0;
+    } else {
+        g_warning("Failed to copy %s into the state store: %s", source, error->message);
+        g_error_free(error);
+    }
+    if (!stored) {
+        g_unlink(temp_path);
+    }
+
+    g_object_unref(source_file);
+    g_object_unref(temp_file);
+    g_free(temp_path);
+    return stored;
+}
+
+// Short extensions are kept, since plugins often pick a loader by them
+static const char *
+ariel_state_store_extension(const char *path)
+{
+    const char *basename = strrchr(path, G_DIR_SEPARATOR);
+    const char *dot = strrchr(basename ? basename + 1 : path, '.');
+
+    if (!dot || strlen(dot) > 16 || strchr(dot, '/')) return "";
+    return dot;
+}
+
+// Store a file by content. Returns its path relative to plugin_state/, or
+// NULL if it could not be stored.
+char *
+ariel_state_store_add(const char *config_dir, const char *path)
+{
+    GStatBuf st;
+
+    if (!config_dir || !path || !g_file_test(path, G_FILE_TEST_IS_REGULAR) || g_stat(path, &st) != 0) {
+        return NULL;
+    }
+
+    g_mutex_lock(&store_mutex);
+    GKeyFile *index = ariel_state_store_open_index(config_dir);
+    gboolean index_changed = FALSE;
+
+    // Unchanged sources keep their hash, so large models are read only once
+    char *path_key = g_compute_checksum_for_string(G_CHECKSUM_SHA1, path, -1);
+    char *source_group = g_strconcat("source ", path_key, NULL);
+    char *hash = NULL;
+
+    if (g_key_file_get_int64(index, source_group, "mtime", NULL) == (gint64)st.st_mtime &&
+        g_key_file_get_int64(index, source_group, "size", NULL) == (gint64)st.st_size) {
+        hash = g_key_file_get_string(index, source_group, "object", NULL);
+    }
+
+    if (!hash) {
+        hash = ariel_state_store_hash_file(path);
+        if (hash) {
+            g_key_file_set_string(index, source_group, "path", path);
+            g_key_file_set_int64(index, source_group, "mtime", (gint64)st.st_mtime);
+            g_key_file_set_int64(index, source_group, "size", (gint64)st.st_size);
+            g_key_file_set_string(index, source_group, "object", hash);
+            index_changed = TRUE;
+        }
+    }
+
+    char *relative_path = NULL;
+    if (hash) {
+        relative_path = g_strdup_printf(ARIEL_STATE_OBJECTS_DIR "/%.2s/%s%s", hash, hash,
+                                        ariel_state_store_extension(path));
+        char *object_path = g_build_filename(config_dir, "plugin_state", relative_path, NULL);
+
+        if (!g_file_test(object_path, G_FILE_TEST_EXISTS)) {
+            char *object_dir = g_path_get_dirname(object_path);
+            g_mkdir_with_parents(object_dir, 0755);
+            g_free(object_dir);
+
+            if (ariel_state_store_link(path, object_path)) {
+                char *object_group = g_strconcat("object ", hash, NULL);
+                char *name = g_path_get_basename(path);
+                g_key_file_set_string(index, object_group, "name", name);
+                g_key_file_set_int64(index, object_group, "size", (gint64)st.st_size);
+                g_free(name);
+                g_free(object_group);
+                index_changed = TRUE;
+                ARIEL_INFO("Stored %s as %s", path, relative_path);
+            } else {
+                g_clear_pointer(&relative_path, g_free);
+            }
+        }
+        g_free(object_path);
+    }
+
+    if (index_changed) {
+        ariel_state_store_save_index();
+    }
+    g_mutex_unlock(&store_mutex);
+
+    g_free(hash);
+    g_free(source_group);
+    g_free(path_key);
+    return relative_path;
+}
+
+// Collect the object hashes a state blob refers to
+static void
+ariel_state_store_scan_blob(const guint8 *data, gsize length, GHashTable *referenced)
+{
+    static const char prefix[] = ARIEL_STATE_OBJECTS_DIR "/";
+    const gsize prefix_length = sizeof(prefix) - 1;
+    const gsize hash_offset = prefix_length + 3;     // "ab/"
+
+    for (gsize i = 0; i + hash_offset + ARIEL_STATE_HASH_LENGTH <= length; i++) {
+        if (memcmp(data + i, prefix, prefix_length) != 0) continue;
+
+        const char *hash = (const char *)data + i + hash_offset;
+        gboolean valid = TRUE;
+        for (guint j = 0; j < ARIEL_STATE_HASH_LENGTH && valid; j++) {
+            valid = g_ascii_isxdigit(hash[j]);
+        }
+        if (valid) {
+            g_hash_table_add(referenced, g_strndup(hash, ARIEL_STATE_HASH_LENGTH));
+        }
+    }
+}
+
+// Collect references from every preset (or chain preset) in a directory
+static void
+ariel_state_store_scan_presets(const char *preset_dir, const char *suffix, GHashTable *referenced)
+{
+    GDir *dir = g_dir_open(preset_dir, 0, NULL);
+    const char *filename;
+
+    while (dir && (filename = g_dir_read_name(dir)) != NULL) {
+        if (!g_str_has_suffix(filename, suffix)) continue;
+
+        char *path = g_build_filename(preset_dir, filename, NULL);
+        GKeyFile *keyfile = g_key_file_new();
+
+        if (g_key_file_load_from_file(keyfile, path, G_KEY_FILE_NONE, NULL)) {
+            char **groups = g_key_file_get_groups(keyfile, NULL);
+            for (guint i = 0; groups[i]; i++) {
+                GBytes *state = ariel_state_load_from_keyfile(keyfile, groups[i]);
+                if (state) {
+                    gsize length;
+                    const guint8 *data = g_bytes_get_data(state, &length);
+                    ariel_state_store_scan_blob(data, length, referenced);
+                    g_bytes_unref(state);
+                }
+            }
+            g_strfreev(groups);
+        }
+
+        g_key_file_free(keyfile);
+        g_free(path);
+    }
+
+    if (dir) {
+        g_dir_close(dir);
+    }
+}
+
+// Drop an object's index entries, including sources that hashed to it
+static void
+ariel_state_store_forget(GKeyFile *index, const char *hash)
+{
+    char **groups = g_key_file_get_groups(index, NULL);
+
+    for (guint i = 0; groups[i]; i++) {
+        char *object = g_key_file_get_string(index, groups[i], "object", NULL);
+        gboolean is_object = g_str_has_prefix(groups[i], "object ") && g_str_equal(groups[i] + 7, hash);
+        if (is_object || (object && g_str_equal(object, hash))) {
+            g_key_file_remove_group(index, groups[i], NULL);
+        }
+        g_free(object);
+    }
+    g_strfreev(groups);
+}
+
+// Delete objects that no preset or chain preset refers to, and temporary
+// copies left behind long ago. Returns the number of objects removed.
+guint
+ariel_state_store_gc(const char *config_dir)
+{
+    g_return_val_if_fail(config_dir != NULL, 0);
+
+    GHashTable *referenced = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    char *preset_dir = g_build_filename(config_dir, "presets", NULL);
+    char *chain_dir = g_build_filename(config_dir, "chain_presets", NULL);
+    ariel_state_store_scan_presets(preset_dir, ".preset", referenced);
+    ariel_state_store_scan_presets(chain_dir, ".chain", referenced);
+    g_free(preset_dir);
+    g_free(chain_dir);
+
+    g_mutex_lock(&store_mutex);
+    GKeyFile *index = ariel_state_store_open_index(config_dir);
+    char *objects_dir = ariel_state_store_dir(config_dir);
+    GDir *dir = g_dir_open(objects_dir, 0, NULL);
+    const char *subdir_name;
+    guint n_removed = 0;
+    guint64 bytes_removed = 0;
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+
+    while (dir && (subdir_name = g_dir_read_name(dir)) != NULL) {
+        char *subdir_path = g_build_filename(objects_dir, subdir_name, NULL);
+        GDir *subdir = g_file_test(subdir_path, G_FILE_TEST_IS_DIR) ? g_dir_open(subdir_path, 0, NULL) : NULL;
+        const char *filename;
+
+        while (subdir && (filename = g_dir_read_name(subdir)) != NULL) {
+            char *hash = g_strndup(filename, ARIEL_STATE_HASH_LENGTH);
+            char *object_path = g_build_filename(subdir_path, filename, NULL);
+            GStatBuf st;
+            gboolean have_stat = g_stat(object_path, &st) == 0;
+
+            if (g_str_has_suffix(filename, ".tmp")) {
+                // Another instance may still be copying into it
+                if (have_stat && now - (gint64)st.st_mtime > ARIEL_STATE_TEMP_MAX_AGE) {
+                    g_unlink(object_path);
+                }
+            } else if (!g_hash_table_contains(referenced, hash)) {
+                guint64 size = have_stat ? (guint64)st.st_size : 0;
+
+                if (g_unlink(object_path) == 0) {
+                    ariel_state_store_forget(index, hash);
+                    bytes_removed += size;
+                    n_removed++;
+                }
+            }
+            g_free(object_path);
+            g_free(hash);
+        }
+
+        if (subdir) {
+            g_dir_close(subdir);
+            g_rmdir(subdir_path);   // Only succeeds once empty
+        }
+        g_free(subdir_path);
+    }
+
+    if (dir) {
+        g_dir_close(dir);
+    }
+    if (n_removed > 0) {
+        ariel_state_store_save_index();
+    }
+    g_mutex_unlock(&store_mutex);
+
+    g_print("State store: removed %u unreferenced objects (%.1f MiB), %u referenced\n",
+            n_removed, bytes_removed / (1024.0 * 1024.0), g_hash_table_size(referenced));
+
+    g_free(objects_dir);
+    g_hash_table_destroy(referenced);
+    return n_removed;
+}
@@ -249,34 +249,17 @@ ariel_wasapi_audio_thread(LPVOID lpParam)
                 memcpy(client->output_buffer_L, client->input_buffer_L, frames_to_read * sizeof(float));
                 memcpy(client->output_buffer_R, client->input_buffer_R, frames_to_read * sizeof(float));
                 
+                // Pick up chain changes at the cycle boundary
+                ariel_audio_engine_process_commands(client->engine);
+                
                 // Process worker responses
                 if (client->engine->plugin_manager->worker_schedule) {
                     ariel_worker_process_responses(client->engine->plugin_manager->worker_schedule);
                 }
                 
                 // Process active plugins
-                if (client->engine->plugin_manager->active_plugin_store) {
-                    guint n_active = g_list_model_get_n_items(G_LIST_MODEL(client->engine->plugin_manager->active_plugin_store));
-                    
-                    for (guint i = 0; i < n_active; i++) {
-                        ArielActivePlugin *plugin = g_list_model_get_item(
-                            G_LIST_MODEL(client->engine->plugin_manager->active_plugin_store), i);
-                        
-                        if (plugin && ariel_active_plugin_is_active(plugin)) {
-                            float *input_buffers[2] = { client->output_buffer_L, client->output_buffer_R };
-                            float *output_buffers[2] = { client->output_buffer_L, client->output_buffer_R };
-                            
-                            ariel_active_plugin_connect_audio_ports(plugin, input_buffers, output_buffers);
-                            ariel_active_plugin_process(plugin, frames_to_read);
-                            
-                            if (ariel_active_plugin_is_mono(plugin)) {
-                                memcpy(client->output_buffer_R, client->output_buffer_L, frames_to_read * sizeof(float));
-                            }
-                        }
-                        
-                        if (plugin) g_object_unref(plugin);
-                    }
-                }
+                ariel_audio_engine_process_chain(client->engine, client->output_buffer_L,
+                                                 client->output_buffer_R, frames_to_read);
             } else {
                 // No processing - pass through
                 memcpy(client->output_buffer_L, client->input_buffer_L, frames_to_read * sizeof(float));
@@ -21,6 +21,7 @@ struct _ArielApp {
     GtkApplication parent;
     ArielAudioEngine *audio_engine;
     ArielPluginManager *plugin_manager;
+    ArielControlServer *control_server;
 };
 
 G_DEFINE_FINAL_TYPE(ArielApp, ariel_app, GTK_TYPE_APPLICATION)
@@ -38,6 +39,7 @@ ariel_app_init(ArielApp *app)
     // Initialize fields to NULL first for safety
     app->audio_engine = NULL;
     app->plugin_manager = NULL;
+    app->control_server = NULL;
     
 #ifdef _WIN32
     // On Windows, defer complex initialization to avoid crash during GObject construction
@@ -76,6 +78,9 @@ ariel_app_dispose(GObject *object)
 {
     ArielApp *app = ARIEL_APP(object);
     
+    ariel_control_server_free(app->control_server);
+    app->control_server = NULL;
+    
     if (app->audio_engine) {
         ariel_audio_engine_free(app->audio_engine);
         app->audio_engine = NULL;
@@ -136,6 +141,15 @@ ariel_app_activate(GApplication *application)
         return;
     }
     
+    app->audio_engine->crossfade_ms = ariel_load_crossfade_preference();
+    ariel_load_capture_preferences(&app->audio_engine->capture_minutes,
+                                   &app->audio_engine->capture_lock_memory);
+    
+    // Let scripts and external controllers recall scenes
+    if (!app->control_server) {
+        app->control_server = ariel_control_server_new(app);
+    }
+    
     // Load custom CSS if available
     g_print("Loading custom CSS\n");
     ariel_load_custom_css();
@@ -392,6 +406,16 @@ main(int argc, char **argv)
     ArielApp *app;
     int status;
 
+    // Maintenance commands that need neither the UI nor the audio engine
+    for (int i = 1; i < argc; i++) {
+        if (g_str_equal(argv[i], "--gc-state")) {
+            ArielConfig *config = ariel_config_new();
+            ariel_state_store_gc(ariel_config_get_dir(config));
+            ariel_config_free(config);
+            return 0;
+        }
+    }
+
 #ifdef HAVE_NCURSES
     // Check if CLI mode is requested
     if (ariel_should_use_cli(argc, argv)) {
@@ -15,6 +15,15 @@ static void on_load_chain_preset_ok(GtkButton *button, gpointer user_data);
 static gboolean on_plugin_drop(GtkDropTarget *target, const GValue *value, double x, double y, ArielWindow *window);
 static GdkDragAction on_drop_enter(GtkDropTarget *target, double x, double y, GtkWidget *plugins_box);
 static void on_drop_leave(GtkDropTarget *target, GtkWidget *plugins_box);
+static void on_capture_scene_clicked(GtkButton *button, ArielWindow *window);
+static void on_recall_scene_clicked(GtkButton *button, ArielWindow *window);
+static void on_scene_recalled(guint index, gpointer user_data);
+static void on_midi_map_changed(gboolean mappings_changed, gpointer user_data);
+static void on_plugin_file_reported(ArielActivePlugin *plugin, const char *property_uri, const char *path, gpointer user_data);
+static void on_morph_changed(GtkRange *range, ArielWindow *window);
+static void on_morph_scenes_changed(GtkDropDown *dropdown, GParamSpec *pspec, GtkWidget *morph_scale);
+static void ariel_update_scene_list(ArielWindow *window);
+static void ariel_update_player_bar(ArielWindow *window, const char *path);
 
 // Callback for Remove All button
 static void
@@ -37,21 +46,8 @@ on_remove_all_clicked(G_GNUC_UNUSED GtkButton *button, ArielWindow *window)
         return; // Nothing to remove
     }
     
-    // Deactivate and remove all active plugins
-    while (g_list_model_get_n_items(G_LIST_MODEL(manager->active_plugin_store)) > 0) {
-        ArielActivePlugin *plugin = g_list_model_get_item(G_LIST_MODEL(manager->active_plugin_store), 0);
-        if (plugin) {
-            // Deactivate plugin processing
-            ariel_active_plugin_deactivate(plugin);
-            g_object_unref(plugin);
-        }
-        
-        // Remove from store
-        g_list_store_remove(manager->active_plugin_store, 0);
-    }
-    
-    // Remove all items at once to be safe
-    g_list_store_remove_all(manager->active_plugin_store);
+    // Remove all active plugins; their instances stay warm for reuse
+    ariel_plugin_manager_clear_plugins(manager);
     
     // Update the UI
     ariel_update_active_plugins_view(window);
@@ -77,19 +73,8 @@ on_remove_plugin_clicked(G_GNUC_UNUSED GtkButton *button, ArielWindow *window)
         return;
     }
     
-    // Find and remove the plugin from the store
-    guint n_active = g_list_model_get_n_items(G_LIST_MODEL(manager->active_plugin_store));
-    for (guint i = 0; i < n_active; i++) {
-        ArielActivePlugin *store_plugin = g_list_model_get_item(G_LIST_MODEL(manager->active_plugin_store), i);
-        if (store_plugin == plugin) {
-            // Deactivate plugin processing
-            ariel_active_plugin_deactivate(plugin);
-            g_list_store_remove(manager->active_plugin_store, i);
-            g_object_unref(store_plugin);
-            break;
-        }
-        g_object_unref(store_plugin);
-    }
+    // Remove the plugin from the chain; its instance stays warm for reuse
+    ariel_plugin_manager_remove_plugin(manager, plugin);
     
     // Update the UI
     ariel_update_active_plugins_view(window);
@@ -176,7 +161,7 @@ on_save_preset_ok(G_GNUC_UNUSED GtkButton *button, GtkEntry *entry)
 
 // Callback for load preset button
 static void
-on_load_preset_clicked(G_GNUC_UNUSED GtkButton *button, gpointer user_data)
+on_load_preset_clicked(GtkButton *button, gpointer user_data)
 {
     ArielActivePlugin *plugin = (ArielActivePlugin *)user_data;
     if (!plugin) return;
@@ -187,14 +172,14 @@ on_load_preset_clicked(G_GNUC_UNUSED GtkButton *button, gpointer user_data)
     char *preset_dir = g_build_filename(config_dir, "presets", NULL);
     
     // Get list of available presets for this plugin
-    char **preset_list = ariel_active_plugin_list_presets(plugin, preset_dir);
+    GPtrArray *preset_list = ariel_active_plugin_list_presets(plugin, preset_dir);
+    g_free(preset_dir);
+    ariel_config_free(config);
     
-    if (!preset_list || !preset_list[0]) {
+    if (!preset_list || preset_list->len == 0) {
         g_print("No presets found for plugin %s\n", ariel_active_plugin_get_name(plugin));
         
-        if (preset_list) ariel_active_plugin_free_preset_list(preset_list);
-        g_free(preset_dir);
-        ariel_config_free(config);
+        if (preset_list) g_ptr_array_unref(preset_list);
         return;
     }
     
@@ -215,8 +200,9 @@ on_load_preset_clicked(G_GNUC_UNUSED GtkButton *button, gpointer user_data)
     
     // Create dropdown using GtkDropDown
     GtkStringList *string_list = gtk_string_list_new(NULL);
-    for (int i = 0; preset_list[i] != NULL; i++) {
-        gtk_string_list_append(string_list, preset_list[i]);
+    for (guint i = 0; i < preset_list->len; i++) {
+        ArielPresetEntry *entry = g_ptr_array_index(preset_list, i);
+        gtk_string_list_append(string_list, entry->name);
     }
     
     GtkWidget *dropdown = gtk_drop_down_new(G_LIST_MODEL(string_list), NULL);
@@ -242,38 +228,99 @@ on_load_preset_clicked(G_GNUC_UNUSED GtkButton *button, gpointer user_data)
     g_signal_connect(load_btn, "clicked", G_CALLBACK(on_load_preset_ok), dropdown);
     
     g_object_set_data_full(G_OBJECT(dropdown), "preset-list", preset_list, 
-                          (GDestroyNotify)ariel_active_plugin_free_preset_list);
-    g_object_set_data_full(G_OBJECT(dropdown), "preset-dir", preset_dir, g_free);
+                          (GDestroyNotify)g_ptr_array_unref);
     g_object_set_data(G_OBJECT(dropdown), "plugin", plugin);
+    g_object_set_data(G_OBJECT(dropdown), "window", g_object_get_data(G_OBJECT(button), "window"));
     
     gtk_window_present(GTK_WINDOW(window));
-    ariel_config_free(config);
+}
+
+// A preset with internal state may leave a new instance in the chain
+static void
+on_preset_loaded(ArielActivePlugin *active_plugin, gpointer user_data)
+{
+    ArielWindow *window = user_data;
+    
+    if (active_plugin && window) {
+        ariel_update_active_plugins_view(window);
+    }
 }
 
 // Helper callback for load preset OK button
 static void
 on_load_preset_ok(G_GNUC_UNUSED GtkButton *button, GtkDropDown *dropdown)
 {
-    char **preset_list = g_object_get_data(G_OBJECT(dropdown), "preset-list");
-    char *preset_dir = g_object_get_data(G_OBJECT(dropdown), "preset-dir");
+    GPtrArray *preset_list = g_object_get_data(G_OBJECT(dropdown), "preset-list");
     ArielActivePlugin *plugin = g_object_get_data(G_OBJECT(dropdown), "plugin");
+    ArielWindow *window = g_object_get_data(G_OBJECT(dropdown), "window");
     
     guint selected = gtk_drop_down_get_selected(dropdown);
-    if (preset_list && preset_list[selected]) {
-        char *preset_path = g_build_filename(preset_dir, preset_list[selected], NULL);
-        char *full_preset_path = g_strconcat(preset_path, ".preset", NULL);
-        
-        ariel_active_plugin_load_preset(plugin, full_preset_path);
-        
-        g_free(preset_path);
-        g_free(full_preset_path);
+    if (preset_list && selected < preset_list->len) {
+        ArielPresetEntry *entry = g_ptr_array_index(preset_list, selected);
+        ariel_active_plugin_load_preset(plugin, entry->path, on_preset_loaded, window);
     }
 }
 
 // Drop target callbacks
+static void
+on_plugin_dropped_loaded(ArielActivePlugin *active_plugin, gpointer user_data)
+{
+    ArielWindow *window = user_data;
+    
+    if (!active_plugin) {
+        return;
+    }
+    
+    g_print("Successfully loaded plugin via drag & drop: %s\n", 
+            ariel_active_plugin_get_name(active_plugin));
+    
+    // Update the active plugins view
+    ariel_update_active_plugins_view(window);
+}
+
+// An audio file dropped on the chain plays into its input
+static gboolean
+on_audio_file_drop(const GValue *value, ArielWindow *window)
+{
+    GSList *files = gdk_file_list_get_files(g_value_get_boxed(value));
+    char *path = files ? g_file_get_path(files->data) : NULL;
+    g_slist_free(files);
+    
+    if (!path) {
+        return FALSE;
+    }
+    
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
+    GtkWidget *mix_check = g_object_get_data(G_OBJECT(window->active_plugins), "player-mix");
+    gboolean mix = mix_check && gtk_check_button_get_active(GTK_CHECK_BUTTON(mix_check));
+    gboolean playing = FALSE;
+    
+    if (!engine || !engine->active) {
+        g_warning("Cannot play audio file - audio engine not running");
+    } else if (!g_str_has_suffix(path, ".wav") && !g_str_has_suffix(path, ".WAV")) {
+        g_warning("Only WAV files can be played: %s", path);
+    } else {
+        playing = ariel_audio_engine_play_file(engine, path, mix);
+    }
+    
+    if (playing) {
+        GtkWidget *loop_check = g_object_get_data(G_OBJECT(window->active_plugins), "player-loop");
+        if (loop_check) {
+            ariel_file_player_set_loop(engine->file_player, gtk_check_button_get_active(GTK_CHECK_BUTTON(loop_check)));
+        }
+        ariel_update_player_bar(window, path);
+    }
+    g_free(path);
+    return playing;
+}
+
 static gboolean
 on_plugin_drop(G_GNUC_UNUSED GtkDropTarget *target, const GValue *value, G_GNUC_UNUSED double x, G_GNUC_UNUSED double y, ArielWindow *window)
 {
+    if (G_VALUE_HOLDS(value, GDK_TYPE_FILE_LIST)) {
+        return on_audio_file_drop(value, window);
+    }
+    
     if (!G_VALUE_HOLDS_STRING(value)) {
         return FALSE;
     }
@@ -292,32 +339,16 @@ on_plugin_drop(G_GNUC_UNUSED GtkDropTarget *target, const GValue *value, G_GNUC_
         return FALSE;
     }
     
-    // Search for plugin with matching URI
-    guint n_plugins = g_list_model_get_n_items(G_LIST_MODEL(manager->plugin_store));
-    for (guint i = 0; i < n_plugins; i++) {
-        ArielPluginInfo *plugin_info = g_list_model_get_item(G_LIST_MODEL(manager->plugin_store), i);
-        if (plugin_info && strcmp(ariel_plugin_info_get_uri(plugin_info), plugin_uri) == 0) {
-            // Load the plugin
-            ArielActivePlugin *active_plugin = ariel_plugin_manager_load_plugin(manager, plugin_info, engine);
-            if (active_plugin) {
-                g_print("Successfully loaded plugin via drag & drop: %s\n", 
-                        ariel_active_plugin_get_name(active_plugin));
-                
-                // Update the active plugins view
-                ariel_update_active_plugins_view(window);
-                
-                g_object_unref(active_plugin);
-                g_object_unref(plugin_info);
-                return TRUE;
-            }
-            g_object_unref(plugin_info);
-            break;
-        }
-        g_object_unref(plugin_info);
+    // Look up the plugin with matching URI
+    ArielPluginInfo *plugin_info = ariel_plugin_manager_find_plugin(manager, plugin_uri);
+    if (!plugin_info) {
+        g_warning("Could not find plugin with URI: %s", plugin_uri);
+        return FALSE;
     }
     
-    g_warning("Could not find plugin with URI: %s", plugin_uri);
-    return FALSE;
+    // Load the plugin in the background
+    ariel_plugin_manager_load_plugin_async(manager, plugin_info, engine, on_plugin_dropped_loaded, window);
+    return TRUE;
 }
 
 static GdkDragAction
@@ -335,6 +366,198 @@ on_drop_leave(G_GNUC_UNUSED GtkDropTarget *target, GtkWidget *plugins_box)
     gtk_widget_remove_css_class(plugins_box, "drop-target");
 }
 
+// File player callbacks
+static void
+ariel_update_player_bar(ArielWindow *window, const char *path)
+{
+    GtkWidget *player_box = g_object_get_data(G_OBJECT(window->active_plugins), "player-box");
+    GtkWidget *player_label = g_object_get_data(G_OBJECT(window->active_plugins), "player-label");
+    if (!player_box || !player_label) return;
+    
+    if (path) {
+        char *name = g_path_get_basename(path);
+        char *text = g_strdup_printf("Playing %s", name);
+        gtk_label_set_text(GTK_LABEL(player_label), text);
+        g_free(text);
+        g_free(name);
+    }
+    gtk_widget_set_visible(player_box, path != NULL);
+}
+
+static void
+on_player_stop_clicked(G_GNUC_UNUSED GtkButton *button, ArielWindow *window)
+{
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
+    if (engine) {
+        ariel_audio_engine_play_file(engine, NULL, FALSE);
+    }
+    ariel_update_player_bar(window, NULL);
+}
+
+static void
+on_player_mix_toggled(GtkCheckButton *check, ArielWindow *window)
+{
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
+    if (engine && engine->file_player) {
+        ariel_file_player_set_mix(engine->file_player, gtk_check_button_get_active(check));
+    }
+}
+
+static void
+on_player_loop_toggled(GtkCheckButton *check, ArielWindow *window)
+{
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
+    if (engine && engine->file_player) {
+        ariel_file_player_set_loop(engine->file_player, gtk_check_button_get_active(check));
+    }
+}
+
+// Scene callbacks
+static void
+ariel_update_scene_list(ArielWindow *window)
+{
+    if (!window || !window->active_plugins) return;
+    
+    GtkWidget *dropdown = g_object_get_data(G_OBJECT(window->active_plugins), "scene-dropdown");
+    ArielPluginManager *manager = ariel_app_get_plugin_manager(window->app);
+    if (!dropdown || !manager || !manager->scenes) return;
+    
+    GtkWidget *morph_dropdown = g_object_get_data(G_OBJECT(window->active_plugins), "morph-dropdown");
+    GtkWidget *morph_scale = g_object_get_data(G_OBJECT(window->active_plugins), "morph-scale");
+    guint selected = gtk_drop_down_get_selected(GTK_DROP_DOWN(dropdown));
+    guint morph_selected = morph_dropdown ? gtk_drop_down_get_selected(GTK_DROP_DOWN(morph_dropdown)) : GTK_INVALID_LIST_POSITION;
+    GtkStringList *names = GTK_STRING_LIST(gtk_drop_down_get_model(GTK_DROP_DOWN(dropdown)));
+    guint old_count = g_list_model_get_n_items(G_LIST_MODEL(names));
+    
+    guint n_scenes = ariel_scene_bank_get_n_scenes(manager->scenes);
+    const char **strings = g_new0(const char *, n_scenes + 1);
+    for (guint i = 0; i < n_scenes; i++) {
+        strings[i] = ariel_scene_bank_get_name(manager->scenes, i);
+    }
+    gtk_string_list_splice(names, 0, old_count, strings);
+    g_free(strings);
+    
+    if (selected != GTK_INVALID_LIST_POSITION && selected < n_scenes) {
+        gtk_drop_down_set_selected(GTK_DROP_DOWN(dropdown), selected);
+    }
+    if (morph_dropdown && morph_selected != GTK_INVALID_LIST_POSITION && morph_selected < n_scenes) {
+        gtk_drop_down_set_selected(GTK_DROP_DOWN(morph_dropdown), morph_selected);
+    }
+    
+    // The chain may have changed under the armed morph
+    if (morph_scale) {
+        g_object_set_data(G_OBJECT(morph_scale), "armed-pair", NULL);
+    }
+}
+
+static void
+on_capture_scene_clicked(G_GNUC_UNUSED GtkButton *button, ArielWindow *window)
+{
+    ArielPluginManager *manager = ariel_app_get_plugin_manager(window->app);
+    if (!manager || !manager->scenes) return;
+    
+    char *name = g_strdup_printf("Scene %u", ariel_scene_bank_get_n_scenes(manager->scenes) + 1);
+    gint index = ariel_scene_bank_capture(manager->scenes, manager, name);
+    g_free(name);
+    
+    if (index < 0) {
+        g_warning("Nothing to capture - the chain is empty");
+        return;
+    }
+    
+    ariel_update_scene_list(window);
+    
+    GtkWidget *dropdown = g_object_get_data(G_OBJECT(window->active_plugins), "scene-dropdown");
+    if (dropdown) {
+        gtk_drop_down_set_selected(GTK_DROP_DOWN(dropdown), (guint)index);
+    }
+}
+
+static void
+on_recall_scene_clicked(G_GNUC_UNUSED GtkButton *button, ArielWindow *window)
+{
+    ArielPluginManager *manager = ariel_app_get_plugin_manager(window->app);
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
+    if (!manager || !manager->scenes || !engine) return;
+    
+    GtkWidget *dropdown = g_object_get_data(G_OBJECT(window->active_plugins), "scene-dropdown");
+    if (!dropdown) return;
+    
+    guint selected = gtk_drop_down_get_selected(GTK_DROP_DOWN(dropdown));
+    if (selected == GTK_INVALID_LIST_POSITION) return;
+    
+    ariel_scene_bank_recall(manager->scenes, manager, engine, selected);
+}
+
+static void
+on_scene_recalled(guint index, gpointer user_data)
+{
+    ArielWindow *window = user_data;
+    
+    // Rebuild the plugin widgets so the sliders show the recalled values
+    ariel_update_active_plugins_view(window);
+    
+    GtkWidget *dropdown = g_object_get_data(G_OBJECT(window->active_plugins), "scene-dropdown");
+    if (dropdown) {
+        gtk_drop_down_set_selected(GTK_DROP_DOWN(dropdown), index);
+    }
+}
+
+// A plugin reported the file it loaded, e.g. a model or impulse response
+static void
+on_plugin_file_reported(ArielActivePlugin *plugin, const char *property_uri, const char *path,
+                        G_GNUC_UNUSED gpointer user_data)
+{
+    ariel_parameter_controls_show_file(plugin, property_uri, path);
+}
+
+static void
+on_midi_map_changed(gboolean mappings_changed, gpointer user_data)
+{
+    if (mappings_changed) {
+        // New or loaded mappings; rebuild so the MIDI buttons show them
+        ariel_update_active_plugins_view((ArielWindow *)user_data);
+    } else {
+        ariel_parameter_controls_sync();
+    }
+}
+
+// Morph between the selected scene and the "morph to" scene. The pair is
+// compiled for the audio thread when first moved; after that the slider
+// only sets the engine's morph position.
+static void
+on_morph_changed(GtkRange *range, ArielWindow *window)
+{
+    ArielPluginManager *manager = ariel_app_get_plugin_manager(window->app);
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
+    if (!manager || !manager->scenes || !engine) return;
+    
+    GtkWidget *dropdown = g_object_get_data(G_OBJECT(window->active_plugins), "scene-dropdown");
+    GtkWidget *morph_dropdown = g_object_get_data(G_OBJECT(window->active_plugins), "morph-dropdown");
+    if (!dropdown || !morph_dropdown) return;
+    
+    guint from = gtk_drop_down_get_selected(GTK_DROP_DOWN(dropdown));
+    guint to = gtk_drop_down_get_selected(GTK_DROP_DOWN(morph_dropdown));
+    if (from == GTK_INVALID_LIST_POSITION || to == GTK_INVALID_LIST_POSITION) return;
+    
+    // Stored off by one, so NULL means nothing is armed
+    guint pair = ((from << 16) | to) + 1;
+    if (GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(range), "armed-pair")) != pair) {
+        if (!ariel_scene_bank_morph(manager->scenes, manager, engine, from, to)) {
+            return;
+        }
+        g_object_set_data(G_OBJECT(range), "armed-pair", GUINT_TO_POINTER(pair));
+    }
+    
+    ariel_audio_engine_set_morph_position(engine, (float)gtk_range_get_value(range));
+}
+
+static void
+on_morph_scenes_changed(G_GNUC_UNUSED GtkDropDown *dropdown, G_GNUC_UNUSED GParamSpec *pspec, GtkWidget *morph_scale)
+{
+    g_object_set_data(G_OBJECT(morph_scale), "armed-pair", NULL);
+}
+
 // Create active plugins view
 GtkWidget *
 ariel_create_active_plugins_view(ArielWindow *window)
@@ -387,6 +610,56 @@ ariel_create_active_plugins_view(ArielWindow *window)
     
     gtk_box_append(GTK_BOX(main_box), header_box);
     
+    // Scene bar: capture the chain's settings and recall them in one cycle
+    GtkWidget *scene_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
+    
+    GtkWidget *scene_label = gtk_label_new("Scenes");
+    gtk_widget_add_css_class(scene_label, "heading");
+    gtk_box_append(GTK_BOX(scene_box), scene_label);
+    
+    GtkStringList *scene_names = gtk_string_list_new(NULL);
+    GtkWidget *scene_dropdown = gtk_drop_down_new(G_LIST_MODEL(scene_names), NULL);
+    gtk_widget_set_hexpand(scene_dropdown, TRUE);
+    gtk_box_append(GTK_BOX(scene_box), scene_dropdown);
+    
+    GtkWidget *recall_scene_btn = gtk_button_new_with_label("Recall");
+    gtk_widget_add_css_class(recall_scene_btn, "pill");
+    gtk_widget_set_tooltip_text(recall_scene_btn, "Apply the selected scene to the chain");
+    g_signal_connect(recall_scene_btn, "clicked", G_CALLBACK(on_recall_scene_clicked), window);
+    gtk_box_append(GTK_BOX(scene_box), recall_scene_btn);
+    
+    GtkWidget *capture_scene_btn = gtk_button_new_with_label("Capture");
+    gtk_widget_add_css_class(capture_scene_btn, "pill");
+    gtk_widget_set_tooltip_text(capture_scene_btn, "Store every parameter and bypass state as a new scene");
+    g_signal_connect(capture_scene_btn, "clicked", G_CALLBACK(on_capture_scene_clicked), window);
+    gtk_box_append(GTK_BOX(scene_box), capture_scene_btn);
+    
+    gtk_box_append(GTK_BOX(main_box), scene_box);
+    g_object_set_data(G_OBJECT(scrolled), "scene-dropdown", scene_dropdown);
+    
+    // Morph from the selected scene to another one
+    GtkWidget *morph_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
+    
+    GtkWidget *morph_label = gtk_label_new("Morph to");
+    gtk_box_append(GTK_BOX(morph_box), morph_label);
+    
+    GtkWidget *morph_dropdown = gtk_drop_down_new(G_LIST_MODEL(g_object_ref(scene_names)), NULL);
+    gtk_box_append(GTK_BOX(morph_box), morph_dropdown);
+    
+    GtkWidget *morph_scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0.0, 1.0, 0.01);
+    gtk_scale_set_draw_value(GTK_SCALE(morph_scale), FALSE);
+    gtk_widget_set_hexpand(morph_scale, TRUE);
+    gtk_widget_set_tooltip_text(morph_scale, "Blend every parameter between the two scenes");
+    g_signal_connect(morph_scale, "value-changed", G_CALLBACK(on_morph_changed), window);
+    gtk_box_append(GTK_BOX(morph_box), morph_scale);
+    
+    g_signal_connect(scene_dropdown, "notify::selected", G_CALLBACK(on_morph_scenes_changed), morph_scale);
+    g_signal_connect(morph_dropdown, "notify::selected", G_CALLBACK(on_morph_scenes_changed), morph_scale);
+    
+    gtk_box_append(GTK_BOX(main_box), morph_box);
+    g_object_set_data(G_OBJECT(scrolled), "morph-dropdown", morph_dropdown);
+    g_object_set_data(G_OBJECT(scrolled), "morph-scale", morph_scale);
+    
     // Create separator
     GtkWidget *separator = gtk_separator_new(GTK_ORIENTATION_HORIZONTAL);
     gtk_box_append(GTK_BOX(main_box), separator);
@@ -402,8 +675,35 @@ ariel_create_active_plugins_view(ArielWindow *window)
     // Store window reference for plugin removal callbacks
     g_object_set_data(G_OBJECT(plugins_box), "window", window);
     
-    // Set up drop target for the plugins box
-    GtkDropTarget *drop_target = gtk_drop_target_new(G_TYPE_STRING, GDK_ACTION_COPY);
+    // File player bar, shown while a dropped audio file plays into the chain
+    GtkWidget *player_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
+    GtkWidget *player_label = gtk_label_new(NULL);
+    gtk_label_set_ellipsize(GTK_LABEL(player_label), PANGO_ELLIPSIZE_MIDDLE);
+    gtk_widget_set_hexpand(player_label, TRUE);
+    gtk_label_set_xalign(GTK_LABEL(player_label), 0.0);
+    GtkWidget *player_mix = gtk_check_button_new_with_label("Mix with input");
+    GtkWidget *player_loop = gtk_check_button_new_with_label("Loop");
+    gtk_check_button_set_active(GTK_CHECK_BUTTON(player_loop), TRUE);
+    GtkWidget *player_stop = gtk_button_new_from_icon_name("media-playback-stop-symbolic");
+    gtk_widget_set_tooltip_text(player_stop, "Stop the file and go back to the live input");
+    g_signal_connect(player_mix, "toggled", G_CALLBACK(on_player_mix_toggled), window);
+    g_signal_connect(player_loop, "toggled", G_CALLBACK(on_player_loop_toggled), window);
+    g_signal_connect(player_stop, "clicked", G_CALLBACK(on_player_stop_clicked), window);
+    gtk_box_append(GTK_BOX(player_box), player_label);
+    gtk_box_append(GTK_BOX(player_box), player_mix);
+    gtk_box_append(GTK_BOX(player_box), player_loop);
+    gtk_box_append(GTK_BOX(player_box), player_stop);
+    gtk_widget_set_visible(player_box, FALSE);
+    gtk_box_append(GTK_BOX(main_box), player_box);
+    g_object_set_data(G_OBJECT(scrolled), "player-box", player_box);
+    g_object_set_data(G_OBJECT(scrolled), "player-label", player_label);
+    g_object_set_data(G_OBJECT(scrolled), "player-mix", player_mix);
+    g_object_set_data(G_OBJECT(scrolled), "player-loop", player_loop);
+    
+    // Set up drop target for the plugins box: plugins from the list, or
+    // audio files to play through the chain
+    GtkDropTarget *drop_target = gtk_drop_target_new(G_TYPE_INVALID, GDK_ACTION_COPY);
+    gtk_drop_target_set_gtypes(drop_target, (GType[]) { G_TYPE_STRING, GDK_TYPE_FILE_LIST }, 2);
     g_signal_connect(drop_target, "drop", G_CALLBACK(on_plugin_drop), window);
     g_signal_connect(drop_target, "enter", G_CALLBACK(on_drop_enter), plugins_box);
     g_signal_connect(drop_target, "leave", G_CALLBACK(on_drop_leave), plugins_box);
@@ -411,6 +711,19 @@ ariel_create_active_plugins_view(ArielWindow *window)
     
     gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), main_box);
     
+    // Recalls can also come from the CLI, MIDI or the control socket
+    ArielPluginManager *manager = ariel_app_get_plugin_manager(window->app);
+    if (manager && manager->scenes) {
+        ariel_scene_bank_set_recalled_func(manager->scenes, on_scene_recalled, window);
+    }
+    if (manager && manager->midi_mapper) {
+        ariel_midi_mapper_set_changed_func(manager->midi_mapper, on_midi_map_changed, window);
+    }
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
+    if (engine) {
+        ariel_audio_engine_set_patch_set_func(engine, on_plugin_file_reported, window);
+    }
+    
     return scrolled;
 }
 
@@ -427,6 +740,10 @@ ariel_update_active_plugins_view(ArielWindow *window)
     GtkWidget *plugins_box = g_object_get_data(G_OBJECT(active_plugins_view), "plugins-box");
     if (!plugins_box) return;
     
+    // A chain load brings its own scenes, and the mixer follows the slots
+    ariel_update_scene_list(window);
+    ariel_update_mixer(window);
+    
     // Clear existing plugins
     GtkWidget *child = gtk_widget_get_first_child(plugins_box);
     while (child) {
@@ -506,6 +823,11 @@ ariel_create_active_plugin_widget(ArielActivePlugin *plugin, ArielWindow *window
     gtk_widget_set_hexpand(name_label, TRUE);
     gtk_box_append(GTK_BOX(header_box), name_label);
     
+    // Level at the slot's output
+    gtk_box_append(GTK_BOX(header_box),
+                   ariel_meter_widget_new(ariel_active_plugin_get_meter(plugin), G_OBJECT(plugin),
+                                          GTK_ORIENTATION_HORIZONTAL));
+    
     // Bypass button
     GtkWidget *bypass_btn = gtk_toggle_button_new_with_label("Bypass");
     gtk_widget_add_css_class(bypass_btn, "pill");
@@ -533,6 +855,7 @@ ariel_create_active_plugin_widget(ArielActivePlugin *plugin, ArielWindow *window
     GtkWidget *load_preset_btn = gtk_button_new_with_label("Load");
     gtk_widget_add_css_class(load_preset_btn, "pill");
     gtk_widget_set_tooltip_text(load_preset_btn, "Load saved preset");
+    g_object_set_data(G_OBJECT(load_preset_btn), "window", window);
     g_signal_connect(load_preset_btn, "clicked", 
                      G_CALLBACK(on_load_preset_clicked), plugin);
     gtk_box_append(GTK_BOX(header_box), load_preset_btn);
@@ -784,6 +1107,19 @@ on_load_chain_preset_clicked(G_GNUC_UNUSED GtkButton *button, ArielWindow *windo
     ariel_config_free(config);
 }
 
+static void
+on_chain_preset_loaded(gboolean success, gpointer user_data)
+{
+    ArielWindow *window = user_data;
+    
+    if (success) {
+        // Update the active plugins view
+        ariel_update_active_plugins_view(window);
+    } else {
+        g_warning("Failed to load chain preset");
+    }
+}
+
 static void
 on_load_chain_preset_ok(GtkButton *button, G_GNUC_UNUSED gpointer user_data)
 {
@@ -810,15 +1146,9 @@ on_load_chain_preset_ok(GtkButton *button, G_GNUC_UNUSED gpointer user_data)
     ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
     
     if (manager && engine) {
-        gboolean success = ariel_load_plugin_chain_preset(manager, engine, preset_path);
-        
-        if (success) {
-            g_print("Loaded chain preset: %s\n", preset_name);
-            // Update the active plugins view
-            ariel_update_active_plugins_view(window);
-        } else {
-            g_warning("Failed to load chain preset: %s", preset_name);
-        }
+        // Built in the background while the current chain keeps playing
+        ariel_load_plugin_chain_preset_async(manager, engine, preset_path,
+                                             on_chain_preset_loaded, window);
     }
     
     g_free(preset_filename);
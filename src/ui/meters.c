@@ -0,0 +1,210 @@
+#include "ariel.h"
+#include <math.h>
+
+// Meter widgets.
+//
+// Every meter on screen is a drawing area over an ArielMeter. They do not
+// poll on their own: one tick callback, on a widget that is always shown,
+// takes all the levels once per frame, applies the ballistics and queues a
+// redraw only for meters whose picture changed. The work per frame is one
+// pass over the meters whatever their number, paced by the display.
+
+#define ARIEL_METER_MIN_DB     (-60.0f)
+#define ARIEL_METER_MAX_DB     6.0f
+#define ARIEL_METER_FALL_DB    24.0f       // Peak fall-off per second
+#define ARIEL_METER_RMS_TIME   0.3f        // RMS integration, seconds
+#define ARIEL_METER_CLIP_HOLD  (2 * G_USEC_PER_SEC)
+#define ARIEL_METER_THICKNESS  6
+
+typedef struct {
+    GtkWidget *area;
+    ArielMeter *meter;
+    GObject *owner;                        // Keeps the meter alive; NULL for the engine's own
+    GtkOrientation orientation;
+    float peak_db[2];                      // As drawn
+    float rms[2];                          // Smoothed, linear
+    float rms_db[2];                       // As drawn
+    gint64 clip_until[2];
+} ArielMeterView;
+
+static GList *live_meters = NULL;
+static gint64 last_frame_time = 0;
+
+static float
+level_to_db(float level)
+{
+    return level > 0.0f ? MAX(20.0f * log10f(level), ARIEL_METER_MIN_DB) : ARIEL_METER_MIN_DB;
+}
+
+static void
+ariel_meter_view_free(gpointer data)
+{
+    ArielMeterView *view = data;
+
+    live_meters = g_list_remove(live_meters, view);
+    if (view->owner) {
+        g_object_unref(view->owner);
+    }
+    g_free(view);
+}
+
+static void
+ariel_meter_draw(G_GNUC_UNUSED GtkDrawingArea *area, cairo_t *cr, int width, int height, gpointer data)
+{
+    ArielMeterView *view = data;
+    gboolean vertical = view->orientation == GTK_ORIENTATION_VERTICAL;
+    int length = vertical ? height : width;
+    int across = (vertical ? width : height) / 2;
+    gint64 now = g_get_monotonic_time();
+
+    cairo_set_source_rgb(cr, 0.1, 0.1, 0.1);
+    cairo_paint(cr);
+
+    for (guint c = 0; c < 2; c++) {
+        double rms = (view->rms_db[c] - ARIEL_METER_MIN_DB) / (ARIEL_METER_MAX_DB - ARIEL_METER_MIN_DB);
+        double peak = (view->peak_db[c] - ARIEL_METER_MIN_DB) / (ARIEL_METER_MAX_DB - ARIEL_METER_MIN_DB);
+        double rms_length = CLAMP(rms, 0.0, 1.0) * length;
+        double peak_length = CLAMP(peak, 0.0, 1.0) * length;
+        int offset = c * across;
+
+        // RMS as the bar, green up to -18 dBFS, then yellow, red from -6
+        if (view->rms_db[c] > -6.0f) {
+            cairo_set_source_rgb(cr, 0.85, 0.25, 0.2);
+        } else if (view->rms_db[c] > -18.0f) {
+            cairo_set_source_rgb(cr, 0.85, 0.75, 0.2);
+        } else {
+            cairo_set_source_rgb(cr, 0.3, 0.75, 0.35);
+        }
+        if (vertical) {
+            cairo_rectangle(cr, offset + 1, height - rms_length, across - 2, rms_length);
+        } else {
+            cairo_rectangle(cr, 0, offset + 1, rms_length, across - 2);
+        }
+        cairo_fill(cr);
+
+        // Peak as a thin line ahead of it
+        cairo_set_source_rgb(cr, 0.9, 0.9, 0.9);
+        if (vertical) {
+            cairo_rectangle(cr, offset + 1, height - peak_length, across - 2, 1.5);
+        } else {
+            cairo_rectangle(cr, peak_length - 1.5, offset + 1, 1.5, across - 2);
+        }
+        cairo_fill(cr);
+
+        // Clip light at the far end
+        if (view->clip_until[c] > now) {
+            cairo_set_source_rgb(cr, 0.95, 0.15, 0.15);
+            if (vertical) {
+                cairo_rectangle(cr, offset + 1, 0, across - 2, 3);
+            } else {
+                cairo_rectangle(cr, width - 3, offset + 1, 3, across - 2);
+            }
+            cairo_fill(cr);
+        }
+    }
+}
+
+// Several views may show one meter; the first to look in a frame takes
+// the levels for all of them
+static void
+ariel_meter_take_for_frame(ArielMeter *meter, gint64 frame_time, float peak[2], float rms[2])
+{
+    if (meter->taken_at != frame_time) {
+        ariel_meter_take(meter, meter->taken_peak, meter->taken_rms);
+        meter->taken_at = frame_time;
+    }
+    for (guint c = 0; c < 2; c++) {
+        peak[c] = meter->taken_peak[c];
+        rms[c] = meter->taken_rms[c];
+    }
+}
+
+// Take every meter's levels once per frame and redraw those that moved
+static gboolean
+ariel_meters_tick(G_GNUC_UNUSED GtkWidget *widget, GdkFrameClock *frame_clock, G_GNUC_UNUSED gpointer data)
+{
+    gint64 now = gdk_frame_clock_get_frame_time(frame_clock);
+    float elapsed = last_frame_time > 0 ? (float)(now - last_frame_time) / G_USEC_PER_SEC : 0.0f;
+    elapsed = CLAMP(elapsed, 0.0f, 0.1f);
+    last_frame_time = now;
+
+    float rms_weight = 1.0f - expf(-elapsed / ARIEL_METER_RMS_TIME);
+    gint64 monotonic = g_get_monotonic_time();
+
+    for (GList *l = live_meters; l; l = l->next) {
+        ArielMeterView *view = l->data;
+        float peak[2];
+        float rms[2];
+        gboolean changed = FALSE;
+
+        ariel_meter_take_for_frame(view->meter, now, peak, rms);
+
+        for (guint c = 0; c < 2; c++) {
+            float peak_db = MAX(level_to_db(peak[c]), view->peak_db[c] - ARIEL_METER_FALL_DB * elapsed);
+            peak_db = MAX(peak_db, ARIEL_METER_MIN_DB);
+
+            view->rms[c] += (rms[c] - view->rms[c]) * rms_weight;
+            float rms_db = level_to_db(view->rms[c]);
+
+            if (peak[c] >= 1.0f) {
+                if (view->clip_until[c] <= monotonic) {
+                    changed = TRUE;
+                }
+                view->clip_until[c] = monotonic + ARIEL_METER_CLIP_HOLD;
+            } else if (view->clip_until[c] != 0 && view->clip_until[c] <= monotonic) {
+                view->clip_until[c] = 0;
+                changed = TRUE;
+            }
+
+            // Tenths of a dB are below what a bar this size can show
+            if (fabsf(peak_db - view->peak_db[c]) > 0.1f || fabsf(rms_db - view->rms_db[c]) > 0.1f) {
+                changed = TRUE;
+            }
+            view->peak_db[c] = peak_db;
+            view->rms_db[c] = rms_db;
+        }
+
+        if (changed) {
+            gtk_widget_queue_draw(view->area);
+        }
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+// A meter for the given levels. owner, if not NULL, is the object the
+// meter belongs to and is kept alive with the widget.
+GtkWidget *
+ariel_meter_widget_new(ArielMeter *meter, GObject *owner, GtkOrientation orientation)
+{
+    ArielMeterView *view = g_new0(ArielMeterView, 1);
+    view->meter = meter;
+    view->owner = owner ? g_object_ref(owner) : NULL;
+    view->orientation = orientation;
+    for (guint c = 0; c < 2; c++) {
+        view->peak_db[c] = ARIEL_METER_MIN_DB;
+        view->rms_db[c] = ARIEL_METER_MIN_DB;
+    }
+
+    view->area = gtk_drawing_area_new();
+    if (orientation == GTK_ORIENTATION_VERTICAL) {
+        gtk_widget_set_size_request(view->area, 2 * ARIEL_METER_THICKNESS, -1);
+        gtk_widget_set_vexpand(view->area, TRUE);
+    } else {
+        gtk_widget_set_size_request(view->area, 100, 2 * ARIEL_METER_THICKNESS);
+        gtk_widget_set_valign(view->area, GTK_ALIGN_CENTER);
+    }
+    gtk_drawing_area_set_draw_func(GTK_DRAWING_AREA(view->area), ariel_meter_draw, view, NULL);
+    g_object_set_data_full(G_OBJECT(view->area), "meter-view", view, ariel_meter_view_free);
+
+    live_meters = g_list_prepend(live_meters, view);
+    return view->area;
+}
+
+// Drive every meter from the frame clock of widget, which should stay
+// shown as long as the window does
+void
+ariel_meters_attach(GtkWidget *widget)
+{
+    gtk_widget_add_tick_callback(widget, ariel_meters_tick, NULL, NULL);
+}
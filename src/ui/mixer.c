@@ -1,11 +1,11 @@
 #include "ariel.h"
+#include <math.h>
 
 GtkWidget *
 ariel_create_mixer(ArielWindow *window)
 {
     GtkWidget *scrolled;
     GtkWidget *box;
-    GtkWidget *label;
     
     // Create scrolled window
     scrolled = gtk_scrolled_window_new();
@@ -20,29 +20,153 @@ ariel_create_mixer(ArielWindow *window)
     gtk_widget_set_margin_top(box, 8);
     gtk_widget_set_margin_bottom(box, 8);
     
-    // Add placeholder label
-    label = gtk_label_new("Mixer channels will appear here");
-    gtk_widget_add_css_class(label, "dim-label");
-    gtk_box_append(GTK_BOX(box), label);
+    g_object_set_data(G_OBJECT(scrolled), "mixer-channels", box);
     
     gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), box);
+    window->mixer_box = scrolled;
+    ariel_update_mixer(window);
+    
+    // The mixer is always shown, so it paces every meter in the window
+    ariel_meters_attach(scrolled);
     
     return scrolled;
 }
 
+// Rebuild the channel strips: one per slot of the chain
+void
+ariel_update_mixer(ArielWindow *window)
+{
+    if (!window || !window->mixer_box) return;
+    
+    GtkWidget *box = g_object_get_data(G_OBJECT(window->mixer_box), "mixer-channels");
+    if (!box) return;
+    
+    GtkWidget *child = gtk_widget_get_first_child(box);
+    while (child) {
+        GtkWidget *next = gtk_widget_get_next_sibling(child);
+        gtk_box_remove(GTK_BOX(box), child);
+        child = next;
+    }
+    
+    ArielPluginManager *manager = ariel_app_get_plugin_manager(window->app);
+    guint n_active = manager && manager->active_plugin_store ?
+        g_list_model_get_n_items(G_LIST_MODEL(manager->active_plugin_store)) : 0;
+    
+    if (n_active == 0) {
+        GtkWidget *label = gtk_label_new("Mixer channels will appear here");
+        gtk_widget_add_css_class(label, "dim-label");
+        gtk_widget_set_hexpand(label, TRUE);
+        gtk_box_append(GTK_BOX(box), label);
+    }
+    
+    for (guint i = 0; i < n_active; i++) {
+        ArielActivePlugin *plugin = g_list_model_get_item(G_LIST_MODEL(manager->active_plugin_store), i);
+        gtk_box_append(GTK_BOX(box), ariel_create_mixer_channel(plugin));
+        g_object_unref(plugin);
+    }
+    
+    // Master level of the final output, always last
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
+    if (engine) {
+        GtkWidget *master = gtk_frame_new("Master");
+        GtkWidget *meter = ariel_meter_widget_new(&engine->master_meter, NULL, GTK_ORIENTATION_VERTICAL);
+        gtk_widget_set_margin_start(meter, 4);
+        gtk_widget_set_margin_end(meter, 4);
+        gtk_widget_set_margin_top(meter, 4);
+        gtk_widget_set_margin_bottom(meter, 4);
+        gtk_widget_set_halign(meter, GTK_ALIGN_CENTER);
+        gtk_frame_set_child(GTK_FRAME(master), meter);
+        gtk_box_append(GTK_BOX(box), master);
+    }
+}
+
+static double
+gain_to_db(float gain)
+{
+    return gain > 0.0f ? CLAMP(20.0 * log10(gain), ARIEL_SLOT_GAIN_MIN_DB, ARIEL_SLOT_GAIN_MAX_DB) :
+        ARIEL_SLOT_GAIN_MIN_DB;
+}
+
+// Each control changes one setting of the slot and leaves the others
+static void
+on_output_gain_changed(GtkRange *range, ArielActivePlugin *plugin)
+{
+    ArielSlotMix mix;
+    ariel_active_plugin_get_slot_mix(plugin, &mix);
+    mix.output_gain = ariel_db_to_gain(gtk_range_get_value(range));
+    ariel_active_plugin_set_slot_mix(plugin, &mix);
+}
+
+static void
+on_input_gain_changed(GtkRange *range, ArielActivePlugin *plugin)
+{
+    ArielSlotMix mix;
+    ariel_active_plugin_get_slot_mix(plugin, &mix);
+    mix.input_gain = ariel_db_to_gain(gtk_range_get_value(range));
+    ariel_active_plugin_set_slot_mix(plugin, &mix);
+}
+
+static void
+on_mix_changed(GtkRange *range, ArielActivePlugin *plugin)
+{
+    ArielSlotMix mix;
+    ariel_active_plugin_get_slot_mix(plugin, &mix);
+    mix.mix = (float)(gtk_range_get_value(range) / 100.0);
+    ariel_active_plugin_set_slot_mix(plugin, &mix);
+}
+
+static void
+on_pan_changed(GtkRange *range, ArielActivePlugin *plugin)
+{
+    ArielSlotMix mix;
+    ariel_active_plugin_get_slot_mix(plugin, &mix);
+    mix.pan = (float)gtk_range_get_value(range);
+    ariel_active_plugin_set_slot_mix(plugin, &mix);
+}
+
+static void
+on_mute_toggled(GtkToggleButton *button, ArielActivePlugin *plugin)
+{
+    ArielSlotMix mix;
+    ariel_active_plugin_get_slot_mix(plugin, &mix);
+    mix.mute = gtk_toggle_button_get_active(button);
+    ariel_active_plugin_set_slot_mix(plugin, &mix);
+}
+
+static GtkWidget *
+ariel_create_mixer_scale(const char *caption, double min, double max, double step, double value,
+                         GCallback callback, ArielActivePlugin *plugin, GtkWidget *vbox)
+{
+    GtkWidget *label = gtk_label_new(caption);
+    gtk_widget_add_css_class(label, "caption");
+    gtk_box_append(GTK_BOX(vbox), label);
+    
+    GtkWidget *scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, min, max, step);
+    gtk_range_set_value(GTK_RANGE(scale), value);
+    gtk_scale_set_draw_value(GTK_SCALE(scale), FALSE);
+    gtk_widget_set_size_request(scale, 60, -1);
+    g_signal_connect(scale, "value-changed", callback, plugin);
+    gtk_box_append(GTK_BOX(vbox), scale);
+    
+    return scale;
+}
+
 GtkWidget *
-ariel_create_mixer_channel(const char *name, int channel_id)
+ariel_create_mixer_channel(ArielActivePlugin *plugin)
 {
     GtkWidget *frame;
     GtkWidget *vbox;
     GtkWidget *label;
     GtkWidget *volume_scale;
-    GtkWidget *pan_scale;
     GtkWidget *mute_button;
+    ArielSlotMix mix;
     
-    // Create frame for the channel
-    frame = gtk_frame_new(name);
+    ariel_active_plugin_get_slot_mix(plugin, &mix);
+    
+    // Create frame for the channel; it keeps the plugin alive for the callbacks
+    frame = gtk_frame_new(ariel_active_plugin_get_name(plugin));
     gtk_widget_set_size_request(frame, 80, -1);
+    g_object_set_data_full(G_OBJECT(frame), "plugin", g_object_ref(plugin), g_object_unref);
     
     // Create vertical box for controls
     vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 4);
@@ -51,37 +175,42 @@ ariel_create_mixer_channel(const char *name, int channel_id)
     gtk_widget_set_margin_top(vbox, 4);
     gtk_widget_set_margin_bottom(vbox, 4);
     
-    // Volume control (vertical slider)
-    volume_scale = gtk_scale_new_with_range(GTK_ORIENTATION_VERTICAL, 0.0, 1.0, 0.01);
-    gtk_range_set_value(GTK_RANGE(volume_scale), 0.8);
+    ariel_create_mixer_scale("In", ARIEL_SLOT_GAIN_MIN_DB, ARIEL_SLOT_GAIN_MAX_DB, 0.5,
+                             gain_to_db(mix.input_gain), G_CALLBACK(on_input_gain_changed), plugin, vbox);
+    ariel_create_mixer_scale("Mix", 0.0, 100.0, 1.0, mix.mix * 100.0,
+                             G_CALLBACK(on_mix_changed), plugin, vbox);
+    
+    // Output gain (vertical slider, in dB), next to the slot's meter
+    label = gtk_label_new("Vol");
+    gtk_widget_add_css_class(label, "caption");
+    gtk_box_append(GTK_BOX(vbox), label);
+    
+    GtkWidget *volume_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 2);
+    gtk_widget_set_vexpand(volume_box, TRUE);
+    gtk_box_append(GTK_BOX(vbox), volume_box);
+    
+    volume_scale = gtk_scale_new_with_range(GTK_ORIENTATION_VERTICAL, ARIEL_SLOT_GAIN_MIN_DB, ARIEL_SLOT_GAIN_MAX_DB, 0.5);
+    gtk_range_set_value(GTK_RANGE(volume_scale), gain_to_db(mix.output_gain));
+    gtk_scale_add_mark(GTK_SCALE(volume_scale), 0.0, GTK_POS_RIGHT, NULL);
     gtk_scale_set_draw_value(GTK_SCALE(volume_scale), FALSE);
     gtk_widget_set_vexpand(volume_scale, TRUE);
     gtk_range_set_inverted(GTK_RANGE(volume_scale), TRUE);
+    g_signal_connect(volume_scale, "value-changed", G_CALLBACK(on_output_gain_changed), plugin);
+    gtk_box_append(GTK_BOX(volume_box), volume_scale);
+    gtk_box_append(GTK_BOX(volume_box),
+                   ariel_meter_widget_new(ariel_active_plugin_get_meter(plugin), G_OBJECT(plugin),
+                                          GTK_ORIENTATION_VERTICAL));
     
-    // Pan control (horizontal slider)
-    pan_scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, -1.0, 1.0, 0.01);
-    gtk_range_set_value(GTK_RANGE(pan_scale), 0.0);
-    gtk_scale_set_draw_value(GTK_SCALE(pan_scale), FALSE);
-    gtk_widget_set_size_request(pan_scale, 60, -1);
+    ariel_create_mixer_scale("Pan", -1.0, 1.0, 0.01, mix.pan, G_CALLBACK(on_pan_changed), plugin, vbox);
     
     // Mute button
     mute_button = gtk_toggle_button_new_with_label("M");
     gtk_widget_add_css_class(mute_button, "destructive-action");
-    
-    // Volume label
-    label = gtk_label_new("Vol");
-    gtk_widget_add_css_class(label, "caption");
-    
-    gtk_box_append(GTK_BOX(vbox), label);
-    gtk_box_append(GTK_BOX(vbox), volume_scale);
-    
-    label = gtk_label_new("Pan");
-    gtk_widget_add_css_class(label, "caption");
-    gtk_box_append(GTK_BOX(vbox), label);
-    gtk_box_append(GTK_BOX(vbox), pan_scale);
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(mute_button), mix.mute);
+    g_signal_connect(mute_button, "toggled", G_CALLBACK(on_mute_toggled), plugin);
     gtk_box_append(GTK_BOX(vbox), mute_button);
     
     gtk_frame_set_child(GTK_FRAME(frame), vbox);
     
     return frame;
-}
\ No newline at end of file
+}
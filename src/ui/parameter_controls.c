@@ -7,8 +7,73 @@ typedef struct {
     uint32_t param_index;
     GtkWidget *control_widget; // Reference to the control widget
     char *parameter_uri; // For file parameters - the actual parameter URI
+    GtkWidget *midi_button; // MIDI learn button, scales and toggles only
 } ParameterControlData;
 
+// Live scale and toggle controls, so MIDI moves can be shown
+static GList *live_controls = NULL;
+
+// Live file buttons, so files the plugins report loading can be shown
+static GList *live_file_controls = NULL;
+
+static void
+parameter_control_data_free(gpointer data, G_GNUC_UNUSED GClosure *closure)
+{
+    live_controls = g_list_remove(live_controls, data);
+    g_free(data);
+}
+
+static void
+file_control_data_free(gpointer user_data, G_GNUC_UNUSED GClosure *closure)
+{
+    ParameterControlData *data = user_data;
+    
+    live_file_controls = g_list_remove(live_file_controls, data);
+    g_free(data->parameter_uri);
+    g_free(data);
+}
+
+// Label a file button with the file it holds. Until the plugin confirms
+// loading it, the button is dimmed.
+static void
+show_file_on_button(GtkWidget *button, const char *file_path, gboolean confirmed)
+{
+    char *basename = g_path_get_basename(file_path);
+    char *label = g_strdup_printf("📁 %s", basename);
+    gtk_button_set_label(GTK_BUTTON(button), label);
+    gtk_widget_set_tooltip_text(button, file_path);
+    
+    if (confirmed) {
+        gtk_widget_remove_css_class(button, "dim-label");
+    } else {
+        gtk_widget_add_css_class(button, "dim-label");
+    }
+    
+    g_free(basename);
+    g_free(label);
+}
+
+// A plugin reported the file it loaded for a parameter (main thread)
+void
+ariel_parameter_controls_show_file(ArielActivePlugin *plugin, const char *parameter_uri, const char *file_path)
+{
+    for (GList *l = live_file_controls; l; l = l->next) {
+        ParameterControlData *data = l->data;
+        if (data->plugin != plugin || g_strcmp0(data->parameter_uri, parameter_uri) != 0) {
+            continue;
+        }
+        
+        if (*file_path) {
+            show_file_on_button(data->control_widget, file_path, TRUE);
+        } else {
+            // The plugin unloaded it
+            gtk_button_set_label(GTK_BUTTON(data->control_widget), "Choose File...");
+            gtk_widget_set_tooltip_text(data->control_widget, NULL);
+            gtk_widget_remove_css_class(data->control_widget, "dim-label");
+        }
+    }
+}
+
 // Callback for parameter value changes (scales)
 static void
 on_parameter_changed(GtkRange *range, ParameterControlData *data)
@@ -39,6 +104,72 @@ on_toggle_changed(GtkToggleButton *button, ParameterControlData *data)
 
 
 
+// Show whether the control is mapped to a MIDI controller
+static void
+update_midi_button(ParameterControlData *data)
+{
+    ArielApp *app = ARIEL_APP(g_application_get_default());
+    ArielPluginManager *manager = ariel_app_get_plugin_manager(app);
+    if (!manager || !data->midi_button) return;
+    
+    const ArielMidiMapping *mapping = ariel_midi_mapper_lookup(manager->midi_mapper, data->plugin, data->param_index);
+    
+    if (ariel_midi_mapper_is_learning(manager->midi_mapper, data->plugin, data->param_index)) {
+        gtk_button_set_label(GTK_BUTTON(data->midi_button), "Learning…");
+    } else if (mapping) {
+        char *label = g_strdup_printf("CC %u", mapping->cc);
+        gtk_button_set_label(GTK_BUTTON(data->midi_button), label);
+        g_free(label);
+    } else {
+        gtk_button_set_label(GTK_BUTTON(data->midi_button), "MIDI");
+    }
+}
+
+// Callback for the MIDI button: learn, cancel learning, or unmap
+static void
+on_midi_button_clicked(G_GNUC_UNUSED GtkButton *button, ParameterControlData *data)
+{
+    ArielApp *app = ARIEL_APP(g_application_get_default());
+    ArielPluginManager *manager = ariel_app_get_plugin_manager(app);
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(app);
+    if (!manager || !engine) return;
+    
+    if (ariel_midi_mapper_is_learning(manager->midi_mapper, data->plugin, data->param_index)) {
+        ariel_midi_mapper_cancel_learn(manager->midi_mapper, engine);
+    } else if (ariel_midi_mapper_lookup(manager->midi_mapper, data->plugin, data->param_index)) {
+        ariel_midi_mapper_forget(manager->midi_mapper, engine, data->plugin, data->param_index);
+    } else {
+        ariel_midi_mapper_learn(manager->midi_mapper, engine, data->plugin, data->param_index);
+    }
+    
+    // Only one control learns at a time, so refresh them all
+    for (GList *l = live_controls; l; l = l->next) {
+        update_midi_button(l->data);
+    }
+}
+
+// Bring scales and toggles up to date with their plugins' control values
+void
+ariel_parameter_controls_sync(void)
+{
+    for (GList *l = live_controls; l; l = l->next) {
+        ParameterControlData *data = l->data;
+        float value = ariel_active_plugin_get_parameter(data->plugin, data->param_index);
+        
+        if (GTK_IS_TOGGLE_BUTTON(data->control_widget)) {
+            gboolean active = value > 0.5f;
+            g_signal_handlers_block_by_func(data->control_widget, on_toggle_changed, data);
+            gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(data->control_widget), active);
+            gtk_button_set_label(GTK_BUTTON(data->control_widget), active ? "On" : "Off");
+            g_signal_handlers_unblock_by_func(data->control_widget, on_toggle_changed, data);
+        } else if (GTK_IS_RANGE(data->control_widget)) {
+            g_signal_handlers_block_by_func(data->control_widget, on_parameter_changed, data);
+            gtk_range_set_value(GTK_RANGE(data->control_widget), value);
+            g_signal_handlers_unblock_by_func(data->control_widget, on_parameter_changed, data);
+        }
+    }
+}
+
 // Forward declarations
 static void on_file_dialog_open_finish(GObject *source, GAsyncResult *result, gpointer user_data);
 
@@ -159,18 +290,12 @@ on_file_dialog_open_finish(GObject *source, GAsyncResult *result, gpointer user_
                     g_warning("Plugin does not support file parameters or parameter URI is missing");
                 }
                 
-                // Update button label to show filename
-                char *basename = g_path_get_basename(file_path);
-                char *label = g_strdup_printf("📁 %s", basename);
-                gtk_button_set_label(GTK_BUTTON(data->control_widget), label);
-                
-                // Add tooltip with full path
-                gtk_widget_set_tooltip_text(data->control_widget, file_path);
+                // Show the file, pending until the plugin reports loading
+                // it, if it can
+                show_file_on_button(data->control_widget, file_path,
+                                    !ariel_active_plugin_has_atom_outputs(data->plugin));
                 
-                g_free(basename);
-                g_free(label);
-                
-                g_print("Audio/model file loaded: %s\n", file_path);
+                g_print("Audio/model file sent to plugin: %s\n", file_path);
             } else {
                 g_warning("Invalid file type selected: %s. Please select a supported audio or model file (.nam, .wav, .ir, .json, etc.).", file_path);
                 
@@ -383,14 +508,17 @@ create_parameter_control(ArielActivePlugin *plugin, uint32_t param_index)
     gtk_widget_set_margin_top(param_box, 4);
     gtk_widget_set_margin_bottom(param_box, 4);
     
-    // Create label
+    // Create label, with room for the MIDI button beside it
+    GtkWidget *label_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 4);
     GtkWidget *param_label = gtk_label_new(label);
     gtk_label_set_xalign(GTK_LABEL(param_label), 0.0);
+    gtk_widget_set_hexpand(param_label, TRUE);
     gtk_widget_add_css_class(param_label, "caption");
-    gtk_box_append(GTK_BOX(param_box), param_label);
+    gtk_box_append(GTK_BOX(label_box), param_label);
+    gtk_box_append(GTK_BOX(param_box), label_box);
     
     // Create callback data
-    ParameterControlData *data = g_malloc(sizeof(ParameterControlData));
+    ParameterControlData *data = g_malloc0(sizeof(ParameterControlData));
     data->plugin = plugin;
     data->param_index = param_index;
     
@@ -429,7 +557,8 @@ create_parameter_control(ArielActivePlugin *plugin, uint32_t param_index)
         
         g_signal_connect_data(control_widget, "toggled",
                              G_CALLBACK(on_toggle_changed), data,
-                             (GClosureNotify)g_free, 0);
+                             parameter_control_data_free, 0);
+        live_controls = g_list_prepend(live_controls, data);
         
         g_print("Created toggle button for parameter: %s\n", label);
         
@@ -452,7 +581,19 @@ create_parameter_control(ArielActivePlugin *plugin, uint32_t param_index)
         data->control_widget = control_widget;
         g_signal_connect_data(control_widget, "value-changed",
                              G_CALLBACK(on_parameter_changed), data,
-                             (GClosureNotify)g_free, 0);
+                             parameter_control_data_free, 0);
+        live_controls = g_list_prepend(live_controls, data);
+    }
+    
+    // Scales and toggles can follow a MIDI controller
+    if (g_list_find(live_controls, data)) {
+        data->midi_button = gtk_button_new_with_label("MIDI");
+        gtk_widget_add_css_class(data->midi_button, "flat");
+        gtk_widget_add_css_class(data->midi_button, "caption");
+        gtk_widget_set_tooltip_text(data->midi_button, "Map to the next MIDI controller moved, or unmap");
+        g_signal_connect(data->midi_button, "clicked", G_CALLBACK(on_midi_button_clicked), data);
+        gtk_box_append(GTK_BOX(label_box), data->midi_button);
+        update_midi_button(data);
     }
     
     if (control_widget) {
@@ -524,8 +665,15 @@ create_file_parameter_control_with_uri(ArielActivePlugin *plugin, const LilvPlug
     g_signal_connect_data(file_button, "clicked", 
                          G_CALLBACK(on_file_button_clicked), 
                          data, 
-                         (GClosureNotify)g_free, 
+                         file_control_data_free, 
                          0);
+    live_file_controls = g_list_prepend(live_file_controls, data);
+    
+    // A rebuilt panel shows what the plugin already loaded
+    const char *reported = ariel_active_plugin_get_reported_file(plugin, parameter_uri);
+    if (reported && *reported) {
+        show_file_on_button(file_button, reported, TRUE);
+    }
     
     gtk_box_append(GTK_BOX(param_box), file_button);
     
@@ -629,6 +777,145 @@ create_file_parameter_control(ArielActivePlugin *plugin, const LilvPlugin *lilv_
     return param_box;
 }
 
+// Read-only view of a plugin's control outputs (meters, gain reduction,
+// tuner readouts). The panel reads them all once per frame from the
+// plugin's snapshot and touches only the widgets whose value moved.
+typedef struct {
+    ArielActivePlugin *plugin;          // Holds a ref
+    guint n_outputs;
+    float *shown;                       // Values on screen
+    float *fresh;                       // This frame's read
+    float *min;
+    float *max;
+    GtkWidget **bars;
+    GtkWidget **labels;
+    gboolean has_values;
+} ControlOutputsView;
+
+static void
+control_outputs_view_free(gpointer data)
+{
+    ControlOutputsView *view = data;
+    
+    g_object_unref(view->plugin);
+    g_free(view->shown);
+    g_free(view->fresh);
+    g_free(view->min);
+    g_free(view->max);
+    g_free(view->bars);
+    g_free(view->labels);
+    g_free(view);
+}
+
+static void
+show_control_output(ControlOutputsView *view, guint i, float value)
+{
+    gtk_level_bar_set_value(GTK_LEVEL_BAR(view->bars[i]), CLAMP(value, view->min[i], view->max[i]));
+    
+    char text[32];
+    g_snprintf(text, sizeof(text), "%.2f", value);
+    gtk_label_set_text(GTK_LABEL(view->labels[i]), text);
+}
+
+static gboolean
+on_control_outputs_tick(G_GNUC_UNUSED GtkWidget *widget, G_GNUC_UNUSED GdkFrameClock *frame_clock, gpointer user_data)
+{
+    ControlOutputsView *view = user_data;
+    
+    if (!ariel_active_plugin_read_control_outputs(view->plugin, view->fresh, view->n_outputs)) {
+        return G_SOURCE_CONTINUE;
+    }
+    
+    for (guint i = 0; i < view->n_outputs; i++) {
+        float value = view->fresh[i];
+        if (!isfinite(value)) {
+            continue;
+        }
+        
+        // Hundredths are all the label shows, and finer than the bar can
+        if (view->has_values && roundf(value * 100.0f) == roundf(view->shown[i] * 100.0f)) {
+            continue;
+        }
+        view->shown[i] = value;
+        show_control_output(view, i, value);
+    }
+    view->has_values = TRUE;
+    
+    return G_SOURCE_CONTINUE;
+}
+
+// Append a row per control output to box and keep them current from the
+// frame clock of owner
+static void
+create_control_outputs(ArielActivePlugin *plugin, GtkWidget *box, GtkWidget *owner)
+{
+    const LilvPlugin *lilv_plugin = ariel_active_plugin_get_lilv_plugin(plugin);
+    guint n_outputs = ariel_active_plugin_get_n_control_outputs(plugin);
+    
+    ControlOutputsView *view = g_new0(ControlOutputsView, 1);
+    view->plugin = g_object_ref(plugin);
+    view->n_outputs = n_outputs;
+    view->shown = g_new0(float, n_outputs);
+    view->fresh = g_new0(float, n_outputs);
+    view->min = g_new0(float, n_outputs);
+    view->max = g_new0(float, n_outputs);
+    view->bars = g_new0(GtkWidget *, n_outputs);
+    view->labels = g_new0(GtkWidget *, n_outputs);
+    
+    GtkWidget *header_label = gtk_label_new("Plugin Outputs");
+    gtk_widget_add_css_class(header_label, "title-4");
+    gtk_label_set_xalign(GTK_LABEL(header_label), 0.0);
+    gtk_box_append(GTK_BOX(box), header_label);
+    gtk_box_append(GTK_BOX(box), gtk_separator_new(GTK_ORIENTATION_HORIZONTAL));
+    
+    for (guint i = 0; i < n_outputs; i++) {
+        uint32_t port_index = ariel_active_plugin_get_control_output_port_index(plugin, i);
+        const LilvPort *port = lilv_plugin_get_port_by_index(lilv_plugin, port_index);
+        char *label = get_parameter_label(lilv_plugin, port);
+        float min_val, max_val, default_val;
+        get_parameter_range(lilv_plugin, port, &min_val, &max_val, &default_val);
+        
+        // Gain reduction is often declared from 0 down
+        view->min[i] = MIN(min_val, max_val);
+        view->max[i] = MAX(min_val, max_val);
+        if (view->max[i] <= view->min[i]) {
+            view->max[i] = view->min[i] + 1.0f;
+        }
+        
+        GtkWidget *output_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 4);
+        gtk_widget_set_margin_start(output_box, 8);
+        gtk_widget_set_margin_end(output_box, 8);
+        gtk_widget_set_margin_top(output_box, 4);
+        gtk_widget_set_margin_bottom(output_box, 4);
+        
+        GtkWidget *output_label = gtk_label_new(label);
+        gtk_label_set_xalign(GTK_LABEL(output_label), 0.0);
+        gtk_widget_add_css_class(output_label, "caption");
+        gtk_box_append(GTK_BOX(output_box), output_label);
+        
+        GtkWidget *value_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
+        view->bars[i] = gtk_level_bar_new_for_interval(view->min[i], view->max[i]);
+        gtk_level_bar_remove_offset_value(GTK_LEVEL_BAR(view->bars[i]), GTK_LEVEL_BAR_OFFSET_LOW);
+        gtk_level_bar_remove_offset_value(GTK_LEVEL_BAR(view->bars[i]), GTK_LEVEL_BAR_OFFSET_HIGH);
+        gtk_level_bar_remove_offset_value(GTK_LEVEL_BAR(view->bars[i]), GTK_LEVEL_BAR_OFFSET_FULL);
+        gtk_widget_set_hexpand(view->bars[i], TRUE);
+        gtk_widget_set_valign(view->bars[i], GTK_ALIGN_CENTER);
+        gtk_box_append(GTK_BOX(value_box), view->bars[i]);
+        
+        view->labels[i] = gtk_label_new("–");
+        gtk_label_set_width_chars(GTK_LABEL(view->labels[i]), 8);
+        gtk_label_set_xalign(GTK_LABEL(view->labels[i]), 1.0);
+        gtk_widget_add_css_class(view->labels[i], "numeric");
+        gtk_box_append(GTK_BOX(value_box), view->labels[i]);
+        
+        gtk_box_append(GTK_BOX(output_box), value_box);
+        gtk_box_append(GTK_BOX(box), output_box);
+        g_free(label);
+    }
+    
+    gtk_widget_add_tick_callback(owner, on_control_outputs_tick, view, control_outputs_view_free);
+}
+
 GtkWidget *
 ariel_create_parameter_controls(ArielActivePlugin *plugin)
 {
@@ -750,6 +1037,11 @@ ariel_create_parameter_controls(ArielActivePlugin *plugin)
         }
     }
     
+    // Read-only outputs, such as gain reduction or a tuner's readout
+    if (ariel_active_plugin_get_n_control_outputs(plugin) > 0) {
+        create_control_outputs(plugin, params_box, scrolled);
+    }
+    
     gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), params_box);
     
     return scrolled;
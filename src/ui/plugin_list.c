@@ -4,10 +4,44 @@
 static GdkContentProvider *on_drag_prepare(GtkDragSource *source, double x, double y, gpointer user_data);
 static void on_drag_begin(GtkDragSource *source, GdkDrag *drag, gpointer user_data);
 static void on_search_changed(GtkSearchEntry *entry, gpointer user_data);
+static void on_search_results(ArielPluginSearch *search, gpointer user_data);
 static void on_category_changed(GtkDropDown *dropdown, GParamSpec *pspec, gpointer user_data);
 static gboolean plugin_filter_func(gpointer item, gpointer user_data);
+static int plugin_sort_func(gconstpointer a, gconstpointer b, gpointer user_data);
 static void populate_category_dropdown(GtkDropDown *dropdown, ArielPluginManager *manager);
 
+// Shared state of the search entry, category dropdown, filter and sorter
+typedef struct {
+    GtkWidget *search_entry;
+    GtkWidget *category_dropdown;
+    ArielPluginSearch *search;
+    GtkFilter *filter;
+    GtkSorter *sorter;
+} PluginListFilter;
+
+static void
+plugin_list_filter_free(gpointer data)
+{
+    PluginListFilter *filter_data = data;
+    ariel_plugin_search_free(filter_data->search);
+    g_clear_object(&filter_data->sorter);
+    g_free(filter_data);
+}
+
+static void
+on_plugin_loaded(ArielActivePlugin *active_plugin, gpointer user_data)
+{
+    ArielWindow *window = user_data;
+    
+    if (active_plugin) {
+        g_print("Successfully loaded plugin: %s\n", 
+                ariel_active_plugin_get_name(active_plugin));
+        
+        // Update the active plugins view
+        ariel_update_active_plugins_view(window);
+    }
+}
+
 static void
 on_plugin_row_activated(GtkListView *list_view, guint position, ArielWindow *window)
 {
@@ -49,22 +83,9 @@ on_plugin_row_activated(GtkListView *list_view, guint position, ArielWindow *win
         return;
     }
     
-    // Load the plugin
-    ArielActivePlugin *active_plugin = ariel_plugin_manager_load_plugin(
-        plugin_manager, plugin_info, engine);
-    
-    if (active_plugin) {
-        g_print("Successfully loaded plugin: %s\n", 
-                ariel_active_plugin_get_name(active_plugin));
-        
-        // Update the active plugins view
-        ariel_update_active_plugins_view(window);
-        
-        g_object_unref(active_plugin); // List store holds its own reference
-    } else {
-        g_warning("Failed to load plugin: %s", 
-                  ariel_plugin_info_get_name(plugin_info));
-    }
+    // Load the plugin in the background; the view updates once it is in the chain
+    ariel_plugin_manager_load_plugin_async(plugin_manager, plugin_info, engine,
+                                           on_plugin_loaded, window);
     
     g_object_unref(plugin_info);
 }
@@ -119,6 +140,8 @@ ariel_create_plugin_list(ArielWindow *window)
     GtkSelectionModel *selection_model;
     GtkCustomFilter *custom_filter;
     GtkFilterListModel *filter_model;
+    GtkCustomSorter *custom_sorter;
+    GtkSortListModel *sort_model;
     
     // Create main container
     main_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
@@ -323,7 +346,7 @@ skip_search_setup:
 #ifdef _WIN32
     g_print("About to allocate filter_data (16 bytes)...\n");
 #endif
-    GtkWidget **filter_data = g_try_new(GtkWidget*, 2);
+    PluginListFilter *filter_data = g_try_new0(PluginListFilter, 1);
     if (!filter_data) {
         g_warning("Failed to allocate filter_data - creating simplified list");
         // Create simple list view without filtering
@@ -333,16 +356,18 @@ skip_search_setup:
         return main_box;
     }
     
-    filter_data[0] = search_entry;
-    filter_data[1] = category_dropdown;
+    filter_data->search_entry = search_entry;
+    filter_data->category_dropdown = category_dropdown;
+    filter_data->search = ariel_plugin_search_new(G_LIST_MODEL(plugin_manager->plugin_store),
+                                                  on_search_results, filter_data);
     
 #ifdef _WIN32
     g_print("About to create custom filter...\n");
 #endif
-    custom_filter = gtk_custom_filter_new(plugin_filter_func, filter_data, g_free);
+    custom_filter = gtk_custom_filter_new(plugin_filter_func, filter_data, plugin_list_filter_free);
     if (!custom_filter) {
         g_warning("Failed to create custom filter - creating simplified list");
-        g_free(filter_data);
+        plugin_list_filter_free(filter_data);
         list_view = gtk_list_view_new(GTK_SELECTION_MODEL(gtk_single_selection_new(G_LIST_MODEL(plugin_manager->plugin_store))), factory);
         gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), list_view);
         gtk_box_append(GTK_BOX(main_box), scrolled);
@@ -362,9 +387,15 @@ skip_search_setup:
         return main_box;
     }
     
-    // Create selection model with filtered model
+    // Rank the filtered rows by search score; plain store order when not searching
+    custom_sorter = gtk_custom_sorter_new(plugin_sort_func, filter_data, NULL);
+    filter_data->filter = GTK_FILTER(custom_filter);
+    filter_data->sorter = g_object_ref(GTK_SORTER(custom_sorter));
+    sort_model = gtk_sort_list_model_new(G_LIST_MODEL(filter_model), GTK_SORTER(custom_sorter));
+    
+    // Create selection model with filtered and sorted model
     selection_model = GTK_SELECTION_MODEL(
-        gtk_single_selection_new(G_LIST_MODEL(filter_model))
+        gtk_single_selection_new(G_LIST_MODEL(sort_model))
     );
     
     // Create list view
@@ -398,7 +429,7 @@ skip_search_setup:
     // Connect search and category functionality
     g_object_set_data(G_OBJECT(search_entry), "filter", custom_filter);
     g_object_set_data(G_OBJECT(category_dropdown), "filter", custom_filter);
-    g_signal_connect(search_entry, "search-changed", G_CALLBACK(on_search_changed), custom_filter);
+    g_signal_connect(search_entry, "search-changed", G_CALLBACK(on_search_changed), filter_data);
     g_signal_connect(category_dropdown, "notify::selected", G_CALLBACK(on_category_changed), custom_filter);
     
     gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(scrolled), list_view);
@@ -508,12 +539,23 @@ bind_plugin_list_item(GtkListItemFactory *factory, GtkListItem *list_item, gpoin
 
 // Search functionality
 static void
-on_search_changed(G_GNUC_UNUSED GtkSearchEntry *entry, gpointer user_data)
+on_search_changed(GtkSearchEntry *entry, gpointer user_data)
 {
-    GtkCustomFilter *filter = GTK_CUSTOM_FILTER(user_data);
+    PluginListFilter *filter_data = user_data;
     
-    // Trigger filter update
-    gtk_filter_changed(GTK_FILTER(filter), GTK_FILTER_CHANGE_DIFFERENT);
+    // Scoring runs in the background; on_search_results refreshes the view
+    ariel_plugin_search_set_query(filter_data->search,
+                                  gtk_editable_get_text(GTK_EDITABLE(entry)));
+}
+
+static void
+on_search_results(G_GNUC_UNUSED ArielPluginSearch *search, gpointer user_data)
+{
+    PluginListFilter *filter_data = user_data;
+    
+    // Trigger filter and ranking update
+    gtk_filter_changed(filter_data->filter, GTK_FILTER_CHANGE_DIFFERENT);
+    gtk_sorter_changed(filter_data->sorter, GTK_SORTER_CHANGE_DIFFERENT);
 }
 
 static void
@@ -564,14 +606,13 @@ static gboolean
 plugin_filter_func(gpointer item, gpointer user_data)
 {
     ArielPluginInfo *plugin_info = ARIEL_PLUGIN_INFO(item);
-    GtkWidget **filter_data = (GtkWidget**)user_data;
+    PluginListFilter *filter_data = user_data;
     
     if (!plugin_info || !filter_data) {
         return TRUE; // Show all if no filter context
     }
     
-    GtkSearchEntry *search_entry = GTK_SEARCH_ENTRY(filter_data[0]);
-    GtkDropDown *category_dropdown = GTK_DROP_DOWN(filter_data[1]);
+    GtkDropDown *category_dropdown = GTK_DROP_DOWN(filter_data->category_dropdown);
     
     // Check category filter first
     guint selected_category = gtk_drop_down_get_selected(category_dropdown);
@@ -590,66 +631,33 @@ plugin_filter_func(gpointer item, gpointer user_data)
         }
     }
     
-    // Check search filter
-    const char *search_text = gtk_editable_get_text(GTK_EDITABLE(search_entry));
-    
-    // If search is empty, show all plugins (that pass category filter)
-    if (!search_text || strlen(search_text) == 0) {
-        return TRUE;
-    }
-    
-    // Convert search text to lowercase for case-insensitive search
-    char *search_lower = g_utf8_strdown(search_text, -1);
-    
-    gboolean match = FALSE;
-    
-    // Search in plugin name
-    const char *plugin_name = ariel_plugin_info_get_name(plugin_info);
-    if (plugin_name) {
-        char *name_lower = g_utf8_strdown(plugin_name, -1);
-        if (strstr(name_lower, search_lower) != NULL) {
-            match = TRUE;
-        }
-        g_free(name_lower);
-    }
+    // Search filter: the scores of the last finished query decide visibility
+    return ariel_plugin_search_lookup(filter_data->search, plugin_info, NULL);
+}
+
+static int
+plugin_sort_func(gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    PluginListFilter *filter_data = user_data;
+    ArielPluginInfo *info_a = ARIEL_PLUGIN_INFO((gpointer)a);
+    ArielPluginInfo *info_b = ARIEL_PLUGIN_INFO((gpointer)b);
     
-    // Search in author name if name didn't match
-    if (!match) {
-        const char *author = ariel_plugin_info_get_author(plugin_info);
-        if (author) {
-            char *author_lower = g_utf8_strdown(author, -1);
-            if (strstr(author_lower, search_lower) != NULL) {
-                match = TRUE;
-            }
-            g_free(author_lower);
-        }
+    // Keep store order when there is nothing to rank
+    if (!ariel_plugin_search_is_active(filter_data->search)) {
+        return GTK_ORDERING_EQUAL;
     }
     
-    // Search in category if still no match
-    if (!match) {
-        const char *category = ariel_plugin_info_get_category(plugin_info);
-        if (category) {
-            char *category_lower = g_utf8_strdown(category, -1);
-            if (strstr(category_lower, search_lower) != NULL) {
-                match = TRUE;
-            }
-            g_free(category_lower);
-        }
-    }
+    gint score_a = 0;
+    gint score_b = 0;
+    ariel_plugin_search_lookup(filter_data->search, info_a, &score_a);
+    ariel_plugin_search_lookup(filter_data->search, info_b, &score_b);
     
-    // Search in URI if still no match
-    if (!match) {
-        const char *uri = ariel_plugin_info_get_uri(plugin_info);
-        if (uri) {
-            char *uri_lower = g_utf8_strdown(uri, -1);
-            if (strstr(uri_lower, search_lower) != NULL) {
-                match = TRUE;
-            }
-            g_free(uri_lower);
-        }
+    // Best match first, ties by name
+    if (score_a != score_b) {
+        return score_a > score_b ? GTK_ORDERING_SMALLER : GTK_ORDERING_LARGER;
     }
     
-    g_free(search_lower);
-    return match;
+    const char *name_a = ariel_plugin_info_get_name(info_a);
+    const char *name_b = ariel_plugin_info_get_name(info_b);
+    return gtk_ordering_from_cmpfunc(g_utf8_collate(name_a ? name_a : "", name_b ? name_b : ""));
 }
-
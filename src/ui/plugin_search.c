@@ -0,0 +1,516 @@
+#include "ariel.h"
+
+// Ranked fuzzy search over the plugin list.
+//
+// Each query is scored against an immutable index snapshot on a worker
+// thread. Results are handed back to the main loop, where the filter and
+// sorter of the plugin list only do a hash lookup per row. A newer query
+// cancels the one in flight, so typing never waits for stale work.
+
+#define SEARCH_MIN_TRIGRAM_QUERY   4     // Typo tolerance only for longer queries
+#define SEARCH_TRIGRAM_THRESHOLD   0.5   // Fraction of query trigrams that must be present
+#define SEARCH_CANCEL_CHECK_STRIDE 64    // Entries scored between cancellation checks
+#define SEARCH_NO_MATCH            G_MININT
+#define SEARCH_SCORE_OFFSET        16    // Keeps stored scores non-zero in the hash table
+
+#define SCORE_MATCH        16
+#define SCORE_BOUNDARY     24
+#define SCORE_CONSECUTIVE  12
+#define SCORE_FIRST_CHAR   16
+#define SCORE_GAP_PENALTY  1
+#define SCORE_GAP_MAX      8     // Keeps every matched character worth at least 8
+
+typedef struct {
+    ArielPluginInfo *info;
+    char *fields[4];        // name, author, category, uri (original case)
+    char *lower[4];         // ASCII lower-cased copies, same byte length
+} ArielSearchEntry;
+
+// Field weights in percent: the name matters most, the URI least
+static const gint search_field_weight[4] = { 100, 60, 50, 30 };
+
+typedef struct {
+    gint ref_count;
+    ArielSearchEntry *entries;
+    guint n_entries;
+    GHashTable *trigrams;   // packed trigram -> GArray of guint entry indices
+} ArielSearchIndex;
+
+struct _ArielPluginSearch {
+    GListModel *plugins;
+    gulong items_changed_id;
+    ArielSearchIndex *index;
+    gboolean index_dirty;
+
+    char *query;
+    GCancellable *cancellable;
+    guint generation;
+
+    GHashTable *scores;     // ArielPluginInfo* -> score + SEARCH_SCORE_OFFSET
+    ArielPluginSearchResultsFunc results_func;
+    gpointer results_data;
+};
+
+typedef struct {
+    ArielSearchIndex *index;
+    char *query;
+    guint generation;
+} ArielSearchTask;
+
+typedef struct {
+    gint *scores;
+    guint n_scores;
+} ArielSearchResult;
+
+static inline guint32
+pack_trigram(const char *s)
+{
+    return ((guint32)(guchar)s[0] << 16) | ((guint32)(guchar)s[1] << 8) | (guint32)(guchar)s[2];
+}
+
+static void
+search_index_add_trigrams(ArielSearchIndex *index, const char *text, guint entry_index)
+{
+    size_t len = strlen(text);
+    if (len < 3) {
+        return;
+    }
+
+    for (size_t i = 0; i + 3 <= len; i++) {
+        gpointer key = GUINT_TO_POINTER(pack_trigram(text + i));
+        GArray *postings = g_hash_table_lookup(index->trigrams, key);
+        if (!postings) {
+            postings = g_array_new(FALSE, FALSE, sizeof(guint));
+            g_hash_table_insert(index->trigrams, key, postings);
+        }
+
+        // Entries are added in order, so a duplicate can only be the last one
+        if (postings->len == 0 ||
+            g_array_index(postings, guint, postings->len - 1) != entry_index) {
+            g_array_append_val(postings, entry_index);
+        }
+    }
+}
+
+static ArielSearchIndex *
+search_index_new(GListModel *plugins)
+{
+    ArielSearchIndex *index = g_malloc0(sizeof(ArielSearchIndex));
+    index->ref_count = 1;
+    index->n_entries = g_list_model_get_n_items(plugins);
+    index->entries = g_new0(ArielSearchEntry, index->n_entries);
+    index->trigrams = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                            NULL, (GDestroyNotify)g_array_unref);
+
+    for (guint i = 0; i < index->n_entries; i++) {
+        ArielSearchEntry *entry = &index->entries[i];
+        entry->info = g_list_model_get_item(plugins, i);
+
+        const char *values[4] = {
+            ariel_plugin_info_get_name(entry->info),
+            ariel_plugin_info_get_author(entry->info),
+            ariel_plugin_info_get_category(entry->info),
+            ariel_plugin_info_get_uri(entry->info)
+        };
+
+        for (guint f = 0; f < 4; f++) {
+            entry->fields[f] = g_strdup(values[f] ? values[f] : "");
+            entry->lower[f] = g_ascii_strdown(entry->fields[f], -1);
+        }
+
+        // Typo tolerance works on names only; authors and URIs add noise
+        search_index_add_trigrams(index, entry->lower[0], i);
+    }
+
+    return index;
+}
+
+static ArielSearchIndex *
+search_index_ref(ArielSearchIndex *index)
+{
+    g_atomic_int_inc(&index->ref_count);
+    return index;
+}
+
+static void
+search_index_unref(ArielSearchIndex *index)
+{
+    if (!index || !g_atomic_int_dec_and_test(&index->ref_count)) {
+        return;
+    }
+
+    for (guint i = 0; i < index->n_entries; i++) {
+        ArielSearchEntry *entry = &index->entries[i];
+        for (guint f = 0; f < 4; f++) {
+            g_free(entry->fields[f]);
+            g_free(entry->lower[f]);
+        }
+        g_clear_object(&entry->info);
+    }
+
+    g_free(index->entries);
+    g_hash_table_destroy(index->trigrams);
+    g_free(index);
+}
+
+static inline gboolean
+is_word_boundary(const char *text, size_t pos)
+{
+    if (pos == 0) {
+        return TRUE;
+    }
+
+    char prev = text[pos - 1];
+    char cur = text[pos];
+
+    if (!g_ascii_isalnum(prev)) {
+        return TRUE;
+    }
+
+    // camelCase and letter/digit transitions also start a word
+    if (g_ascii_islower(prev) && g_ascii_isupper(cur)) {
+        return TRUE;
+    }
+    return g_ascii_isalpha(prev) && g_ascii_isdigit(cur);
+}
+
+// Score one alignment of needle in haystack starting at start
+static gint
+fuzzy_score_from(const char *needle, size_t needle_len,
+                 const char *haystack, const char *original,
+                 size_t haystack_len, size_t start)
+{
+    gint score = 0;
+    size_t n = 0;
+    size_t last_match = start;
+    gboolean first = TRUE;
+
+    for (size_t h = start; h < haystack_len && n < needle_len; h++) {
+        if (haystack[h] != needle[n]) {
+            continue;
+        }
+
+        score += SCORE_MATCH;
+        if (is_word_boundary(original, h)) {
+            score += SCORE_BOUNDARY;
+        }
+
+        if (first) {
+            if (h == 0) {
+                score += SCORE_FIRST_CHAR;
+            }
+            first = FALSE;
+        } else if (h == last_match + 1) {
+            score += SCORE_CONSECUTIVE;
+        } else {
+            gint gap = (gint)(h - last_match - 1) * SCORE_GAP_PENALTY;
+            score -= MIN(gap, SCORE_GAP_MAX);
+        }
+
+        last_match = h;
+        n++;
+    }
+
+    return n == needle_len ? score : -1;
+}
+
+// Subsequence score of a lower-cased needle against a lower-cased haystack.
+// original is the same text in its original case and is used to find word
+// boundaries. Returns -1 if needle is not a subsequence of haystack.
+gint
+ariel_plugin_search_fuzzy_score(const char *needle, const char *haystack, const char *original)
+{
+    if (!needle || !haystack) {
+        return -1;
+    }
+
+    size_t needle_len = strlen(needle);
+    size_t haystack_len = strlen(haystack);
+    if (needle_len == 0) {
+        return 0;
+    }
+    if (needle_len > haystack_len) {
+        return -1;
+    }
+    if (!original) {
+        original = haystack;
+    }
+
+    // Greedy matching is order dependent, so try every occurrence of the
+    // first character and keep the best alignment
+    gint best = -1;
+    for (const char *p = strchr(haystack, needle[0]); p; p = strchr(p + 1, needle[0])) {
+        size_t start = (size_t)(p - haystack);
+        if (haystack_len - start < needle_len) {
+            break;
+        }
+
+        gint score = fuzzy_score_from(needle, needle_len, haystack, original, haystack_len, start);
+        if (score < 0) {
+            // No later start can match if this one could not
+            break;
+        }
+        best = MAX(best, score);
+    }
+
+    return best;
+}
+
+// Count how many of the query's trigrams every entry contains, using the
+// posting lists instead of scanning names
+static guint16 *
+search_trigram_hits(ArielSearchIndex *index, const char *query, guint *n_query_trigrams)
+{
+    size_t len = strlen(query);
+    *n_query_trigrams = 0;
+    if (len < SEARCH_MIN_TRIGRAM_QUERY || index->n_entries == 0) {
+        return NULL;
+    }
+
+    guint16 *hits = g_new0(guint16, index->n_entries);
+    GHashTable *seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    for (size_t i = 0; i + 3 <= len; i++) {
+        gpointer key = GUINT_TO_POINTER(pack_trigram(query + i));
+        if (!g_hash_table_add(seen, key)) {
+            continue;
+        }
+        (*n_query_trigrams)++;
+
+        GArray *postings = g_hash_table_lookup(index->trigrams, key);
+        if (!postings) {
+            continue;
+        }
+        for (guint p = 0; p < postings->len; p++) {
+            hits[g_array_index(postings, guint, p)]++;
+        }
+    }
+
+    g_hash_table_destroy(seen);
+    return hits;
+}
+
+static void
+search_task_free(ArielSearchTask *data)
+{
+    search_index_unref(data->index);
+    g_free(data->query);
+    g_free(data);
+}
+
+static void
+search_result_free(ArielSearchResult *result)
+{
+    g_free(result->scores);
+    g_free(result);
+}
+
+static void
+search_thread_func(GTask *task, G_GNUC_UNUSED gpointer source_object,
+                   gpointer task_data, GCancellable *cancellable)
+{
+    ArielSearchTask *data = task_data;
+    ArielSearchIndex *index = data->index;
+
+    ArielSearchResult *result = g_malloc0(sizeof(ArielSearchResult));
+    result->n_scores = index->n_entries;
+    result->scores = g_new(gint, index->n_entries);
+
+    guint n_query_trigrams = 0;
+    guint16 *hits = search_trigram_hits(index, data->query, &n_query_trigrams);
+
+    for (guint i = 0; i < index->n_entries; i++) {
+        if (i % SEARCH_CANCEL_CHECK_STRIDE == 0 && g_cancellable_is_cancelled(cancellable)) {
+            g_free(hits);
+            search_result_free(result);
+            g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Search cancelled");
+            return;
+        }
+
+        ArielSearchEntry *entry = &index->entries[i];
+        gint best = SEARCH_NO_MATCH;
+
+        for (guint f = 0; f < 4; f++) {
+            gint score = ariel_plugin_search_fuzzy_score(data->query, entry->lower[f], entry->fields[f]);
+            if (score >= 0) {
+                best = MAX(best, score * search_field_weight[f] / 100);
+            }
+        }
+
+        // Fall back to trigram overlap so a misspelt name still shows up,
+        // ranked below every real subsequence match
+        if (best == SEARCH_NO_MATCH && hits && n_query_trigrams > 0) {
+            gdouble overlap = (gdouble)hits[i] / (gdouble)n_query_trigrams;
+            if (overlap >= SEARCH_TRIGRAM_THRESHOLD) {
+                best = (gint)(overlap * 10.0) - 11;
+            }
+        }
+
+        result->scores[i] = best;
+    }
+
+    g_free(hits);
+    g_task_return_pointer(task, result, (GDestroyNotify)search_result_free);
+}
+
+static void
+search_install_results(ArielPluginSearch *search, ArielSearchIndex *index, ArielSearchResult *result)
+{
+    g_hash_table_remove_all(search->scores);
+
+    for (guint i = 0; i < result->n_scores; i++) {
+        gint score = result->scores[i];
+        if (score != SEARCH_NO_MATCH) {
+            g_hash_table_insert(search->scores, index->entries[i].info,
+                                GINT_TO_POINTER(score + SEARCH_SCORE_OFFSET));
+        }
+    }
+}
+
+static void
+search_task_done(G_GNUC_UNUSED GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+    GTask *task = G_TASK(res);
+    ArielSearchTask *data = g_task_get_task_data(task);
+    GError *error = NULL;
+
+    // A cancelled task may outlive its search, so check before touching it
+    if (g_cancellable_is_cancelled(g_task_get_cancellable(task))) {
+        return;
+    }
+
+    ArielPluginSearch *search = user_data;
+    ArielSearchResult *result = g_task_propagate_pointer(task, &error);
+    if (!result) {
+        g_clear_error(&error);
+        return;
+    }
+
+    if (data->generation == search->generation) {
+        search_install_results(search, data->index, result);
+        if (search->results_func) {
+            search->results_func(search, search->results_data);
+        }
+    }
+
+    search_result_free(result);
+}
+
+static void
+on_plugins_changed(G_GNUC_UNUSED GListModel *model, G_GNUC_UNUSED guint position,
+                   G_GNUC_UNUSED guint removed, G_GNUC_UNUSED guint added, gpointer user_data)
+{
+    ArielPluginSearch *search = user_data;
+    search->index_dirty = TRUE;
+}
+
+ArielPluginSearch *
+ariel_plugin_search_new(GListModel *plugins,
+                        ArielPluginSearchResultsFunc results_func,
+                        gpointer results_data)
+{
+    g_return_val_if_fail(G_IS_LIST_MODEL(plugins), NULL);
+
+    ArielPluginSearch *search = g_malloc0(sizeof(ArielPluginSearch));
+    search->plugins = g_object_ref(plugins);
+    search->index_dirty = TRUE;
+    search->scores = g_hash_table_new(g_direct_hash, g_direct_equal);
+    search->results_func = results_func;
+    search->results_data = results_data;
+    search->items_changed_id = g_signal_connect(plugins, "items-changed",
+                                                G_CALLBACK(on_plugins_changed), search);
+    return search;
+}
+
+void
+ariel_plugin_search_free(ArielPluginSearch *search)
+{
+    if (!search) {
+        return;
+    }
+
+    if (search->cancellable) {
+        g_cancellable_cancel(search->cancellable);
+        g_object_unref(search->cancellable);
+    }
+
+    g_signal_handler_disconnect(search->plugins, search->items_changed_id);
+    g_object_unref(search->plugins);
+    search_index_unref(search->index);
+    g_hash_table_destroy(search->scores);
+    g_free(search->query);
+    g_free(search);
+}
+
+void
+ariel_plugin_search_set_query(ArielPluginSearch *search, const char *query)
+{
+    g_return_if_fail(search != NULL);
+
+    char *stripped = g_strstrip(g_strdup(query ? query : ""));
+    char *lower = g_ascii_strdown(stripped, -1);
+    g_free(stripped);
+    if (search->query && strcmp(search->query, lower) == 0) {
+        g_free(lower);
+        return;
+    }
+
+    g_free(search->query);
+    search->query = lower;
+    search->generation++;
+
+    // Drop whatever is still running for the previous query
+    if (search->cancellable) {
+        g_cancellable_cancel(search->cancellable);
+        g_clear_object(&search->cancellable);
+    }
+
+    if (search->query[0] == '\0') {
+        g_hash_table_remove_all(search->scores);
+        if (search->results_func) {
+            search->results_func(search, search->results_data);
+        }
+        return;
+    }
+
+    if (search->index_dirty || !search->index) {
+        search_index_unref(search->index);
+        search->index = search_index_new(search->plugins);
+        search->index_dirty = FALSE;
+    }
+
+    ArielSearchTask *data = g_malloc0(sizeof(ArielSearchTask));
+    data->index = search_index_ref(search->index);
+    data->query = g_strdup(search->query);
+    data->generation = search->generation;
+
+    search->cancellable = g_cancellable_new();
+    GTask *task = g_task_new(NULL, search->cancellable, search_task_done, search);
+    g_task_set_task_data(task, data, (GDestroyNotify)search_task_free);
+    g_task_set_return_on_cancel(task, FALSE);
+    g_task_run_in_thread(task, search_thread_func);
+    g_object_unref(task);
+}
+
+gboolean
+ariel_plugin_search_is_active(ArielPluginSearch *search)
+{
+    return search && search->query && search->query[0] != '\0';
+}
+
+gboolean
+ariel_plugin_search_lookup(ArielPluginSearch *search, ArielPluginInfo *info, gint *score)
+{
+    if (!ariel_plugin_search_is_active(search)) {
+        if (score) *score = 0;
+        return TRUE;
+    }
+
+    gpointer value = g_hash_table_lookup(search->scores, info);
+    if (!value) {
+        return FALSE;
+    }
+
+    if (score) *score = GPOINTER_TO_INT(value) - SEARCH_SCORE_OFFSET;
+    return TRUE;
+}
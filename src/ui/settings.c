@@ -270,6 +270,134 @@ on_theme_changed(GtkDropDown *dropdown, GParamSpec *pspec, ArielSettingsData *da
     }
 }
 
+void
+ariel_save_crossfade_preference(guint crossfade_ms)
+{
+    char *config_file = get_config_file_path();
+    GKeyFile *key_file = g_key_file_new();
+    GError *error = NULL;
+    
+    // Load existing config if it exists
+    if (g_file_test(config_file, G_FILE_TEST_EXISTS)) {
+        g_key_file_load_from_file(key_file, config_file, G_KEY_FILE_NONE, &error);
+        if (error) {
+            g_warning("Failed to load config file: %s", error->message);
+            g_error_free(error);
+            error = NULL;
+        }
+    }
+    
+    g_key_file_set_integer(key_file, "Audio", "crossfade_ms", (gint)crossfade_ms);
+    
+    if (!g_key_file_save_to_file(key_file, config_file, &error)) {
+        g_warning("Failed to save config file: %s", error->message);
+        g_error_free(error);
+    }
+    
+    g_key_file_free(key_file);
+    g_free(config_file);
+}
+
+guint
+ariel_load_crossfade_preference(void)
+{
+    char *config_file = get_config_file_path();
+    GKeyFile *key_file = g_key_file_new();
+    guint crossfade_ms = ARIEL_DEFAULT_CROSSFADE_MS;
+    
+    if (g_key_file_load_from_file(key_file, config_file, G_KEY_FILE_NONE, NULL) &&
+        g_key_file_has_key(key_file, "Audio", "crossfade_ms", NULL)) {
+        gint value = g_key_file_get_integer(key_file, "Audio", "crossfade_ms", NULL);
+        crossfade_ms = (guint)CLAMP(value, 0, ARIEL_MAX_CROSSFADE_MS);
+    }
+    
+    g_key_file_free(key_file);
+    g_free(config_file);
+    
+    return crossfade_ms;
+}
+
+void
+ariel_save_capture_preferences(guint minutes, gboolean lock_memory)
+{
+    char *config_file = get_config_file_path();
+    GKeyFile *key_file = g_key_file_new();
+    GError *error = NULL;
+    
+    // Load existing config if it exists
+    if (g_file_test(config_file, G_FILE_TEST_EXISTS)) {
+        g_key_file_load_from_file(key_file, config_file, G_KEY_FILE_NONE, &error);
+        if (error) {
+            g_warning("Failed to load config file: %s", error->message);
+            g_error_free(error);
+            error = NULL;
+        }
+    }
+    
+    g_key_file_set_integer(key_file, "Audio", "capture_minutes", (gint)minutes);
+    g_key_file_set_boolean(key_file, "Audio", "capture_lock_memory", lock_memory);
+    
+    if (!g_key_file_save_to_file(key_file, config_file, &error)) {
+        g_warning("Failed to save config file: %s", error->message);
+        g_error_free(error);
+    }
+    
+    g_key_file_free(key_file);
+    g_free(config_file);
+}
+
+void
+ariel_load_capture_preferences(guint *minutes, gboolean *lock_memory)
+{
+    char *config_file = get_config_file_path();
+    GKeyFile *key_file = g_key_file_new();
+    
+    *minutes = ARIEL_DEFAULT_CAPTURE_MINUTES;
+    *lock_memory = TRUE;
+    
+    if (g_key_file_load_from_file(key_file, config_file, G_KEY_FILE_NONE, NULL)) {
+        if (g_key_file_has_key(key_file, "Audio", "capture_minutes", NULL)) {
+            gint value = g_key_file_get_integer(key_file, "Audio", "capture_minutes", NULL);
+            *minutes = (guint)CLAMP(value, 0, ARIEL_MAX_CAPTURE_MINUTES);
+        }
+        if (g_key_file_has_key(key_file, "Audio", "capture_lock_memory", NULL)) {
+            *lock_memory = g_key_file_get_boolean(key_file, "Audio", "capture_lock_memory", NULL);
+        }
+    }
+    
+    g_key_file_free(key_file);
+    g_free(config_file);
+}
+
+static void
+on_capture_changed(GtkWidget *widget, ArielSettingsData *data)
+{
+    GtkWidget *capture_spin = g_object_get_data(G_OBJECT(widget), "capture-spin");
+    GtkWidget *lock_check = g_object_get_data(G_OBJECT(widget), "lock-check");
+    guint minutes = (guint)gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(capture_spin));
+    gboolean lock_memory = gtk_check_button_get_active(GTK_CHECK_BUTTON(lock_check));
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(data->window->app);
+    
+    // The ring is sized when the engine starts
+    if (engine) {
+        engine->capture_minutes = minutes;
+        engine->capture_lock_memory = lock_memory;
+    }
+    ariel_save_capture_preferences(minutes, lock_memory);
+}
+
+static void
+on_crossfade_changed(GtkSpinButton *spin_button, ArielSettingsData *data)
+{
+    guint crossfade_ms = (guint)gtk_spin_button_get_value_as_int(spin_button);
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(data->window->app);
+    
+    if (engine) {
+        engine->crossfade_ms = crossfade_ms;
+    }
+    ariel_save_crossfade_preference(crossfade_ms);
+}
+
 static void
 on_settings_response(GtkDialog *dialog, int response_id, ArielSettingsData *data)
 {
@@ -458,6 +586,43 @@ ariel_show_settings_dialog(ArielWindow *window)
     gtk_widget_add_css_class(buffer_size_info, "dim-label");
     gtk_grid_attach(GTK_GRID(grid), buffer_size_info, 1, audio_settings_row + 2, 1, 1);
     
+    // Chain preset switch crossfade
+    GtkWidget *crossfade_label = gtk_label_new("Preset Crossfade (ms):");
+    gtk_widget_set_halign(crossfade_label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(grid), crossfade_label, 0, audio_settings_row + 3, 1, 1);
+    
+    GtkWidget *crossfade_spin = gtk_spin_button_new_with_range(0, ARIEL_MAX_CROSSFADE_MS, 5);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(crossfade_spin), ariel_load_crossfade_preference());
+    gtk_widget_set_halign(crossfade_spin, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(grid), crossfade_spin, 1, audio_settings_row + 3, 1, 1);
+    g_signal_connect(crossfade_spin, "value-changed", G_CALLBACK(on_crossfade_changed), data);
+    
+    // Retrospective capture length, applied when the engine next starts
+    guint capture_minutes;
+    gboolean capture_lock_memory;
+    ariel_load_capture_preferences(&capture_minutes, &capture_lock_memory);
+    
+    GtkWidget *capture_label = gtk_label_new("Capture Buffer (minutes):");
+    gtk_widget_set_halign(capture_label, GTK_ALIGN_START);
+    gtk_grid_attach(GTK_GRID(grid), capture_label, 0, audio_settings_row + 4, 1, 1);
+    
+    GtkWidget *capture_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
+    GtkWidget *capture_spin = gtk_spin_button_new_with_range(0, ARIEL_MAX_CAPTURE_MINUTES, 1);
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(capture_spin), capture_minutes);
+    gtk_widget_set_tooltip_text(capture_spin, "0 turns it off; takes effect when audio restarts");
+    GtkWidget *lock_check = gtk_check_button_new_with_label("Lock in RAM");
+    gtk_check_button_set_active(GTK_CHECK_BUTTON(lock_check), capture_lock_memory);
+    gtk_box_append(GTK_BOX(capture_box), capture_spin);
+    gtk_box_append(GTK_BOX(capture_box), lock_check);
+    gtk_grid_attach(GTK_GRID(grid), capture_box, 1, audio_settings_row + 4, 1, 1);
+    
+    g_object_set_data(G_OBJECT(capture_spin), "capture-spin", capture_spin);
+    g_object_set_data(G_OBJECT(capture_spin), "lock-check", lock_check);
+    g_object_set_data(G_OBJECT(lock_check), "capture-spin", capture_spin);
+    g_object_set_data(G_OBJECT(lock_check), "lock-check", lock_check);
+    g_signal_connect(capture_spin, "value-changed", G_CALLBACK(on_capture_changed), data);
+    g_signal_connect(lock_check, "toggled", G_CALLBACK(on_capture_changed), data);
+    
     // Add grid to content area
     gtk_box_append(GTK_BOX(content_area), grid);
     
@@ -96,6 +96,30 @@ on_record_clicked(GtkButton *button, ArielWindow *window)
     }
 }
 
+static void
+on_save_capture_clicked(GtkButton *button, ArielWindow *window)
+{
+    ariel_transport_save_capture(window);
+}
+
+// Takes go to the music directory, DI and output side by side
+static char *
+ariel_transport_take_prefix(const char *format)
+{
+    const char *music_dir = g_get_user_special_dir(G_USER_DIRECTORY_MUSIC);
+    char *dir = g_build_filename(music_dir ? music_dir : g_get_home_dir(), "Ariel", NULL);
+    g_mkdir_with_parents(dir, 0755);
+    
+    GDateTime *now = g_date_time_new_now_local();
+    char *stamp = g_date_time_format(now, format);
+    char *prefix = g_build_filename(dir, stamp, NULL);
+    g_free(stamp);
+    g_date_time_unref(now);
+    g_free(dir);
+    
+    return prefix;
+}
+
 // Transport control functions
 void
 ariel_transport_play(ArielWindow *window)
@@ -113,8 +137,7 @@ ariel_transport_play(ArielWindow *window)
     window->is_playing = TRUE;
     window->is_recording = FALSE;
     
-    // TODO: Start JACK transport if available
-    // jack_transport_start(engine->client);
+    ariel_audio_engine_set_transport_rolling(engine, TRUE);
     
     ariel_transport_update_ui(window);
 }
@@ -134,8 +157,8 @@ ariel_transport_stop(ArielWindow *window)
     window->is_playing = FALSE;
     window->is_recording = FALSE;
     
-    // TODO: Stop JACK transport if available
-    // jack_transport_stop(engine->client);
+    ariel_audio_engine_stop_recording(engine);
+    ariel_audio_engine_set_transport_rolling(engine, FALSE);
     
     ariel_transport_update_ui(window);
 }
@@ -153,15 +176,36 @@ ariel_transport_record(ArielWindow *window)
     
     g_print("Transport: Starting recording\n");
     
+    char *prefix = ariel_transport_take_prefix("ariel-%Y%m%d-%H%M%S");
+    gboolean started = ariel_audio_engine_start_recording(engine, prefix);
+    g_free(prefix);
+    
+    if (!started) {
+        return;
+    }
+    
     window->is_playing = TRUE;
     window->is_recording = TRUE;
     
-    // TODO: Start recording to file
-    // TODO: Start JACK transport if available
+    ariel_audio_engine_set_transport_rolling(engine, TRUE);
     
     ariel_transport_update_ui(window);
 }
 
+// Save the last minutes of input and output, whether or not record was on
+void
+ariel_transport_save_capture(ArielWindow *window)
+{
+    if (!window) return;
+    
+    ArielAudioEngine *engine = ariel_app_get_audio_engine(window->app);
+    if (!engine) return;
+    
+    char *prefix = ariel_transport_take_prefix("ariel-capture-%Y%m%d-%H%M%S");
+    ariel_audio_engine_save_capture(engine, prefix);
+    g_free(prefix);
+}
+
 void
 ariel_transport_update_ui(ArielWindow *window)
 {
@@ -224,9 +268,16 @@ ariel_create_transport(ArielWindow *window)
     gtk_widget_add_css_class(window->record_button, "circular");
     g_signal_connect(window->record_button, "clicked", G_CALLBACK(on_record_clicked), window);
     
+    // Save the capture buffer: the take nobody pressed record for
+    GtkWidget *save_capture_button = gtk_button_new_from_icon_name("document-save-symbolic");
+    gtk_widget_add_css_class(save_capture_button, "circular");
+    gtk_widget_set_tooltip_text(save_capture_button, "Save the last minutes of input and output");
+    g_signal_connect(save_capture_button, "clicked", G_CALLBACK(on_save_capture_clicked), window);
+    
     gtk_box_append(GTK_BOX(box), window->play_button);
     gtk_box_append(GTK_BOX(box), window->stop_button);
     gtk_box_append(GTK_BOX(box), window->record_button);
+    gtk_box_append(GTK_BOX(box), save_capture_button);
     
     // Initialize transport state
     window->is_playing = FALSE;
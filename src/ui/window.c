@@ -239,14 +239,15 @@ ariel_window_setup_ui(ArielWindow *window)
     GtkWidget *right_paned = gtk_paned_new(GTK_ORIENTATION_VERTICAL);
     gtk_paned_set_end_child(GTK_PANED(window->main_paned), right_paned);   
 
-    // Active plugins list (top right)
+    // Active plugins list (top right); it refreshes the mixer once that exists
+    window->mixer_box = NULL;
     window->active_plugins = ariel_create_active_plugins_view(window);
     gtk_paned_set_start_child(GTK_PANED(right_paned), window->active_plugins);
     gtk_widget_set_name(window->active_plugins, "active-plugins-view");
     
-    // Mixer (bottom right)
+    // Mixer (bottom right): a channel strip per chain slot
     window->mixer_box = ariel_create_mixer(window);
-    // gtk_paned_set_end_child(GTK_PANED(right_paned), window->mixer_box);
+    gtk_paned_set_end_child(GTK_PANED(right_paned), window->mixer_box);
     
     // Set paned positions
     gtk_paned_set_position(GTK_PANED(window->main_paned), 400);
@@ -0,0 +1,275 @@
+#include "ariel_dsp.h"
+#include <string.h>
+
+// Holds every buffer kernel table built into the binary to the scalar
+// reference. Each kernel runs on lengths that leave a scalar tail after
+// every vector width and on buffers offset from their allocation, so the
+// unaligned loads and the tails are both covered. Tables the CPU cannot
+// run are skipped.
+
+static const guint lengths[] = { 0, 1, 2, 3, 5, 7, 9, 15, 17, 31, 33, 47, 63, 65, 127, 1037 };
+
+#define MAX_FRAMES 1037
+#define MAX_OFFSET 3       // Floats between the allocation and the buffer
+#define GUARD 16           // Floats after the buffer that must stay untouched
+#define GUARD_VALUE 12345.0f
+#define TOLERANCE 1e-5f
+
+typedef struct {
+    float *storage;
+    float *src;
+    float *dry;
+    float *expected;
+    float *actual;
+    float *expected_copy;
+    float *actual_copy;
+} Buffers;
+
+static const ArielDspKernels *scalar;
+
+static float *
+buffers_slot(Buffers *b, guint slot, guint offset)
+{
+    return b->storage + slot * (MAX_OFFSET + MAX_FRAMES + GUARD) + offset;
+}
+
+static void
+buffers_setup(Buffers *b, guint n, guint offset, guint32 seed)
+{
+    if (!b->storage) {
+        b->storage = g_new(float, 6 * (MAX_OFFSET + MAX_FRAMES + GUARD));
+    }
+    for (guint i = 0; i < 6 * (MAX_OFFSET + MAX_FRAMES + GUARD); i++) {
+        b->storage[i] = GUARD_VALUE;
+    }
+
+    b->src = buffers_slot(b, 0, offset);
+    b->dry = buffers_slot(b, 1, offset);
+    b->expected = buffers_slot(b, 2, offset);
+    b->actual = buffers_slot(b, 3, offset);
+    b->expected_copy = buffers_slot(b, 4, offset);
+    b->actual_copy = buffers_slot(b, 5, offset);
+
+    GRand *rand = g_rand_new_with_seed(seed);
+    for (guint i = 0; i < n; i++) {
+        b->src[i] = (float)g_rand_double_range(rand, -1.0, 1.0);
+        b->dry[i] = (float)g_rand_double_range(rand, -1.0, 1.0);
+    }
+    g_rand_free(rand);
+
+    memcpy(b->expected, b->src, n * sizeof(float));
+    memcpy(b->actual, b->src, n * sizeof(float));
+}
+
+static void
+buffers_clear(Buffers *b)
+{
+    g_free(b->storage);
+    b->storage = NULL;
+}
+
+static void
+assert_guard(const float *buffer, guint n)
+{
+    for (guint i = n; i < n + GUARD; i++) {
+        g_assert_cmpfloat(buffer[i], ==, GUARD_VALUE);
+    }
+}
+
+static void
+assert_close(const float *actual, const float *expected, guint n)
+{
+    for (guint i = 0; i < n; i++) {
+        if (fabsf(actual[i] - expected[i]) > TOLERANCE * (1.0f + fabsf(expected[i]))) {
+            g_error("sample %u of %u: %.9g, expected %.9g", i, n, actual[i], expected[i]);
+        }
+    }
+    assert_guard(actual, n);
+}
+
+static void
+assert_equal(const float *actual, const float *expected, guint n)
+{
+    g_assert_cmpmem(actual, n * sizeof(float), expected, n * sizeof(float));
+    assert_guard(actual, n);
+}
+
+typedef void (*KernelCheck)(const ArielDspKernels *k, Buffers *b, guint n);
+
+static void
+check_copy(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    k->copy(b->actual_copy, b->src, n);
+    assert_equal(b->actual_copy, b->src, n);
+}
+
+static void
+check_fill(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    scalar->fill(b->expected, 0.25f, n);
+    k->fill(b->actual, 0.25f, n);
+    assert_equal(b->actual, b->expected, n);
+}
+
+static void
+check_gain(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    scalar->gain(b->expected, 0.7f, n);
+    k->gain(b->actual, 0.7f, n);
+    assert_close(b->actual, b->expected, n);
+}
+
+static void
+check_gain_ramp(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    float step = n > 0 ? 0.8f / n : 0.0f;
+    scalar->gain_ramp(b->expected, b->expected_copy, 0.2f, step, n);
+    k->gain_ramp(b->actual, b->actual_copy, 0.2f, step, n);
+    assert_close(b->actual, b->expected, n);
+    assert_equal(b->actual_copy, b->expected_copy, n);
+}
+
+static void
+check_gain_ramp_no_copy(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    float step = n > 0 ? -1.0f / n : 0.0f;
+    scalar->gain_ramp(b->expected, NULL, 1.0f, step, n);
+    k->gain_ramp(b->actual, NULL, 1.0f, step, n);
+    assert_close(b->actual, b->expected, n);
+}
+
+static void
+check_mix_add(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    scalar->mix_add(b->expected, b->dry, 0.5f, n);
+    k->mix_add(b->actual, b->dry, 0.5f, n);
+    assert_close(b->actual, b->expected, n);
+}
+
+static void
+check_blend(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    float wet_step = n > 0 ? -0.6f / n : 0.0f;
+    float dry_step = n > 0 ? 0.5f / n : 0.0f;
+    scalar->blend(b->expected, b->dry, 1.0f, wet_step, 0.1f, dry_step, n);
+    k->blend(b->actual, b->dry, 1.0f, wet_step, 0.1f, dry_step, n);
+    assert_close(b->actual, b->expected, n);
+}
+
+static void
+check_blend_no_dry(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    float wet_step = n > 0 ? 0.1f / n : 0.0f;
+    scalar->blend(b->expected, NULL, 0.9f, wet_step, 0.0f, 0.0f, n);
+    k->blend(b->actual, NULL, 0.9f, wet_step, 0.0f, 0.0f, n);
+    assert_close(b->actual, b->expected, n);
+}
+
+static void
+check_peak(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    // Put the loudest sample in the tail, where only the scalar part sees it
+    if (n > 0) {
+        b->src[n - 1] = -1.5f;
+    }
+    g_assert_cmpfloat(k->peak(b->src, n), ==, scalar->peak(b->src, n));
+}
+
+static void
+check_sum_squares(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    float expected = scalar->sum_squares(b->src, n);
+    g_assert_cmpfloat_with_epsilon(k->sum_squares(b->src, n), expected, 1e-4f * (1.0f + expected));
+}
+
+static void
+check_scrub(const ArielDspKernels *k, Buffers *b, guint n)
+{
+    // Non-finite samples at both ends, in the middle and one lane into the
+    // tail, next to finite extremes that must survive
+    const float bad[] = { NAN, INFINITY, -INFINITY, -NAN };
+    const guint positions[] = { 0, n / 2, n - 1, n - n % 4, 1 };
+    for (guint i = 0; i < G_N_ELEMENTS(positions); i++) {
+        if (positions[i] < n) {
+            b->expected[positions[i]] = bad[i % G_N_ELEMENTS(bad)];
+        }
+    }
+    if (n > 3) {
+        b->expected[3] = G_MAXFLOAT;
+        b->expected[2] = -1e-40f;    // Denormal
+    }
+    memcpy(b->actual, b->expected, n * sizeof(float));
+
+    guint expected_count = scalar->scrub(b->expected, n);
+    g_assert_cmpuint(k->scrub(b->actual, n), ==, expected_count);
+    assert_equal(b->actual, b->expected, n);
+    for (guint i = 0; i < n; i++) {
+        g_assert_true(isfinite(b->actual[i]));
+    }
+}
+
+typedef struct {
+    const ArielDspKernels *kernels;
+    KernelCheck check;
+} TestCase;
+
+static void
+run_case(gconstpointer data)
+{
+    const TestCase *test = data;
+
+    if (!ariel_dsp_variant_supported(test->kernels)) {
+        g_test_skip("not supported by this CPU");
+        return;
+    }
+
+    Buffers b = { 0 };
+    for (guint l = 0; l < G_N_ELEMENTS(lengths); l++) {
+        for (guint offset = 0; offset <= MAX_OFFSET; offset++) {
+            buffers_setup(&b, lengths[l], offset, 0x41524945 + lengths[l]);
+            test->check(test->kernels, &b, lengths[l]);
+        }
+    }
+    buffers_clear(&b);
+}
+
+int
+main(int argc, char **argv)
+{
+    static const struct {
+        const char *name;
+        KernelCheck check;
+    } checks[] = {
+        { "copy", check_copy },
+        { "fill", check_fill },
+        { "gain", check_gain },
+        { "gain-ramp", check_gain_ramp },
+        { "gain-ramp-no-copy", check_gain_ramp_no_copy },
+        { "mix-add", check_mix_add },
+        { "blend", check_blend },
+        { "blend-no-dry", check_blend_no_dry },
+        { "peak", check_peak },
+        { "sum-squares", check_sum_squares },
+        { "scrub", check_scrub },
+    };
+
+    g_test_init(&argc, &argv, NULL);
+
+    guint n_variants = 0;
+    const ArielDspKernels *const *variants = ariel_dsp_get_variants(&n_variants);
+    scalar = variants[0];
+
+    for (guint v = 1; v < n_variants; v++) {
+        for (guint c = 0; c < G_N_ELEMENTS(checks); c++) {
+            TestCase *test = g_new(TestCase, 1);
+            test->kernels = variants[v];
+            test->check = checks[c].check;
+
+            char *path = g_strdup_printf("/dsp/%s/%s", variants[v]->name, checks[c].name);
+            g_test_add_data_func_full(path, test, run_case, g_free);
+            g_free(path);
+        }
+    }
+
+    return g_test_run();
+}